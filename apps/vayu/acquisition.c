@@ -0,0 +1,300 @@
+/**
+ * @file acquisition.c
+ * @author Varun Marolia
+ * @brief This file implements the vayu acquisition cycle manager. The NTC and
+ *        supply channels are read while the SHT4X converts and all the values
+ *        are published as one timestamped record.
+ * 
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ * 
+ */
+
+#include "board.h"
+#include "board-common.h"
+#include "acquisition.h"
+
+#define LOG_MODULE LOG_MODULE_APP
+#include "log.h"
+
+#define ACQUISITION_ADC_SUPPLY      NTC_TOTAL
+#define ACQUISITION_ADC_FAN_SUPPLY  (NTC_TOTAL + 1)
+#define ACQUISITION_ADC_COUNT       (NTC_TOTAL + 2)
+#define ACQUISITION_NTC_SCANS       128   /* samples averaged, the HRV NTC averages 128 samples. Powers of 2 */
+#define ACQUISITION_SUPPLY_SCANS    16    /* are averaged by the ADC oversampling in one scan */
+
+/* the NTCs use the VDD reference and the supply dividers the 2.5 V one. A scan has one reference,
+   so the channels are converted in two scan groups */
+static adc_dev_t *ntc_scan_devs[NTC_TOTAL];
+static uint32_t ntc_scan_buff[ACQUISITION_NTC_SCANS * NTC_TOTAL];
+static adc_scan_group_t ntc_scan = {
+  .devs = ntc_scan_devs,
+  .dev_count = NTC_TOTAL,
+  .samples = ACQUISITION_NTC_SCANS,
+  .buff = ntc_scan_buff,
+  .buff_size = ACQUISITION_NTC_SCANS * NTC_TOTAL,
+  .callback = NULL,
+  .ctx = NULL
+};
+static adc_dev_t * const supply_scan_devs[2] = { &BOARD_SUPPLY_ADC_DEV, &FAN_12V_ADC_DEV };
+static uint32_t supply_scan_buff[ACQUISITION_SUPPLY_SCANS * 2];
+static adc_scan_group_t supply_scan = {
+  .devs = supply_scan_devs,
+  .dev_count = 2,
+  .samples = ACQUISITION_SUPPLY_SCANS,
+  .buff = supply_scan_buff,
+  .buff_size = ACQUISITION_SUPPLY_SCANS * 2,
+  .callback = NULL,
+  .ctx = NULL
+};
+/*---------------------------------------------------------------------------*/
+/* ADC devices of the cycle, NTCs first */
+static void
+acquisition_get_adc(acquisition_t *acq, adc_dev_t **adc)
+{
+  uint8_t i;
+
+  for(i = 0; i < NTC_TOTAL; i++) {
+    adc[i] = acq->ntc[i].adc_dev;
+  }
+  adc[ACQUISITION_ADC_SUPPLY] = &BOARD_SUPPLY_ADC_DEV;
+  adc[ACQUISITION_ADC_FAN_SUPPLY] = &FAN_12V_ADC_DEV;
+}
+/*---------------------------------------------------------------------------*/
+/* opens or closes the power windows of the channels in a power domain for the whole cycle, so
+   that every read in the cycle finds the front end settled */
+static void
+acquisition_power_window(acquisition_t *acq, bool open)
+{
+  adc_dev_t *adc[ACQUISITION_ADC_COUNT];
+  uint8_t i;
+
+  if(acq->power_open == open) {
+    return;
+  }
+  acquisition_get_adc(acq, adc);
+  for(i = 0; i < ACQUISITION_ADC_COUNT; i++) {
+    if(open) {
+      adc_power_domain_open(adc[i]->power_domain);
+    } else {
+      adc_power_domain_close(adc[i]->power_domain);
+    }
+  }
+  acq->power_open = open;
+}
+/*---------------------------------------------------------------------------*/
+/* reads all the ADC channels in scan groups, or back to back if the scan could not be set up.
+   Enable pins are switched once for the whole batch, power domains are open for the cycle */
+static void
+acquisition_read_adc(acquisition_t *acq, acquisition_record_t *rec)
+{
+  adc_dev_t *adc[ACQUISITION_ADC_COUNT];
+  uint32_t reading[ACQUISITION_ADC_COUNT];       /* microvolts, raw ADC code for NTCs with a code table */
+  bool read_ok[ACQUISITION_ADC_COUNT];
+  bool ntc_ok, supply_ok;
+  uint32_t power_up_delay_ms = 0;
+  uint8_t i;
+
+  acquisition_get_adc(acq, adc);
+  for(i = 0; i < ACQUISITION_ADC_COUNT; i++) {
+    if(adc[i]->power_domain == NULL && adc[i]->adc_dev_enable) {
+      adc_arch_dev_enable(adc[i]->adc_dev_enable, ADC_DEV_ENABLE);
+      if(adc[i]->power_up_delay_ms > power_up_delay_ms) {
+        power_up_delay_ms = adc[i]->power_up_delay_ms;
+      }
+    }
+  }
+  /* one wait for the slowest divider instead of one per channel */
+  if(power_up_delay_ms) {
+    clock_wait_ms(power_up_delay_ms);
+  }
+  for(i = 0; i < ACQUISITION_ADC_COUNT; i++) {
+    adc_power_domain_wait(adc[i]->power_domain);
+  }
+  if(acq->scan_ready) {
+    /* each group is converted in one pass, the DMA collects the results. A scan that did not
+       start leaves the results of the previous cycle, they are not used */
+    ntc_ok = (adc_dev_scan_start(&ntc_scan) == ADC_OK);
+    if(ntc_ok) {
+      adc_arch_sleep_while(&ntc_scan.busy);
+    }
+    supply_ok = (adc_dev_scan_start(&supply_scan) == ADC_OK);
+    if(supply_ok) {
+      adc_arch_sleep_while(&supply_scan.busy);
+    }
+    for(i = 0; i < NTC_TOTAL; i++) {
+      read_ok[i] = ntc_ok;
+      /* the NTC code table and the ratiometric mode convert the raw code directly */
+      reading[i] = (acq->ntc[i].code_table != NULL || acq->ntc[i].ratiometric) ? ntc_scan.result[i]
+                                                                               : adc_dev_scan_get_microvolts(&ntc_scan, i);
+    }
+    reading[ACQUISITION_ADC_SUPPLY] = adc_dev_scan_get_microvolts(&supply_scan, 0);
+    reading[ACQUISITION_ADC_FAN_SUPPLY] = adc_dev_scan_get_microvolts(&supply_scan, 1);
+    read_ok[ACQUISITION_ADC_SUPPLY] = supply_ok;
+    read_ok[ACQUISITION_ADC_FAN_SUPPLY] = supply_ok;
+  } else {
+    for(i = 0; i < ACQUISITION_ADC_COUNT; i++) {
+      reading[i] = 0;
+      if(i < NTC_TOTAL && (acq->ntc[i].code_table != NULL || acq->ntc[i].ratiometric)) {
+        read_ok[i] = adc_arch_read_single(adc[i], &reading[i]) == ADC_OK;
+      } else {
+        read_ok[i] = adc_arch_read_microvolts(adc[i], &reading[i]) == ADC_OK;
+      }
+    }
+  }
+  for(i = 0; i < ACQUISITION_ADC_COUNT; i++) {
+    if(adc[i]->power_domain == NULL && adc[i]->adc_dev_enable) {
+      adc_arch_dev_enable(adc[i]->adc_dev_enable, ADC_DEV_DISABLE);
+    }
+    /* channel filter chain, if the board set one up. The only place it is fed, once per
+       cycle in the unit of the channel: raw code for code table and ratiometric NTCs */
+    if(read_ok[i]) {
+      reading[i] = adc_dev_filter(adc[i], reading[i]);
+    } else {
+      rec->flags |= ACQUISITION_FLAG_ADC_ERROR;
+    }
+  }
+
+  rec->flags &= ~ACQUISITION_FLAG_NTC_ERROR;
+  for(i = 0; i < NTC_TOTAL; i++) {
+    if(!read_ok[i]) {
+      rec->ntc_temp_mC[i] = NTC_ERROR;
+    } else if(acq->ntc[i].code_table != NULL || acq->ntc[i].ratiometric) {
+      rec->ntc_temp_mC[i] = ntc_temp_mc_from_adc_code(&acq->ntc[i], reading[i]);
+    } else {
+      rec->ntc_temp_mC[i] = ntc_temp_mc_from_microvolts(&acq->ntc[i], reading[i]);
+    }
+    if(rec->ntc_temp_mC[i] == NTC_ERROR) {
+      rec->flags |= ACQUISITION_FLAG_NTC_ERROR;
+    }
+  }
+  /* 0 is an unknown supply also for adc_cal_arch_poll */
+  rec->supply_mV = read_ok[ACQUISITION_ADC_SUPPLY]
+                   ? board_voltage_divider_mv(reading[ACQUISITION_ADC_SUPPLY], BOARD_SUPPLY_R1_OHMS, BOARD_SUPPLY_R2_OHMS)
+                   : 0;
+  rec->fan_supply_mV = read_ok[ACQUISITION_ADC_FAN_SUPPLY]
+                       ? board_voltage_divider_mv(reading[ACQUISITION_ADC_FAN_SUPPLY], FAN_12V_SUPPLY_R1_OHMS,
+                                                  FAN_12V_SUPPLY_R2_OHMS)
+                       : 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+acquisition_start_cycle(acquisition_t *acq)
+{
+  acq->cycle.timestamp_ms = clock_get_time_ms();
+  acq->cycle.flags = 0;
+  timer_set(&acq->period_timer, ACQUISITION_PERIOD_MS);
+  acquisition_power_window(acq, true);
+  acquisition_read_adc(acq, &acq->cycle);
+  acq->pending = true;
+}
+/*---------------------------------------------------------------------------*/
+static void
+acquisition_publish(acquisition_t *acq, uint8_t sht4x_flags)
+{
+  acquisition_record_t *rec = &acq->cycle;
+  sht4x_recovery_get_value(acq->sht4x, &rec->sht4x_temp_mC, &rec->sht4x_rh_100x);
+  rec->flags |= sht4x_flags;
+  if(!(sht4x_flags & ACQUISITION_FLAG_SHT4X_VALID) && sht4x_recovery_in_blackout(acq->sht4x)) {
+    rec->flags |= ACQUISITION_FLAG_SHT4X_FLAGGED;
+  }
+  if(!(rec->flags & ACQUISITION_FLAG_SHT4X_VALID)) {
+    acq->adc_only_cycles++;
+  }
+  rec->cycle_ms = (uint16_t)(clock_get_time_ms() - rec->timestamp_ms);
+  rec->sequence = acq->valid ? acq->record.sequence + 1 : 0;
+  acq->record = *rec;
+  acq->valid = true;
+  acq->pending = false;
+  acquisition_power_window(acq, false);
+  LOG_DBG("ACQ: record %lu flags:0x%02x cycle:%u ms\n", acq->record.sequence, acq->record.flags,
+          acq->record.cycle_ms);
+}
+/*---------------------------------------------------------------------------*/
+void
+acquisition_init(acquisition_t *acq, sht4x_recovery_t *sht4x, ntc_thermistor_t *ntc)
+{
+  uint8_t i;
+  if(acq == NULL || ntc == NULL) {
+    return;
+  }
+  acq->sht4x = sht4x;
+  acq->ntc = ntc;
+  acq->pending = false;
+  acq->valid = false;
+  acq->adc_only_cycles = 0;
+  acq->power_open = false;
+  for(i = 0; i < NTC_TOTAL; i++) {
+    ntc_scan_devs[i] = ntc[i].adc_dev;
+  }
+  acq->scan_ready = (adc_dev_scan_init(&ntc_scan) == ADC_OK) && (adc_dev_scan_init(&supply_scan) == ADC_OK);
+  if(!acq->scan_ready) {
+    LOG_WARN("ACQ: ADC scan not available, reading channels one by one\n");
+  }
+  timer_set(&acq->period_timer, ACQUISITION_PERIOD_MS);
+}
+/*---------------------------------------------------------------------------*/
+bool
+acquisition_poll(acquisition_t *acq)
+{
+  sht4x_state_t sht4x_state;
+  sht4x_recovery_event_t event;
+  if(acq == NULL || acq->sht4x == NULL || acq->ntc == NULL) {
+    return false;
+  }
+  sht4x_state = acq->sht4x->sht->state;
+  event = sht4x_recovery_poll(acq->sht4x);
+
+  if(acq->pending) {
+    if(event == SHT4X_RECOVERY_EVENT_SAMPLE || event == SHT4X_RECOVERY_EVENT_HEATER_START) {
+      /* the recovery stores the sample before it starts a heater pulse */
+      acquisition_publish(acq, ACQUISITION_FLAG_SHT4X_VALID);
+      return true;
+    }
+    if(event == SHT4X_RECOVERY_EVENT_FLAGGED || acq->sht4x->sht->state == SHT4X_STATE_IDLE) {
+      /* sample taken during the heater blackout or the measurement failed */
+      acquisition_publish(acq, 0);
+      return true;
+    }
+    return false;
+  }
+  if(sht4x_state == SHT4X_STATE_IDLE && acq->sht4x->sht->state == SHT4X_STATE_MEASURING
+     && acq->sht4x->state != SHT4X_RECOVERY_HEATING) {
+    /* the policy just started a conversion, read the ADC channels while it runs */
+    acquisition_start_cycle(acq);
+    return false;
+  }
+  if(timer_timedout(&acq->period_timer)) {
+    acquisition_start_cycle(acq);
+    acquisition_publish(acq, 0);
+    return true;
+  }
+  return false;
+}
+/*---------------------------------------------------------------------------*/
+const acquisition_record_t *
+acquisition_get_record(const acquisition_t *acq)
+{
+  if(acq == NULL || !acq->valid) {
+    return NULL;
+  }
+  return &acq->record;
+}
+/*---------------------------------------------------------------------------*/
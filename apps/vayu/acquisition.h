@@ -0,0 +1,81 @@
+/*!
+*\file  acquisition.h
+*\brief This file holds the vayu acquisition cycle manager. A cycle is started together with
+*       each SHT4X conversion picked by the sampling policy. While the SHT4X converts, the
+*       enable pins of all the ADC channels are switched on once, the NTC and supply divider
+*       channels are converted in two ADC scans and switched off again. When the SHT4X result is in,
+*       all values go out as one record with the timestamp of the cycle start. If the SHT4X
+*       is not sampling (heater pulse, bus error) a cycle with the ADC channels only is run
+*       every ACQUISITION_PERIOD_MS so that the control loop never runs on old values.
+*       Channels in an ADC power domain get one power window from the cycle start until the
+*       record is published, reads in between do not wait for the front end again.
+*/
+
+#ifndef _ACQUISITION_H_
+#define _ACQUISITION_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "vayu.h"
+#include "clock.h"
+#include "timer.h"
+#include "ntc.h"
+#include "sht4x-recovery.h"
+
+#define ACQUISITION_PERIOD_MS           1000  /* longest time between two cycles */
+
+#define ACQUISITION_FLAG_SHT4X_VALID    0x01  /* SHT4X values were measured in this cycle */
+#define ACQUISITION_FLAG_SHT4X_FLAGGED  0x02  /* SHT4X is in heater recovery, values are the last good ones */
+#define ACQUISITION_FLAG_NTC_ERROR      0x04  /* at least one NTC reading is NTC_ERROR */
+#define ACQUISITION_FLAG_ADC_ERROR      0x08  /* a scan did not run, its NTCs are NTC_ERROR, supplies 0 */
+
+typedef struct acquisition_record {
+  clock_time_t timestamp_ms;            /* cycle start, all values belong to this time */
+  uint32_t sequence;                    /* record number since boot */
+  int32_t sht4x_temp_mC;                /* last good SHT4X temperature */
+  uint16_t sht4x_rh_100x;               /* last good SHT4X humidity, %RH x 100 */
+  int32_t ntc_temp_mC[NTC_TOTAL];       /* NTC temperatures or NTC_ERROR */
+  uint32_t supply_mV;                   /* board supply, 0 if not read */
+  uint32_t fan_supply_mV;               /* 12V fan supply, 0 if not read */
+  uint16_t cycle_ms;                    /* time from cycle start to the record */
+  uint8_t flags;                        /* ACQUISITION_FLAG_x */
+} acquisition_record_t;
+
+typedef struct acquisition {
+  sht4x_recovery_t *sht4x;              /* SHT4X with its policy and recovery scheduler */
+  ntc_thermistor_t *ntc;                /* NTC_TOTAL thermistors */
+  ttimer_t period_timer;                /* runs an ADC only cycle when the SHT4X is quiet */
+  bool pending;                         /* ADC channels are read, waiting for the SHT4X */
+  bool valid;                           /* true once a record was published */
+  bool scan_ready;                      /* ADC scan groups are set up */
+  bool power_open;                      /* power windows of the ADC power domains are open */
+  acquisition_record_t cycle;           /* record being collected */
+  acquisition_record_t record;          /* last published record */
+  uint32_t adc_only_cycles;             /* cycles published without a SHT4X sample */
+} acquisition_t;
+
+/*!
+* \fn     void acquisition_init(acquisition_t *acq, sht4x_recovery_t *sht4x, ntc_thermistor_t *ntc)
+* \brief  Function initializes the cycle manager. The SHT4X recovery scheduler and the NTC ADC
+*         devices must be initialized before.
+* \param  acq pointer to acquisition structure.
+* \param  sht4x pointer to SHT4X recovery scheduler, it is polled by the manager from now on.
+* \param  ntc pointer to array of NTC_TOTAL thermistors.
+*/
+void acquisition_init(acquisition_t *acq, sht4x_recovery_t *sht4x, ntc_thermistor_t *ntc);
+
+/*!
+* \fn     bool acquisition_poll(acquisition_t *acq)
+* \brief  Function runs the SHT4X scheduler and the cycle. Call this from the application poll
+*         loop instead of sht4x_recovery_poll.
+* \param  acq pointer to acquisition structure.
+* \return Function returns true when a new record was published.
+*/
+bool acquisition_poll(acquisition_t *acq);
+
+/*!
+* \fn     const acquisition_record_t *acquisition_get_record(const acquisition_t *acq)
+* \brief  Function returns the last published record or NULL if there is none yet.
+*/
+const acquisition_record_t *acquisition_get_record(const acquisition_t *acq);
+#endif /* _ACQUISITION_H_ */
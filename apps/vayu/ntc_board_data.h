@@ -0,0 +1,180 @@
+/* generated by tools/ntc_data_generator.c, do not edit */
+#ifndef NTC_BOARD_DATA_H_
+#define NTC_BOARD_DATA_H_
+
+#include <stdint.h>
+
+/* R0:100000 ohm T0:25.0 C Beta:4250 pulled down known resistance:200000 ohm VCC:3.000 V ADC ref:3.000 V 12 bits */
+#define NTC_BOARD_MIN_TEMP_C      -20
+#define NTC_BOARD_MAX_TEMP_C      125
+#define NTC_BOARD_TEMP_STEP       1
+#define NTC_BOARD_RT_ENTRIES      146
+#define NTC_BOARD_CODE_ENTRIES    40
+
+/* resistance in ohms, temperature (C), microvolts, ADC value */
+static const uint32_t ntc_board_rt_chart[NTC_BOARD_RT_ENTRIES] = {
+     1260250UL, /*  -20,    2589112,  3534 */
+     1179692UL, /*  -19,    2565120,  3501 */
+     1104854UL, /*  -18,    2540179,  3467 */
+     1035294UL, /*  -17,    2514286,  3432 */
+      970604UL, /*  -16,    2487444,  3395 */
+      910412UL, /*  -15,    2459660,  3357 */
+      854374UL, /*  -14,    2430942,  3318 */
+      802177UL, /*  -13,    2401303,  3277 */
+      753533UL, /*  -12,    2370761,  3236 */
+      708176UL, /*  -11,    2339335,  3193 */
+      665864UL, /*  -10,    2307050,  3149 */
+      626371UL, /*   -9,    2273934,  3103 */
+      589493UL, /*   -8,    2240019,  3057 */
+      555039UL, /*   -7,    2205340,  3010 */
+      522835UL, /*   -6,    2169935,  2961 */
+      492719UL, /*   -5,    2133848,  2912 */
+      464542UL, /*   -4,    2097122,  2862 */
+      438167UL, /*   -3,    2059808,  2811 */
+      413469UL, /*   -2,    2021955,  2759 */
+      390328UL, /*   -1,    1983617,  2707 */
+      368639UL, /*    0,    1944848,  2654 */
+      348299UL, /*    1,    1905707,  2601 */
+      329218UL, /*    2,    1866252,  2547 */
+      311309UL, /*    3,    1826542,  2493 */
+      294493UL, /*    4,    1786637,  2438 */
+      278697UL, /*    5,    1746598,  2384 */
+      263852UL, /*    6,    1706485,  2329 */
+      249896UL, /*    7,    1666358,  2274 */
+      236769UL, /*    8,    1626277,  2219 */
+      224418UL, /*    9,    1586299,  2165 */
+      212791UL, /*   10,    1546481,  2110 */
+      201843UL, /*   11,    1506879,  2056 */
+      191528UL, /*   12,    1467544,  2003 */
+      181808UL, /*   13,    1428529,  1949 */
+      172643UL, /*   14,    1389881,  1897 */
+      163999UL, /*   15,    1351646,  1844 */
+      155844UL, /*   16,    1313867,  1793 */
+      148146UL, /*   17,    1276584,  1742 */
+      140877UL, /*   18,    1239834,  1692 */
+      134011UL, /*   19,    1203652,  1642 */
+      127523UL, /*   20,    1168068,  1594 */
+      121390UL, /*   21,    1133111,  1546 */
+      115591UL, /*   22,    1098805,  1499 */
+      110105UL, /*   23,    1065173,  1453 */
+      104914UL, /*   24,    1032232,  1408 */
+      100000UL, /*   25,    1000000,  1365 */
+       95347UL, /*   26,     968489,  1321 */
+       90939UL, /*   27,     937711,  1279 */
+       86762UL, /*   28,     907673,  1238 */
+       82803UL, /*   29,     878380,  1198 */
+       79049UL, /*   30,     849837,  1160 */
+       75488UL, /*   31,     822044,  1122 */
+       72109UL, /*   32,     795000,  1085 */
+       68902UL, /*   33,     768703,  1049 */
+       65857UL, /*   34,     743149,  1014 */
+       62965UL, /*   35,     718331,   980 */
+       60218UL, /*   36,     694241,   947 */
+       57607UL, /*   37,     670872,   915 */
+       55125UL, /*   38,     648214,   884 */
+       52765UL, /*   39,     626254,   854 */
+       50520UL, /*   40,     604982,   825 */
+       48384UL, /*   41,     584386,   797 */
+       46351UL, /*   42,     564450,   770 */
+       44415UL, /*   43,     545163,   744 */
+       42572UL, /*   44,     526509,   718 */
+       40816UL, /*   45,     508473,   694 */
+       39143UL, /*   46,     491041,   670 */
+       37548UL, /*   47,     474198,   647 */
+       36028UL, /*   48,     457927,   625 */
+       34578UL, /*   49,     442213,   603 */
+       33195UL, /*   50,     427042,   582 */
+       31875UL, /*   51,     412396,   562 */
+       30615UL, /*   52,     398261,   543 */
+       29412UL, /*   53,     384622,   525 */
+       28264UL, /*   54,     371463,   507 */
+       27167UL, /*   55,     358769,   489 */
+       26119UL, /*   56,     346525,   473 */
+       25117UL, /*   57,     334717,   456 */
+       24159UL, /*   58,     323330,   441 */
+       23243UL, /*   59,     312351,   426 */
+       22368UL, /*   60,     301766,   411 */
+       21530UL, /*   61,     291561,   397 */
+       20728UL, /*   62,     281723,   384 */
+       19961UL, /*   63,     272240,   371 */
+       19226UL, /*   64,     263099,   359 */
+       18523UL, /*   65,     254288,   347 */
+       17849UL, /*   66,     245794,   335 */
+       17203UL, /*   67,     237608,   324 */
+       16584UL, /*   68,     229718,   313 */
+       15991UL, /*   69,     222112,   303 */
+       15423UL, /*   70,     214781,   293 */
+       14878UL, /*   71,     207715,   283 */
+       14355UL, /*   72,     200903,   274 */
+       13853UL, /*   73,     194337,   265 */
+       13372UL, /*   74,     188007,   256 */
+       12910UL, /*   75,     181904,   248 */
+       12466UL, /*   76,     176021,   240 */
+       12040UL, /*   77,     170349,   232 */
+       11631UL, /*   78,     164879,   225 */
+       11238UL, /*   79,     159605,   217 */
+       10861UL, /*   80,     154519,   210 */
+       10498UL, /*   81,     149614,   204 */
+       10149UL, /*   82,     144883,   197 */
+        9814UL, /*   83,     140320,   191 */
+        9491UL, /*   84,     135918,   185 */
+        9181UL, /*   85,     131671,   179 */
+        8883UL, /*   86,     127573,   174 */
+        8596UL, /*   87,     123620,   168 */
+        8319UL, /*   88,     119804,   163 */
+        8053UL, /*   89,     116122,   158 */
+        7797UL, /*   90,     112568,   153 */
+        7551UL, /*   91,     109137,   148 */
+        7313UL, /*   92,     105825,   144 */
+        7084UL, /*   93,     102628,   140 */
+        6864UL, /*   94,      99540,   135 */
+        6651UL, /*   95,      96558,   131 */
+        6446UL, /*   96,      93678,   127 */
+        6249UL, /*   97,      90896,   124 */
+        6059UL, /*   98,      88208,   120 */
+        5875UL, /*   99,      85612,   116 */
+        5698UL, /*  100,      83103,   113 */
+        5527UL, /*  101,      80678,   110 */
+        5362UL, /*  102,      78335,   106 */
+        5203UL, /*  103,      76070,   103 */
+        5050UL, /*  104,      73880,   100 */
+        4901UL, /*  105,      71763,    97 */
+        4758UL, /*  106,      69715,    95 */
+        4620UL, /*  107,      67736,    92 */
+        4486UL, /*  108,      65821,    89 */
+        4357UL, /*  109,      63968,    87 */
+        4233UL, /*  110,      62176,    84 */
+        4112UL, /*  111,      60442,    82 */
+        3996UL, /*  112,      58764,    80 */
+        3883UL, /*  113,      57140,    77 */
+        3774UL, /*  114,      55568,    75 */
+        3669UL, /*  115,      54047,    73 */
+        3567UL, /*  116,      52573,    71 */
+        3469UL, /*  117,      51147,    69 */
+        3374UL, /*  118,      49765,    67 */
+        3281UL, /*  119,      48427,    66 */
+        3192UL, /*  120,      47131,    64 */
+        3106UL, /*  121,      45876,    62 */
+        3022UL, /*  122,      44659,    60 */
+        2941UL, /*  123,      43480,    59 */
+        2863UL, /*  124,      42338,    57 */
+        2787UL  /*  125,      41231,    56 */
+};
+
+/* ADC codes of the code table entries, ascending */
+static const uint16_t ntc_board_code_points[NTC_BOARD_CODE_ENTRIES] = {
+      57,     63,     69,     75,     82,     90,     99,    109,    120,    132,
+     145,    160,    176,    194,    214,    236,    262,    291,    323,    359,
+     399,    446,    498,    557,    623,    699,    786,    885,    993,   1117,
+    1269,   1446,   1660,   1938,   2721,   2966,   3155,   3312,   3439,   3535
+};
+
+/* temperature in 0.01 C at the ADC codes of ntc_board_code_points */
+static const int16_t ntc_board_code_table[NTC_BOARD_CODE_ENTRIES] = {
+   12453,  12078,  11744,  11441,  11123,  10795,  10464,  10136,   9812,   9496,
+    9188,   8871,   8567,   8261,   7956,   7655,   7338,   7023,   6713,   6402,
+    6093,   5770,   5452,   5131,   4810,   4480,   4143,   3800,   3464,   3114,
+    2727,   2318,   1866,   1323,   -124,   -607,  -1011,  -1382,  -1717,  -2000
+};
+
+#endif /* NTC_BOARD_DATA_H_ */
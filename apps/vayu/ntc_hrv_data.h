@@ -0,0 +1,178 @@
+/* generated by tools/ntc_data_generator.c, do not edit */
+#ifndef NTC_HRV_DATA_H_
+#define NTC_HRV_DATA_H_
+
+#include <stdint.h>
+
+/* R0:100000 ohm T0:25.0 C Beta:3950 pulled down known resistance:200000 ohm VCC:3.300 V ADC ref:3.000 V 12 bits */
+#define NTC_HRV_MIN_TEMP_C      -18
+#define NTC_HRV_MAX_TEMP_C      125
+#define NTC_HRV_TEMP_STEP       1
+#define NTC_HRV_RT_ENTRIES      144
+#define NTC_HRV_CODE_ENTRIES    38
+
+/* resistance in ohms, temperature (C), microvolts, ADC value */
+static const uint32_t ntc_hrv_rt_chart[NTC_HRV_RT_ENTRIES] = {
+      932524UL, /*  -18,    2717231,  3709 */
+      877834UL, /*  -17,    2687661,  3668 */
+      826740UL, /*  -16,    2657188,  3627 */
+      778981UL, /*  -15,    2625830,  3584 */
+      734319UL, /*  -14,    2593603,  3540 */
+      692531UL, /*  -13,    2560530,  3495 */
+      653415UL, /*  -12,    2526636,  3448 */
+      616781UL, /*  -11,    2491950,  3401 */
+      582457UL, /*  -10,    2456503,  3353 */
+      550282UL, /*   -9,    2420330,  3303 */
+      520106UL, /*   -8,    2383469,  3253 */
+      491794UL, /*   -7,    2345959,  3202 */
+      465218UL, /*   -6,    2307844,  3150 */
+      440260UL, /*   -5,    2269170,  3097 */
+      416813UL, /*   -4,    2229983,  3043 */
+      394773UL, /*   -3,    2190334,  2989 */
+      374049UL, /*   -2,    2150273,  2935 */
+      354554UL, /*   -1,    2109854,  2879 */
+      336206UL, /*    0,    2069130,  2824 */
+      318931UL, /*    1,    2028156,  2768 */
+      302660UL, /*    2,    1986986,  2712 */
+      287328UL, /*    3,    1945677,  2655 */
+      272875UL, /*    4,    1904283,  2599 */
+      259246UL, /*    5,    1862861,  2542 */
+      246387UL, /*    6,    1821463,  2486 */
+      234251UL, /*    7,    1780143,  2429 */
+      222793UL, /*    8,    1738954,  2373 */
+      211971UL, /*    9,    1697947,  2317 */
+      201746UL, /*   10,    1657170,  2262 */
+      192080UL, /*   11,    1616672,  2206 */
+      182941UL, /*   12,    1576497,  2151 */
+      174296UL, /*   13,    1536689,  2097 */
+      166115UL, /*   14,    1497289,  2043 */
+      158371UL, /*   15,    1458336,  1990 */
+      151039UL, /*   16,    1419865,  1938 */
+      144092UL, /*   17,    1381909,  1886 */
+      137510UL, /*   18,    1344501,  1835 */
+      131270UL, /*   19,    1307668,  1784 */
+      125353UL, /*   20,    1271436,  1735 */
+      119741UL, /*   21,    1235827,  1686 */
+      114415UL, /*   22,    1200862,  1639 */
+      109360UL, /*   23,    1166560,  1592 */
+      104559UL, /*   24,    1132935,  1546 */
+      100000UL, /*   25,    1100000,  1501 */
+       95668UL, /*   26,    1067766,  1457 */
+       91551UL, /*   27,    1036242,  1414 */
+       87636UL, /*   28,    1005434,  1372 */
+       83913UL, /*   29,     975345,  1331 */
+       80371UL, /*   30,     945980,  1291 */
+       77001UL, /*   31,     917337,  1252 */
+       73793UL, /*   32,     889416,  1214 */
+       70738UL, /*   33,     862215,  1176 */
+       67828UL, /*   34,     835730,  1140 */
+       65055UL, /*   35,     809954,  1105 */
+       62413UL, /*   36,     784881,  1071 */
+       59894UL, /*   37,     760504,  1038 */
+       57492UL, /*   38,     736814,  1005 */
+       55201UL, /*   39,     713801,   974 */
+       53015UL, /*   40,     691456,   943 */
+       50928UL, /*   41,     669765,   914 */
+       48936UL, /*   42,     648719,   885 */
+       47034UL, /*   43,     628305,   857 */
+       45217UL, /*   44,     608510,   830 */
+       43481UL, /*   45,     589320,   804 */
+       41822UL, /*   46,     570724,   779 */
+       40236UL, /*   47,     552706,   754 */
+       38720UL, /*   48,     535254,   730 */
+       37269UL, /*   49,     518352,   707 */
+       35882UL, /*   50,     501989,   685 */
+       34554UL, /*   51,     486148,   663 */
+       33283UL, /*   52,     470817,   642 */
+       32066UL, /*   53,     455982,   622 */
+       30901UL, /*   54,     441628,   602 */
+       29784UL, /*   55,     427742,   583 */
+       28715UL, /*   56,     414310,   565 */
+       27690UL, /*   57,     401319,   547 */
+       26707UL, /*   58,     388756,   530 */
+       25765UL, /*   59,     376608,   514 */
+       24862UL, /*   60,     364862,   498 */
+       23995UL, /*   61,     353505,   482 */
+       23163UL, /*   62,     342526,   467 */
+       22365UL, /*   63,     331911,   453 */
+       21599UL, /*   64,     321651,   439 */
+       20864UL, /*   65,     311732,   425 */
+       20157UL, /*   66,     302144,   412 */
+       19479UL, /*   67,     292877,   399 */
+       18827UL, /*   68,     283918,   387 */
+       18201UL, /*   69,     275259,   375 */
+       17598UL, /*   70,     266889,   364 */
+       17019UL, /*   71,     258798,   353 */
+       16463UL, /*   72,     250978,   342 */
+       15927UL, /*   73,     243418,   332 */
+       15412UL, /*   74,     236109,   322 */
+       14917UL, /*   75,     229044,   312 */
+       14440UL, /*   76,     222214,   303 */
+       13981UL, /*   77,     215611,   294 */
+       13539UL, /*   78,     209227,   285 */
+       13113UL, /*   79,     203054,   277 */
+       12703UL, /*   80,     197085,   269 */
+       12308UL, /*   81,     191313,   261 */
+       11928UL, /*   82,     185731,   253 */
+       11561UL, /*   83,     180332,   246 */
+       11208UL, /*   84,     175111,   239 */
+       10867UL, /*   85,     170061,   232 */
+       10538UL, /*   86,     165175,   225 */
+       10221UL, /*   87,     160449,   219 */
+        9915UL, /*   88,     155876,   212 */
+        9620UL, /*   89,     151452,   206 */
+        9336UL, /*   90,     147170,   200 */
+        9061UL, /*   91,     143027,   195 */
+        8796UL, /*   92,     139017,   189 */
+        8540UL, /*   93,     135136,   184 */
+        8292UL, /*   94,     131379,   179 */
+        8054UL, /*   95,     127742,   174 */
+        7823UL, /*   96,     124220,   169 */
+        7600UL, /*   97,     120810,   164 */
+        7385UL, /*   98,     117508,   160 */
+        7176UL, /*   99,     114310,   156 */
+        6975UL, /*  100,     111212,   151 */
+        6781UL, /*  101,     108212,   147 */
+        6592UL, /*  102,     105305,   143 */
+        6410UL, /*  103,     102488,   139 */
+        6234UL, /*  104,      99759,   136 */
+        6064UL, /*  105,      97114,   132 */
+        5899UL, /*  106,      94551,   129 */
+        5740UL, /*  107,      92066,   125 */
+        5586UL, /*  108,      89657,   122 */
+        5436UL, /*  109,      87322,   119 */
+        5291UL, /*  110,      85058,   116 */
+        5151UL, /*  111,      82862,   113 */
+        5016UL, /*  112,      80733,   110 */
+        4884UL, /*  113,      78667,   107 */
+        4757UL, /*  114,      76663,   104 */
+        4633UL, /*  115,      74720,   101 */
+        4514UL, /*  116,      72833,    99 */
+        4398UL, /*  117,      71003,    96 */
+        4285UL, /*  118,      69227,    94 */
+        4177UL, /*  119,      67503,    92 */
+        4071UL, /*  120,      65830,    89 */
+        3968UL, /*  121,      64205,    87 */
+        3869UL, /*  122,      62628,    85 */
+        3773UL, /*  123,      61096,    83 */
+        3679UL, /*  124,      59609,    81 */
+        3588UL  /*  125,      58164,    79 */
+};
+
+/* ADC codes of the code table entries, ascending */
+static const uint16_t ntc_hrv_code_points[NTC_HRV_CODE_ENTRIES] = {
+      80,     87,     95,    104,    113,    124,    136,    148,    162,    178,
+     196,    216,    237,    261,    287,    318,    352,    391,    433,    482,
+     537,    600,    669,    748,    839,    938,   1049,   1172,   1319,   1491,
+    1694,   1942,   2279,   2988,   3264,   3469,   3636,   3709
+};
+
+/* temperature in 0.01 C at the ADC codes of ntc_hrv_code_points */
+static const int16_t ntc_hrv_code_table[NTC_HRV_CODE_ENTRIES] = {
+   12470,  12130,  11780,  11425,  11105,  10751,  10406,  10094,   9765,   9427,
+    9087,   8749,   8430,   8103,   7784,   7445,   7112,   6772,   6445,   6104,
+    5763,   5415,   5075,   4727,   4369,   4020,   3668,   3314,   2931,   2524,
+    2086,   1593,    970,   -295,   -819,  -1241,  -1619,  -1798
+};
+
+#endif /* NTC_HRV_DATA_H_ */
@@ -29,12 +29,24 @@
 #include "board.h"
 #include "vayu.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include "sht4x.h"
+#include "sht4x-policy.h"
+#include "sht4x-recovery.h"
+#include "acquisition.h"
+#include "timeseries.h"
+#include "psychrometrics.h"
+#include "estimator.h"
 #include "guart.h"
 #include "ntc.h"
+#include "ntc_board_data.h"
+#include "ntc_hrv_data.h"
 #include "fan-blower.h"
 #include "board-common.h"
 #include "clock.h"
+#include "telemetry.h"
+#include "swo_debug.h"
+#include "adc-cal-arch.h"
 
 #define FAN_OUTLET_RPM 3500
 #define FAN_INLET_RPM 3500
@@ -44,6 +56,13 @@
 #define TEMPERATURE_HRV_MODE_MAX 16000    /* 16 degree Celsius maximum temperature for HRV mode */
 #define TEMPERATURE_INLET_MODE_MIN 17000  /* 18 degree Celsius minimum temperature for Inlet mode */
 #define TEMPERATURE_INLET_MODE_MAX 22000  /* 22 degree Celsius maximum temperature for Inlet mode */
+#define DEFROSTING_LEAD_MS 30000          /* start defrosting when the trend crosses TEMPERATURE_DEFROSTING within 30 s */
+#define TELEMETRY_SAMPLE_PERIOD_MS 100    /* 10 Hz telemetry sample rate for fan and heater, NTC per acquisition record */
+#define TELEMETRY_STATS_DIVIDER    100    /* telemetry stream statistics every 10 seconds */
+#define HISTORY_RAW_SAMPLES        120    /* last 2 minutes at the 1 second acquisition period */
+#define HISTORY_MINUTES            60     /* per minute min/max/mean for the last hour */
+#define HISTORY_QUARTERS           96     /* per 15 minutes min/max/mean for the last day */
+#define ADC_CAL_CHECK_MS           60000  /* die temperature and supply drift check of the ADC calibration */
 /*---------------------------------------------------------------------------*/
 sht4x_t sht4x_sensor = {
   .last_rh_ppm = 0,
@@ -57,36 +76,49 @@ ntc_thermistor_t ntc_dev[NTC_TOTAL] = {
     .adc_dev = &BOARD_NTC_ADC_DEV,
     .beta_value_25 = 4250,
     .known_resistance_ohm = 200000,
-    .max_negative_temp_C = -20,
-    .max_positive_temp_C = 125,
+    .max_negative_temp_C = NTC_BOARD_MIN_TEMP_C,
+    .max_positive_temp_C = NTC_BOARD_MAX_TEMP_C,
     .ntc_config = NTC_PULLED_DOWN_CONFIG,
     .R0_ohm = 100000,
-    .RT_chart = NULL,
+    .RT_chart = ntc_board_rt_chart,
     .supply_mV = 3000,
+    .ratiometric = true,   /* divider and ADC reference are both VDD */
     .T0_C = 25,
-    .temp_step = 0
+    .temp_step = NTC_BOARD_TEMP_STEP,
+    .code_table = ntc_board_code_table,
+    .code_points = ntc_board_code_points,
+    .code_entries = NTC_BOARD_CODE_ENTRIES
   },
   { /* HRV NTC details */
     .adc_dev = &HA_NTC_ADC_DEV,
     .beta_value_25 = 3950,
     .known_resistance_ohm = 200000,
-    .max_negative_temp_C = -18,
-    .max_positive_temp_C = 125,
+    .max_negative_temp_C = NTC_HRV_MIN_TEMP_C,
+    .max_positive_temp_C = NTC_HRV_MAX_TEMP_C,
     .ntc_config = NTC_PULLED_DOWN_CONFIG,
     .R0_ohm = 100000,
-    .RT_chart = NULL,
+    .RT_chart = ntc_hrv_rt_chart,
     .supply_mV = 3300,
     .T0_C = 25,
-    .temp_step = 0
+    .temp_step = NTC_HRV_TEMP_STEP,
+    .code_table = ntc_hrv_code_table,
+    .code_points = ntc_hrv_code_points,
+    .code_entries = NTC_HRV_CODE_ENTRIES
   }
 };
 /*---------------------------------------------------------------------------*/
+fan_tach_t fan_tach = {
+  .irq = &FAN_TECHO_INTERRUPT
+};
 fan_blower_t fan = {
   .pulses_per_rev = 2,
   .bidir = FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM,
   .max_rpm = 5500,
   .min_rpm = 1000,
   .min_pwm = 10,
+  .kp = FAN_BLOWER_GAIN_ONE * 4 / 10,   /* 0.4 duty cycle 100x per RPM */
+  .ki = FAN_BLOWER_GAIN_ONE / 10,       /* 0.1 per 100 ms control period */
+  .tach = &fan_tach,
   .fan_blower_dir_handler = NULL,
   .current_rpm = 0,
   .current_dir = 0,
@@ -101,32 +133,180 @@ guart_t uart_debug = {
   .guart_dev = &UART_GENERIC_DEV
 };
 /*---------------------------------------------------------------------------*/
+telemetry_t telemetry;
+#ifdef USE_SWO_TRACE
+static uint16_t
+telemetry_swo_sink(const uint8_t *data, uint16_t len)
+{
+  return SWO_write_nb(SWO_CHANNEL_TELEMETRY, data, len);
+}
+#endif  /* USE_SWO_TRACE */
+/*---------------------------------------------------------------------------*/
+static sht4x_policy_t sht4x_policy;      /* picks SHT4X sampling rate and repeatability */
+static sht4x_recovery_t sht4x_recovery;  /* dries the SHT4X with the heater when it gets saturated */
+static acquisition_t acquisition;        /* reads all sensors in one cycle with the SHT4X conversion */
+/*---------------------------------------------------------------------------*/
+static void
+telemetry_sample(void)
+{
+  static uint8_t sample_count = 0;
+  static uint32_t ntc_sequence = UINT32_MAX;   /* first record is sequence 0 */
+  const acquisition_record_t *rec = acquisition_get_record(&acquisition);
+  uint8_t i;
+
+  /* the NTCs come from the acquisition cycle, reading the ADC here would block the loop
+     and give values that do not belong to the record. Sent once per new record */
+  if(rec != NULL && rec->sequence != ntc_sequence) {
+    ntc_sequence = rec->sequence;
+    for(i = 0; i < NTC_TOTAL; i++) {
+      telemetry_add_ntc(&telemetry, i, rec->ntc_temp_mC[i]);
+    }
+  }
+  telemetry_add_fan(&telemetry, 0, fan_blower_get_rpm(&fan), fan.current_dir, fan.pwm_dev->duty_cycle_100x);
+  telemetry_add_heater(&telemetry, 0, HA_HEATER_DEV.duty_cycle_100x);
+  if((sample_count % TELEMETRY_STATS_DIVIDER) == 0) {
+    telemetry_add_stats(&telemetry);
+  }
+  sample_count = (sample_count + 1) % TELEMETRY_STATS_DIVIDER;
+}
+/*---------------------------------------------------------------------------*/
+typedef enum history_id {
+  HISTORY_SHT4X_TEMP = 0,
+  HISTORY_SHT4X_RH,
+  HISTORY_NTC_HRV,
+  HISTORY_TOTAL
+} history_id_t;
+static timeseries_t history[HISTORY_TOTAL];
+static timeseries_sample_t history_raw[HISTORY_TOTAL][HISTORY_RAW_SAMPLES];
+static timeseries_bucket_t history_minute[HISTORY_TOTAL][HISTORY_MINUTES];
+static timeseries_bucket_t history_quarter[HISTORY_TOTAL][HISTORY_QUARTERS];
+static void
+history_init(void)
+{
+  uint8_t i;
+  for(i = 0; i < HISTORY_TOTAL; i++) {
+    timeseries_init(&history[i], history_raw[i], HISTORY_RAW_SAMPLES, history_minute[i], HISTORY_MINUTES,
+                    history_quarter[i], HISTORY_QUARTERS);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+history_append(const acquisition_record_t *rec)
+{
+  uint32_t time_ms = (uint32_t)rec->timestamp_ms;
+  if((rec->flags & ACQUISITION_FLAG_SHT4X_VALID) && !(rec->flags & ACQUISITION_FLAG_SHT4X_FLAGGED)) {
+    timeseries_append(&history[HISTORY_SHT4X_TEMP], time_ms, rec->sht4x_temp_mC);
+    timeseries_append(&history[HISTORY_SHT4X_RH], time_ms, rec->sht4x_rh_100x);
+  }
+  if(rec->ntc_temp_mC[NTC_HRV] != NTC_ERROR) {
+    timeseries_append(&history[HISTORY_NTC_HRV], time_ms, rec->ntc_temp_mC[NTC_HRV]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_history(const char *name, history_id_t id, uint32_t span_ms, uint16_t scale)
+{
+  timeseries_bucket_t bucket;
+  uint32_t now_ms = (uint32_t)clock_get_time_ms();
+  timeseries_tier_id_t tier = (span_ms > HISTORY_RAW_SAMPLES * 1000UL) ? TIMESERIES_TIER_MINUTE : TIMESERIES_TIER_RAW;
+  if(timeseries_query(&history[id], tier, now_ms - span_ms, now_ms, &bucket)) {
+    printf("App_poll: %s last %lu min min:%ld max:%ld mean:%ld (x%u) samples:%u\n", name, span_ms / 60000,
+           (long)bucket.min, (long)bucket.max, (long)bucket.mean, scale, bucket.count);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* heat accumulator temperature and trend. The heater and the fan are the known inputs, their
+ * gains are rough estimates, the rate state absorbs the model error */
+static const estimator_cfg_t ha_estimator_cfg = {
+  .alpha_q16 = 6554,                  /* 0.1 */
+  .beta_q16 = 345,                    /* ~ alpha^2 / (2 - alpha), critically damped */
+  .input_gain = {
+    [HA_INPUT_HEATER] = 40,           /* mC/s at 100 % heater */
+    [HA_INPUT_FAN] = 10               /* mC/s at full speed, + is exhaust i.e. warm room air */
+  },
+  .gate = 5000                        /* skip ADC spikes above 5 'C */
+};
+static estimator_t ha_estimator;
+static void
+ha_estimator_update(const acquisition_record_t *rec)
+{
+  int32_t fan_speed = 0;
+  /* the inputs set at the previous record held over the interval that ends now */
+  if(rec->ntc_temp_mC[NTC_HRV] != NTC_ERROR) {
+    estimator_update(&ha_estimator, (uint32_t)rec->timestamp_ms, rec->ntc_temp_mC[NTC_HRV]);
+  }
+  if(fan.max_rpm) {
+    fan_speed = ((int32_t)fan_blower_get_rpm(&fan) * ESTIMATOR_INPUT_FULL) / fan.max_rpm;
+  }
+  if(fan.current_dir != FAN_DIR_FORWARD) {
+    fan_speed = -fan_speed;
+  }
+  estimator_set_input(&ha_estimator, HA_INPUT_HEATER, HA_HEATER_DEV.duty_cycle_100x);
+  estimator_set_input(&ha_estimator, HA_INPUT_FAN, fan_speed);
+}
+/*---------------------------------------------------------------------------*/
+static ttimer_t adc_cal_timer;
 static void
-read_sht4x(void)
+acquisition_record_poll(void)
 {
-  int16_t temperature_mC;
-  uint16_t rh_percentage_100x;
-  uint8_t bus_status;
-  bus_status = shrt4x_get_temp_humidity(&sht4x_sensor, &temperature_mC, &rh_percentage_100x);
-  if(bus_status == BUS_OK) {
-    printf("App_poll: sht4x temperature:%03d.%02u 'C humidity:%02u.%02u %%RH\n", 
-           (int16_t)(temperature_mC / 1000), 
-           (int16_t)(temperature_mC % 1000) / 10, 
-           rh_percentage_100x / 100, 
-           rh_percentage_100x % 100);
+  const acquisition_record_t *rec;
+  if(acquisition_poll(&acquisition)) {
+    rec = acquisition_get_record(&acquisition);
+    history_append(rec);
+    ha_estimator_update(rec);
+    /* the ADC is idle between acquisition cycles, recalibrate it only if it drifted */
+    if(timer_timedout(&adc_cal_timer)) {
+      timer_set(&adc_cal_timer, ADC_CAL_CHECK_MS);
+      if(adc_cal_arch_poll(BOARD_ADC_PER, rec->supply_mV)) {
+        printf("App_poll: ADC recalibrated\n");
+      }
+    }
+    /* samples taken while the sensor cools down after a heater pulse are not sent */
+    if((rec->flags & ACQUISITION_FLAG_SHT4X_VALID) && !(rec->flags & ACQUISITION_FLAG_SHT4X_FLAGGED)) {
+      telemetry_add_sht4x(&telemetry, 0, rec->sht4x_temp_mC, rec->sht4x_rh_100x);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_sht4x(const acquisition_record_t *rec)
+{
+  const sht4x_stats_t *stats;
+  int32_t dew_point_mC;
+  if(sht4x_recovery_get_value(&sht4x_recovery, NULL, NULL)) {
+    printf("App_poll: sht4x %stemperature:%03d.%02u 'C humidity:%02u.%02u %%RH\n", 
+           (rec->flags & ACQUISITION_FLAG_SHT4X_FLAGGED) ? "(heater recovery, last good) " : "",
+           (int16_t)(rec->sht4x_temp_mC / 1000), 
+           (int16_t)(rec->sht4x_temp_mC % 1000) / 10, 
+           rec->sht4x_rh_100x / 100, 
+           rec->sht4x_rh_100x % 100);
+    dew_point_mC = psychro_frost_point_mC(rec->sht4x_temp_mC, rec->sht4x_rh_100x);
+    if(dew_point_mC != PSYCHRO_ERROR) {
+      printf("App_poll: sht4x %s point:%03d.%02u 'C absolute humidity:%lu mg/m3\n",
+             (dew_point_mC < 0) ? "frost" : "dew",
+             (int16_t)(dew_point_mC / 1000), (uint16_t)(abs(dew_point_mC) % 1000) / 10,
+             psychro_absolute_humidity_mg_m3(rec->sht4x_temp_mC, rec->sht4x_rh_100x));
+    }
+    stats = sht4x_get_stats(&sht4x_sensor);
+    printf("App_poll: sht4x policy mode:%u samples high:%lu medium:%lu low:%lu conversion:%lu ms errors:%lu"
+           " heater pulses:%lu flagged:%lu\n",
+           sht4x_policy_get_mode(&sht4x_policy),
+           stats->samples[SHT4X_REPEATABILITY_HIGH], stats->samples[SHT4X_REPEATABILITY_MEDIUM],
+           stats->samples[SHT4X_REPEATABILITY_LOW], stats->conversion_ms, stats->errors,
+           stats->heater_pulses, sht4x_recovery.flagged_samples);
   } else {
     printf("App_poll: Failed to read measurement!!!\n");
   }
 }
 /*---------------------------------------------------------------------------*/
 static void
-read_ntc(uint8_t ntc_type) 
+read_ntc(const acquisition_record_t *rec, uint8_t ntc_type) 
 {
   int32_t temp_mC = 0;
   if(ntc_type >= NTC_TOTAL) { 
     return;
   }
-  temp_mC = ntc_read_temp_mc_using_beta(&ntc_dev[ntc_type]);
+  temp_mC = rec->ntc_temp_mC[ntc_type];
   if(temp_mC == NTC_ERROR) {
     printf("App_poll: NTC error\n");
   } else {
@@ -144,6 +324,119 @@ read_ntc(uint8_t ntc_type)
   }
 }
 /*---------------------------------------------------------------------------*/
+static void
+read_adc_stats(void)
+{
+  const adc_sleep_stats_t *sleep = adc_dev_get_sleep_stats();
+  const adc_dev_stats_t *supply = &BOARD_SUPPLY_ADC_DEV.stats;
+  const adc_power_domain_t *domain;
+  const adc_power_stats_t *power;
+  uint8_t i;
+  printf("App_poll: ADC wait:%lu ms EM1:%lu ms EM0:%lu ms sleeps:%lu single reads:%lu latency avg:%lu max:%lu us\n",
+         (uint32_t)(sleep->wait_us / 1000), (uint32_t)(sleep->em1_us / 1000),
+         (uint32_t)((sleep->wait_us - sleep->em1_us) / 1000), sleep->sleeps, supply->reads,
+         supply->reads ? (uint32_t)(supply->total_latency_us / supply->reads) : 0, supply->max_latency_us);
+  if(HA_NTC_ADC_DEV.filter != NULL) {
+    printf("App_poll: NTC_HRV filter samples:%lu outliers:%lu\n",
+           HA_NTC_ADC_DEV.filter->samples, HA_NTC_ADC_DEV.filter->outliers);
+  }
+  for(i = 0; i < NTC_TOTAL; i++) {
+    domain = ntc_dev[i].adc_dev->power_domain;
+    /* NTCs next to each other can share a domain, print it once */
+    if(domain == NULL || (i > 0 && domain == ntc_dev[i - 1].adc_dev->power_domain)) {
+      continue;
+    }
+    power = adc_power_domain_get_stats(domain);
+    printf("App_poll: NTC %u power windows:%lu opens:%lu settle waits:%lu on:%lu ms max window:%lu ms\n", i,
+           power->windows, power->opens, power->settle_waits, (uint32_t)power->on_ms, power->max_window_ms);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+read_acquisition(void)
+{
+  const acquisition_record_t *rec = acquisition_get_record(&acquisition);
+  if(rec == NULL) {
+    printf("App_poll: no acquisition record yet\n");
+    return;
+  }
+  printf("App_poll: record:%lu @%lu ms cycle:%u ms adc only:%lu VCC:%lu mV VDD:%lu mV\n",
+         rec->sequence, (uint32_t)rec->timestamp_ms, rec->cycle_ms, acquisition.adc_only_cycles,
+         rec->supply_mV, rec->fan_supply_mV);
+  read_sht4x(rec);
+  read_ntc(rec, NTC_HRV);
+  read_ntc(rec, NTC_BOARD);
+  read_adc_stats();
+  printf("App_poll: fan set:%u RPM measured:%u RPM duty:%u techo pulses:%lu glitches:%lu\n",
+         fan.current_rpm, fan_blower_get_rpm(&fan), fan.pwm_dev->duty_cycle_100x,
+         fan_tach.pulses, fan_tach.glitches);
+  printf("App_poll: HA filtered temperature:%03d.%02u 'C trend:%ld mC/min\n",
+         (int16_t)(estimator_get_value(&ha_estimator) / 1000), (int16_t)(estimator_get_value(&ha_estimator) % 1000) / 10,
+         (long)estimator_get_rate(&ha_estimator) * 60);
+  read_history("sht4x temperature", HISTORY_SHT4X_TEMP, 15 * 60000UL, 1000);
+  read_history("sht4x humidity", HISTORY_SHT4X_RH, 15 * 60000UL, 100);
+  read_history("NTC_HRV temperature", HISTORY_NTC_HRV, 15 * 60000UL, 1000);
+}
+/*---------------------------------------------------------------------------*/
+#ifdef VAYU_ADC_BENCH
+#define ADC_BENCH_READS            32     /* reads per bench run */
+/* compares hardware oversampling with software averaging: time per read and noise. The cycle
+ * counter stops while the core sleeps, so it gives the active CPU time next to the read latency */
+static void
+adc_bench_run(const char *name, adc_dev_t *dev, uint16_t samples, bool sw_average)
+{
+  adc_dev_t bench_dev = {
+    .adc_avg_samples = samples,
+    .adc_sw_average = sw_average,
+    .power_up_delay_ms = dev->power_up_delay_ms,
+    .adc_config = dev->adc_config,
+    .adc_dev_enable = dev->adc_dev_enable
+  };
+  uint32_t uv[ADC_BENCH_READS];
+  uint32_t start, cycles = 0;
+  uint64_t sum = 0, var = 0;
+  uint32_t mean, noise = 0;
+  int32_t diff;
+  uint8_t i;
+
+  for(i = 0; i < ADC_BENCH_READS; i++) {
+    start = clock_get_cycles();
+    if(adc_dev_read_microvolts(&bench_dev, &uv[i]) != ADC_OK) {
+      printf("ADC bench: %s read failed\n", name);
+      return;
+    }
+    cycles += clock_get_cycles() - start;
+    sum += uv[i];
+  }
+  mean = (uint32_t)(sum / ADC_BENCH_READS);
+  for(i = 0; i < ADC_BENCH_READS; i++) {
+    diff = (int32_t)(uv[i] - mean);
+    var += (uint64_t)((int64_t)diff * diff);
+  }
+  var /= ADC_BENCH_READS;
+  /* integer square root for the standard deviation */
+  while(((uint64_t)(noise + 1) * (noise + 1)) <= var) {
+    noise++;
+  }
+  printf("ADC bench: %s %4u samples %s: %6lu us/read active:%6lu us mean:%lu uV noise:%lu uV\n", name, samples,
+         sw_average ? "software" : "hardware", (uint32_t)(bench_dev.stats.total_latency_us / ADC_BENCH_READS),
+         clock_cycles_to_us(cycles / ADC_BENCH_READS), mean, noise);
+}
+/*---------------------------------------------------------------------------*/
+static void
+adc_bench(void)
+{
+  static const uint16_t ratios[] = { 4, 16, 128, 1024 };
+  uint8_t i;
+  for(i = 0; i < sizeof(ratios) / sizeof(ratios[0]); i++) {
+    adc_bench_run("NTC_HRV", &HA_NTC_ADC_DEV, ratios[i], true);
+    adc_bench_run("NTC_HRV", &HA_NTC_ADC_DEV, ratios[i], false);
+    adc_bench_run("NTC_BOARD", &BOARD_NTC_ADC_DEV, ratios[i], true);
+    adc_bench_run("NTC_BOARD", &BOARD_NTC_ADC_DEV, ratios[i], false);
+  }
+}
+#endif  /* VAYU_ADC_BENCH */
+/*---------------------------------------------------------------------------*/
 volatile hrv_mode_t mode_hrv = HRV_MODE_OFF; /* default mode is OFF */
 static void 
 mode_button_handler(gpio_interrupt_t *button) {
@@ -167,17 +460,35 @@ led_error_blink(void)
 }
 /*---------------------------------------------------------------------------*/
 ttimer_t poll_timer;
+ttimer_t telemetry_timer;
 uint8_t 
 app_init(void) {
   guart_init(&uart_debug);              /* Initialize generic UART */
   guart_set_debug_stdo(&uart_debug);    /* Set the debug UART */
+  telemetry_init(&telemetry, &uart_debug, TELEMETRY_SAMPLE_PERIOD_MS);  /* one frame per sample period */
+#ifdef USE_SWO_TRACE
+  telemetry_set_sink(&telemetry, telemetry_swo_sink);  /* keep the uart free, stream telemetry on SWO */
+#endif  /* USE_SWO_TRACE */
+#ifdef VAYU_LOG_TELEMETRY
+  telemetry_set_log_stream(&telemetry); /* log messages go out as binary records with the telemetry */
+#endif  /* VAYU_LOG_TELEMETRY */
   sht4x_init(&sht4x_sensor);            /* Initialize the SHT4X sensor */
+  sht4x_policy_init(&sht4x_policy, &sht4x_sensor, NULL);
+  sht4x_recovery_init(&sht4x_recovery, &sht4x_sensor, &sht4x_policy);
+#ifdef VAYU_ADC_BENCH
+  adc_bench();
+#endif  /* VAYU_ADC_BENCH */
+  acquisition_init(&acquisition, &sht4x_recovery, ntc_dev);
+  history_init();
+  estimator_init(&ha_estimator, &ha_estimator_cfg);
   fan_blower_init(&fan);                /* This will enable the FAN, initialize the PWM 
                                           arch and set 50% duty cycle to keep the FAN Off */
   pwm_dev_init(&HA_HEATER_DEV);         /* Initialize the heater pwm. keep the duty cycle 0% i.e. OFF */
   MODE_BUTTON.callback = mode_button_handler;  /* Set callback function for mode button */
   gpio_interrupt(&MODE_BUTTON, true);  /* Enable GPIO interrupt for mode button */
   timer_set(&poll_timer,  0);
+  timer_set(&telemetry_timer, TELEMETRY_SAMPLE_PERIOD_MS);
+  timer_set(&adc_cal_timer, ADC_CAL_CHECK_MS);
   mode_hrv = HRV_MODE_OFF;              /* default mode is OFF */
   return 0;
 }
@@ -196,6 +507,7 @@ static ttimer_t HA_heater_setting_changed_timer = {.start_time = 0,
 const uint32_t HA_heater_setting_changed_time_ms = 5 * 1000;
 int32_t HA_temp_mC = 0;     /* Heat Accumulator temperature in milli Celsius */
 serial_bus_status_t bus_status = BUS_OK;
+const acquisition_record_t *rec;
 
   if(!system_err_flag) {
     if(mode_hrv != mode_hrv_previous) {
@@ -229,12 +541,18 @@ serial_bus_status_t bus_status = BUS_OK;
     }
     if(mode_hrv == HRV_MODE_AUTO) {
       /* HRV algorithm */
-      if(timer_timedout(&HA_heater_setting_changed_timer)) {
-        HA_temp_mC = ntc_read_temp_mc_using_beta(&ntc_dev[NTC_HRV]);
+      rec = acquisition_get_record(&acquisition);
+      if(rec != NULL && timer_timedout(&HA_heater_setting_changed_timer)) {
+        /* act on the filtered temperature, single noisy samples made the outputs chatter */
+        HA_temp_mC = rec->ntc_temp_mC[NTC_HRV];
+        if(HA_temp_mC != NTC_ERROR) {
+          HA_temp_mC = estimator_get_value(&ha_estimator);
+        }
         if(HA_temp_mC != NTC_ERROR && bus_status == BUS_OK) {
           
-          /* Defrosting or very low temperature */
-          if(HA_temp_mC < TEMPERATURE_DEFROSTING) {
+          /* Defrosting or very low temperature. Start early if the trend reaches it soon */
+          if(HA_temp_mC < TEMPERATURE_DEFROSTING
+             || estimator_time_to_reach_ms(&ha_estimator, TEMPERATURE_DEFROSTING) < DEFROSTING_LEAD_MS) {
             /* This could mean frosting so we need to defrost by using heater */
             if(HA_HEATER_DEV.duty_cycle_100x != 10000) {
               pwm_dev_set_duty_cycle(&HA_HEATER_DEV, 10000);
@@ -313,11 +631,16 @@ serial_bus_status_t bus_status = BUS_OK;
   }
   if(timer_timedout(&poll_timer)) {
     printf("\n");
-    read_sht4x();
-    read_ntc(NTC_HRV);
-    read_ntc(NTC_BOARD);
+    read_acquisition();
     led_sys_blink(LED_SYS_YELLOW_PORT, LED_SYS_YELLOW_PIN, 1, 100);
     timer_set(&poll_timer, 10000); /* set the timer for 10 seconds */
   }
+  if(timer_timedout(&telemetry_timer)) {
+    timer_reset(&telemetry_timer);      /* keep the sample period free of drift */
+    telemetry_sample();
+  }
+  fan_blower_poll(&fan);                /* speed loop on the techo RPM */
+  acquisition_record_poll();
+  telemetry_poll(&telemetry);
 }
 /*---------------------------------------------------------------------------*/
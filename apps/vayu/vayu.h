@@ -5,6 +5,9 @@
 #define NTC_HRV   1
 #define NTC_TOTAL 2
 
+#define HA_INPUT_HEATER 0   /* heat accumulator estimator inputs */
+#define HA_INPUT_FAN    1
+
 typedef enum hrv_mode {
   HRV_MODE_OFF = 0,
   HRV_MODE_INLET = 1,
@@ -36,63 +36,35 @@
 
  #include "adc-arch.h"
  #include "adc-dev.h"
+ #include "adc-cal-arch.h"
  #include <em_cmu.h>
  #include <em_gpio.h>
  #include "board.h"
+ #include "dma-arch.h"
+ #include "clock.h"
+ #include "swo_debug.h"
+
+ #define LOG_MODULE LOG_MODULE_ADC_ARCH
+ #include "log.h"
+
+ #pragma GCC diagnostic ignored "-Wattributes" /* for GCC V12 it gives warning of FP regsiters might be clobbered */
+ void ADC0_IRQHandler(void) __attribute__((interrupt));
+
+ typedef struct adc_arch_read {
+   adc_dev_t *dev;                  /* device of the running single read */
+   adc_arch_callback_t callback;    /* called from the interrupt when the average is ready */
+   void *ctx;                       /* context passed to the callback */
+   uint16_t samples;                /* conversions to take, 1 with hardware oversampling */
+   uint16_t count;                  /* conversions taken */
+   uint32_t sum;                    /* sum of the conversions */
+   uint8_t ovs_shift;               /* log2 of the oversampling ratio, 0 for software averaging */
+   clock_time_t start_us;           /* start time for the latency counters */
+ } adc_arch_read_t;
 
- #define ADC_DEBUG 0
- #if ADC_DEBUG
- #include <stdio.h>
- #undef PRINTF
- #define PRINTF(...) printf(__VA_ARGS__)
- #else  /* ADC_DEBUG */
- /**< Replace printf with nothing */
- #define PRINTF(...)
- #endif /* ADC_DEBUG */
  static bool adc_initialized = false;
- /*---------------------------------------------------------------------------*/
- /* calibration must be called after ADC and clk init */
- static void
- calibrate_ADC(ADC_TypeDef *adc_peripheral)
- {
-   uint8_t mid;
-   uint32_t cal, sample;
-   ADC_InitSingle_TypeDef singleInit = ADC_INITSINGLE_DEFAULT;
- 
-   /* Initialize single measurement of GND signal */
-   singleInit.reference = adcRef2V5;
-   singleInit.posSel    = adcPosSelVSS;
-   singleInit.negSel    = adcNegSelVSS;
-   singleInit.acqTime   = adcAcqTime16;
-   singleInit.fifoOverwrite = true;
- 
-   ADC_InitSingle(adc_peripheral, &singleInit);
- 
-   /* Single ended offset calibration, scan from lower ADC results */
-   mid = 15;
-   adc_peripheral->CAL |= ADC_CAL_CALEN;
-   adc_peripheral->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
- 
-   for(mid = 15; mid >= 0; mid--) {
-     /* Write to calibration register */
-     cal = adc_peripheral->CAL & ~(_ADC_CAL_SINGLEOFFSET_MASK);
-     cal |= (uint8_t)(mid) << _ADC_CAL_SINGLEOFFSET_SHIFT;
-     adc_peripheral->CAL = cal;
- 
-     /* Start ADC single conversion */
-     ADC_Start(adc_peripheral, adcStartSingle);
-     /* wait for result*/
-     while(!(adc_peripheral->IF & ADC_IF_SINGLE));
- 
-     sample = ADC_DataSingleGet(adc_peripheral);
-     /* break when we read 0 or we're at max offset */
-     if(!(sample)) {
-       break;
-     }
-   }
-   /* exit calibration mode */
-   adc_peripheral->CAL &= ~(ADC_CAL_CALEN);
- }
+ static adc_arch_read_t adc_read;
+ static volatile bool adc_busy = false;    /* a single read or a scan owns the ADC */
+ static adc_sleep_stats_t adc_sleep_stats;
  /*---------------------------------------------------------------------------*/
  void 
  adc_arch_init(ADC_TypeDef *adc_peripheral)
@@ -109,7 +81,7 @@
     }
   #endif  /* ADC1 */
     else {
-      PRINTF("ADC peripheral not supported\n");
+      LOG_ERR("ADC peripheral not supported\n");
       return;
     }
     /* Select AUXHFRCO for ADC ASYNC mode so that ADC can run on EM2 */
@@ -123,26 +95,68 @@
     /* ADC clock is enabled only during ADC conversion */
     ADCInit.em2ClockConfig = adcEm2ClockOnDemand;
     ADC_Init(adc_peripheral, &ADCInit);
-    /* calibrate ADC offset values for 2.5V internal reference*/
-    calibrate_ADC(adc_peripheral);
+    /* load the offset and gain of the board references from flash, calibrate if there are none */
+    adc_cal_arch_init(adc_peripheral);
     adc_initialized = true;
   }
  }
  /*---------------------------------------------------------------------------*/
- uint32_t
- adc_arch_read_single(adc_dev_t *dev)
+ /* returns log2 of samples if the hardware oversampling can average them, 0 otherwise */
+ static uint8_t
+ adc_arch_ovs_shift(uint16_t samples)
+ {
+   uint8_t shift;
+   for(shift = 1; shift <= ADC_OVS_MAX_SHIFT; shift++) {
+     if(samples == (1U << shift)) {
+       return shift;
+     }
+   }
+   return 0;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* an oversampled result has 12 + shift bits up to 8x and 16 bits from 16x on, return it
+    scaled by ADC_OVS_SCALE like the software average */
+ static uint32_t
+ adc_arch_ovs_scaled(uint32_t value, uint8_t shift)
+ {
+   if(shift < ADC_OVS_SCALE_BITS) {
+     return value << (ADC_OVS_SCALE_BITS - shift);
+   }
+   return value;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* the oversampling ratio is shared by single and scan conversions, set it before each start */
+ static void
+ adc_arch_set_ovs(ADC_TypeDef *adc_peripheral, uint8_t shift)
+ {
+   adc_peripheral->CTRL = (adc_peripheral->CTRL & ~_ADC_CTRL_OVSRSEL_MASK)
+                          | (((uint32_t)(shift - 1) << _ADC_CTRL_OVSRSEL_SHIFT) & _ADC_CTRL_OVSRSEL_MASK);
+ }
+ /*---------------------------------------------------------------------------*/
+ /* starts an interrupt driven single read, the ADC interrupt handler below takes it from here */
+ adc_status_t
+ adc_arch_start_single(adc_dev_t *dev, adc_arch_callback_t callback, void *ctx)
  {
-   uint16_t i, samples;
-   uint32_t sum_adc_reading = 0;
+   ADC_TypeDef *adc;
+   uint16_t samples;
+   uint8_t ovs_shift = 0;
    ADC_InitSingle_TypeDef adc_init_single = ADC_INITSINGLE_DEFAULT;
-   
-   if(dev == NULL || dev->adc_config->adc_peripheral == NULL) {
-    PRINTF("ADC arch: ADC device NULL\n");
-    return 0;
+
+   if(dev == NULL || dev->adc_config == NULL || dev->adc_config->adc_peripheral == NULL) {
+    LOG_ERR("ADC arch: ADC device NULL\n");
+    return ADC_INVALID;
+   }
+   adc = dev->adc_config->adc_peripheral;
+   if(adc != ADC0) {
+    LOG_ERR("ADC arch: interrupt driven reads support ADC0 only\n");
+    return ADC_INVALID;
+   }
+   if(adc_busy) {
+    return ADC_BUSY;
    }
    if(adc_initialized == false) {
-    PRINTF("ADC arch: ADC must be initialized before use. Initializing...\n ");
-    adc_arch_init(dev->adc_config->adc_peripheral);
+    LOG_WARN("ADC arch: ADC must be initialized before use. Initializing...\n ");
+    adc_arch_init(adc);
    }
    /* verify inputs */
    if(!dev->adc_avg_samples) {
@@ -150,6 +164,10 @@
    } else {
      samples = dev->adc_avg_samples;
    }
+   /* power of 2 ratios are averaged by the ADC, the others sample by sample in the interrupt */
+   if(!dev->adc_sw_average) {
+     ovs_shift = adc_arch_ovs_shift(samples);
+   }
    /* setup ADC in single measurement mode */
    adc_init_single.reference = dev->adc_config->adc_ref_mv;
    adc_init_single.posSel = dev->adc_config->pos_input; 
@@ -164,31 +182,161 @@
     * @ 1MHz ADC clock
     * T(conv) = 16 us + 13 * 1us * 1 = 29 us
     * Total ADC time = ADCREF_WARMUPTIME + T(conv) = 29us + 5us = 34 us / sample
+    * With oversampling the warm up is paid once per OVSRSEL samples.
     */
    adc_init_single.acqTime = adcAcqTime16; 
-   ADC_InitSingle(dev->adc_config->adc_peripheral, &adc_init_single);
- 
-   /* take ADC samples */
-   for(i = 0; i < samples; i++) {
-     ADC_Start(dev->adc_config->adc_peripheral, adcStartSingle);
-     while(!(dev->adc_config->adc_peripheral->IF & ADC_IF_SINGLE));
-     sum_adc_reading += ADC_DataSingleGet(dev->adc_config->adc_peripheral) & 0x0000FFFF;
+   if(ovs_shift) {
+     adc_init_single.resolution = adcResOVS;
+     adc_arch_set_ovs(adc, ovs_shift);
    }
-   /* find sample average */
-   sum_adc_reading /= samples;
-   PRINTF("ADC arch: reading:%lu\n", sum_adc_reading);
-   return sum_adc_reading;
+   ADC_InitSingle(adc, &adc_init_single);
+   adc_cal_arch_apply(adc, adc_init_single.reference, false);
+
+   adc_read.dev = dev;
+   adc_read.callback = callback;
+   adc_read.ctx = ctx;
+   adc_read.samples = ovs_shift ? 1 : samples;
+   adc_read.count = 0;
+   adc_read.sum = 0;
+   adc_read.ovs_shift = ovs_shift;
+   adc_read.start_us = clock_get_time_us();
+   adc_busy = true;
+   adc->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+   ADC_IntClear(adc, ADC_IF_SINGLE);
+   ADC_IntEnable(adc, ADC_IEN_SINGLE);
+   NVIC_ClearPendingIRQ(ADC0_IRQn);
+   NVIC_EnableIRQ(ADC0_IRQn);
+   ADC_Start(adc, adcStartSingle);
+   return ADC_OK;
  }
  /*---------------------------------------------------------------------------*/
- uint32_t
- adc_arch_read_microvolts(adc_dev_t *dev)
+ void
+ ADC0_IRQHandler(void)
+ {
+   ADC_TypeDef *adc = ADC0;
+   adc_dev_t *dev = adc_read.dev;
+   uint32_t value, latency_us;
+
+   SWO_ISR_ENTER();
+   if((ADC_IntGetEnabled(adc) & ADC_IF_SINGLE) && dev != NULL) {
+     value = ADC_DataSingleGet(adc) & 0x0000FFFF;
+     ADC_IntClear(adc, ADC_IF_SINGLE);
+     if(adc_read.ovs_shift) {
+       /* the ADC averaged the samples, below 16x with fewer than 4 extra bits */
+       adc_read.sum = adc_arch_ovs_scaled(value, adc_read.ovs_shift);
+     } else {
+       adc_read.sum += value;
+       if(++adc_read.count < adc_read.samples) {
+         /* the core sleeps again until the next sample */
+         ADC_Start(adc, adcStartSingle);
+         SWO_ISR_EXIT();
+         return;
+       }
+       /* find sample average */
+       adc_read.sum = (uint32_t)(((uint64_t)adc_read.sum * ADC_OVS_SCALE) / adc_read.samples);
+     }
+     ADC_IntDisable(adc, ADC_IEN_SINGLE);
+     latency_us = (uint32_t)(clock_get_time_us() - adc_read.start_us);
+     dev->stats.reads++;
+     dev->stats.last_latency_us = latency_us;
+     dev->stats.total_latency_us += latency_us;
+     if(latency_us > dev->stats.max_latency_us) {
+       dev->stats.max_latency_us = latency_us;
+     }
+     adc_read.dev = NULL;
+     adc_busy = false;
+     if(adc_read.callback) {
+       adc_read.callback(dev, adc_read.sum, adc_read.ctx);
+     }
+   }
+   SWO_ISR_EXIT();
+ }
+ /*---------------------------------------------------------------------------*/
+ bool
+ adc_arch_busy(void)
+ {
+   return adc_busy;
+ }
+ /*---------------------------------------------------------------------------*/
+ void
+ adc_arch_sleep_while(volatile bool *busy)
+ {
+   clock_time_t start_us, sleep_us;
+
+   start_us = clock_get_time_us();
+   /* EM1 keeps the tick, the DMA and the serial ports running */
+   SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+   while(1) {
+     /* a pending interrupt wakes the core also with interrupts disabled, so the flag can not
+      * be cleared between the check and the sleep without waking it up again */
+     __disable_irq();
+     if(!*busy) {
+       __enable_irq();
+       break;
+     }
+     sleep_us = clock_get_time_us();
+     __WFI();
+     adc_sleep_stats.em1_us += clock_get_time_us() - sleep_us;
+     adc_sleep_stats.sleeps++;
+     __enable_irq();
+   }
+   adc_sleep_stats.wait_us += clock_get_time_us() - start_us;
+ }
+ /*---------------------------------------------------------------------------*/
+ const adc_sleep_stats_t *
+ adc_arch_get_sleep_stats(void)
+ {
+   return &adc_sleep_stats;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* blocking read completion, stores the result in the variable passed as context */
+ static void
+ adc_arch_read_done(adc_dev_t *dev, uint32_t adc_value, void *ctx)
+ {
+   (void)dev;
+   *(uint32_t *)ctx = adc_value;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* reads the average of the samples scaled by ADC_OVS_SCALE, i.e. with 4 extra bits of resolution */
+ static adc_status_t
+ adc_arch_read_scaled(adc_dev_t *dev, uint32_t *adc_reading)
+ {
+   volatile uint32_t sum_adc_reading = 0;
+   adc_status_t status;
+
+   /* let a running asynchronous read finish first */
+   adc_arch_sleep_while(&adc_busy);
+   status = adc_arch_start_single(dev, adc_arch_read_done, (void *)&sum_adc_reading);
+   if(status != ADC_OK) {
+     return status;
+   }
+   /* the core sleeps between the samples */
+   adc_arch_sleep_while(&adc_busy);
+   LOG_DBG("ADC arch: reading x%u:%lu\n", ADC_OVS_SCALE, sum_adc_reading);
+   *adc_reading = sum_adc_reading;
+   return ADC_OK;
+ }
+ /*---------------------------------------------------------------------------*/
+ adc_status_t
+ adc_arch_read_single(adc_dev_t *dev, uint32_t *adc_value)
  {
    uint32_t adc_reading;
+   adc_status_t status;
+
+   status = adc_arch_read_scaled(dev, &adc_reading);
+   if(status == ADC_OK) {
+     *adc_value = adc_reading / ADC_OVS_SCALE;
+   }
+   return status;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* microvolts of a reading scaled by ADC_OVS_SCALE */
+ static uint32_t
+ adc_arch_microvolts_from_scaled(adc_dev_t *dev, uint32_t adc_reading)
+ {
    uint32_t adc_ref_mv = 2500;
    uint64_t uv = 0;
    /* select right ref value based on selected Reference voltage */
-   adc_reading = adc_arch_read_single(dev);
-   /* convert the reading into millivolt for selected internal reference voltage */
    if(dev->adc_config->adc_ref_mv == adcRef1V25) {
      adc_ref_mv = 1250;
    } else if(dev->adc_config->adc_ref_mv == adcRef2V5) {
@@ -202,17 +350,171 @@
    }
 #endif  /* BOARD_ADC_REF_mVDD */
     else {
-      PRINTF("ADC reference voltage not supported\n");
+      LOG_ERR("ADC reference voltage not supported\n");
       return 0;
     }
+   /* convert the reading into millivolt for selected internal reference voltage */
    uv = adc_reading;
    uv *= adc_ref_mv;
    uv *= 1000;
-   uv /= ADC_RESOLUTION;
-   PRINTF("ADC arch: microvolt:%lu ADC ref:%lu\n", (uint32_t)uv, adc_ref_mv);
+   uv /= (ADC_RESOLUTION * ADC_OVS_SCALE);
+   LOG_DBG("ADC arch: microvolt:%lu ADC ref:%lu\n", (uint32_t)uv, adc_ref_mv);
    return (uint32_t)uv;
  }
  /*---------------------------------------------------------------------------*/
+ uint32_t
+ adc_arch_microvolts_from_raw(adc_dev_t *dev, uint32_t adc_reading)
+ {
+   return adc_arch_microvolts_from_scaled(dev, adc_reading * ADC_OVS_SCALE);
+ }
+ /*---------------------------------------------------------------------------*/
+ adc_status_t
+ adc_arch_read_microvolts(adc_dev_t *dev, uint32_t *microvolts)
+ {
+   uint32_t adc_reading;
+   adc_status_t status;
+
+   status = adc_arch_read_scaled(dev, &adc_reading);
+   if(status == ADC_OK) {
+     /* keep the extra resolution of the average */
+     *microvolts = adc_arch_microvolts_from_scaled(dev, adc_reading);
+   }
+   return status;
+ }
+ /*---------------------------------------------------------------------------*/
+ /* LDMA done interrupt of a scan. The ADC is stopped and the scans are averaged per channel */
+ static void
+ adc_arch_scan_done(uint8_t channel, void *ctx)
+ {
+   adc_scan_group_t *group = (adc_scan_group_t *)ctx;
+   ADC_TypeDef *adc = group->devs[0]->adc_config->adc_peripheral;
+   uint32_t sum[ADC_SCAN_MAX_CHANNELS] = {0};
+   uint16_t s;
+   uint8_t i;
+
+   (void)channel;
+   adc->CMD = ADC_CMD_SCANSTOP;
+   adc->SCANFIFOCLEAR = ADC_SCANFIFOCLEAR_SCANFIFOCLEAR;
+   if(group->arch.ovs_shift) {
+     /* one result set, already averaged by the ADC */
+     for(i = 0; i < group->dev_count; i++) {
+       group->result[i] = adc_arch_ovs_scaled(group->buff[group->arch.result_pos[i]] & 0x0000FFFF,
+                                              group->arch.ovs_shift) / ADC_OVS_SCALE;
+     }
+   } else {
+     /* the buffer holds scan_samples result sets, each in scan id order */
+     for(s = 0; s < group->scan_samples; s++) {
+       for(i = 0; i < group->dev_count; i++) {
+         sum[i] += group->buff[(s * group->dev_count) + i] & 0x0000FFFF;
+       }
+     }
+     for(i = 0; i < group->dev_count; i++) {
+       group->result[i] = sum[group->arch.result_pos[i]] / group->scan_samples;
+     }
+   }
+   group->busy = false;
+   adc_busy = false;
+   if(group->callback) {
+     group->callback(group, group->ctx);
+   }
+ }
+ /*---------------------------------------------------------------------------*/
+ adc_status_t
+ adc_arch_scan_init(adc_scan_group_t *group)
+ {
+   ADC_InitScan_TypeDef scan_init = ADC_INITSCAN_DEFAULT;
+   const adc_config_t *first = group->devs[0]->adc_config;
+   const adc_config_t *cfg;
+   uint8_t block[4] = { 0xFF, 0xFF, 0xFF, 0xFF };   /* APORT block of 8 inputs mapped to each input group */
+   uint8_t scan_id[ADC_SCAN_MAX_CHANNELS];
+   uint8_t i, j, g;
+
+   if(first->adc_peripheral != ADC0) {
+     LOG_ERR("ADC arch: scan supports ADC0 only\n");
+     return ADC_INVALID;
+   }
+   ADC_ScanInputClear(&scan_init);
+   for(i = 0; i < group->dev_count; i++) {
+     cfg = group->devs[i]->adc_config;
+     /* one scan has one reference and single ended inputs only */
+     if(cfg->adc_peripheral != first->adc_peripheral || cfg->adc_ref_mv != first->adc_ref_mv
+        || cfg->neg_input != adcNegSelVSS) {
+       LOG_ERR("ADC arch: channel %u can not join the scan\n", i);
+       return ADC_INVALID;
+     }
+     /* each of the 4 input groups maps 8 consecutive APORT inputs */
+     for(g = 0; g < 4; g++) {
+       if(block[g] == (cfg->pos_input >> 3) || block[g] == 0xFF) {
+         break;
+       }
+     }
+     if(g == 4) {
+       LOG_ERR("ADC arch: no free scan input group for channel %u\n", i);
+       return ADC_INVALID;
+     }
+     block[g] = cfg->pos_input >> 3;
+     scan_id[i] = ADC_ScanSingleEndedInputAdd(&scan_init, (ADC_ScanInputGroup_TypeDef)g, cfg->pos_input);
+     for(j = 0; j < i; j++) {
+       if(scan_id[j] == scan_id[i]) {
+         LOG_ERR("ADC arch: channel %u is in the scan twice\n", i);
+         return ADC_INVALID;
+       }
+     }
+   }
+   /* the results come in ascending scan id order */
+   for(i = 0; i < group->dev_count; i++) {
+     group->arch.result_pos[i] = 0;
+     for(j = 0; j < group->dev_count; j++) {
+       if(scan_id[j] < scan_id[i]) {
+         group->arch.result_pos[i]++;
+       }
+     }
+   }
+   scan_init.reference = first->adc_ref_mv;
+   scan_init.acqTime = adcAcqTime16;        /* same acquisition time as the single reads */
+   /* power of 2 sample counts are averaged by the ADC in one scan, the others are repeated scans */
+   group->arch.ovs_shift = adc_arch_ovs_shift(group->scan_samples);
+   if(group->arch.ovs_shift) {
+     scan_init.resolution = adcResOVS;
+   }
+   scan_init.rep = (group->arch.ovs_shift == 0);  /* scan again until the DMA has all the samples */
+   scan_init.scanDmaEm2Wu = true;
+   scan_init.fifoOverwrite = false;
+   group->arch.scan_init = scan_init;
+   return ADC_OK;
+ }
+ /*---------------------------------------------------------------------------*/
+ adc_status_t
+ adc_arch_scan_start(adc_scan_group_t *group)
+ {
+   ADC_TypeDef *adc = group->devs[0]->adc_config->adc_peripheral;
+
+   if(adc_initialized == false) {
+     adc_arch_init(adc);
+   }
+   /* single reads and scans share the ADC, ADC_InitScan would break a running single read */
+   if(adc_busy) {
+     return ADC_BUSY;
+   }
+   adc_busy = true;
+   group->busy = true;
+   if(group->arch.ovs_shift) {
+     adc_arch_set_ovs(adc, group->arch.ovs_shift);
+   }
+   ADC_InitScan(adc, &group->arch.scan_init);
+   adc_cal_arch_apply(adc, group->arch.scan_init.reference, true);
+   adc->SCANFIFOCLEAR = ADC_SCANFIFOCLEAR_SCANFIFOCLEAR;
+   if(!dma_arch_start_p2m_word(DMA_ARCH_CHANNEL_ADC_SCAN, ldmaPeripheralSignal_ADC0_SCAN, &adc->SCANDATA,
+                               group->buff, group->arch.ovs_shift ? group->dev_count : group->scan_samples * group->dev_count,
+                               adc_arch_scan_done, group)) {
+     group->busy = false;
+     adc_busy = false;
+     return ADC_INVALID;
+   }
+   ADC_Start(adc, adcStartScan);
+   return ADC_OK;
+ }
+ /*---------------------------------------------------------------------------*/
  void 
  adc_arch_dev_enable(gpio_config_t *cs, uint8_t on_off)
  {
@@ -220,20 +522,19 @@
     if(on_off == ADC_DEV_ENABLE) {
       if(cs->logic == ENABLE_ACTIVE_LOW) {
         GPIO_PinModeSet(cs->port, cs->pin, gpioModeWiredAnd, 0);
-        PRINTF("ADC arch: GPIO pin set low\n");
+        LOG_DBG("ADC arch: GPIO pin set low\n");
       } else {
         GPIO_PinModeSet(cs->port, cs->pin, gpioModePushPull, 1);
       }
     } else {
        GPIO_PinModeSet(cs->port, cs->pin, gpioModeDisabled, 0);
-       PRINTF("ADC arch: GPIO pin disabled\n");
+       LOG_DBG("ADC arch: GPIO pin disabled\n");
     }
   }
  }
  /*---------------------------------------------------------------------------*/
 /**
  * @todo - Implement ADC read method for differential mode input signals.
- *       - Implement interrupt based ADC conversion.
  *       - Implement ADC peripheral lock/unlock mechanism
  * 
  */
\ No newline at end of file
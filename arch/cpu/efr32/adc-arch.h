@@ -10,6 +10,10 @@
 #define ADC_RESOLUTION                (0x00001 << ADC_RESOLTION_BITS)   /* ADC resolution */
 #define ADC_DEV_ENABLE                1                                 /* enable the ADC device */
 #define ADC_DEV_DISABLE               0                                 /* disable the ADC device */
+#define ADC_SCAN_MAX_CHANNELS         8                                 /* channels in one scan group */
+#define ADC_OVS_MAX_SHIFT             12                                /* hardware oversampling up to 4096x */
+#define ADC_OVS_SCALE_BITS            4                                 /* averages carry 4 extra bits, 12 bit code x 16 */
+#define ADC_OVS_SCALE                 (0x00001 << ADC_OVS_SCALE_BITS)  /* OVS 2x-8x gives 13-15 bit results, 16x and up 16 bit */
 
 typedef struct adc_config {
   const ADC_PosSel_TypeDef pos_input;
@@ -18,4 +22,10 @@ typedef struct adc_config {
   ADC_TypeDef *adc_peripheral;
 } adc_config_t;
 
+typedef struct adc_scan_config {
+  ADC_InitScan_TypeDef scan_init;               /* scan inputs, built once by adc_arch_scan_init */
+  uint8_t result_pos[ADC_SCAN_MAX_CHANNELS];    /* position of each channel in one scan result set */
+  uint8_t ovs_shift;                            /* log2 of the hardware oversampling ratio, 0 for repeated scans */
+} adc_scan_config_t;
+
 #endif  /* _ADC_ARCH_H_ */
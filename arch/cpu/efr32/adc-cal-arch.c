@@ -0,0 +1,416 @@
+/**
+ * @file  adc-cal-arch.c
+ * @author Varun Marolia
+ * @brief This file implements the ADC calibration manager. The offset and gain of
+ *        every reference the board uses are found with a binary search, kept in the
+ *        last flash page and reloaded at boot. The ADC is calibrated again only when
+ *        the die temperature or the supply drifted.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "adc-cal-arch.h"
+#include "adc-dev.h"
+#include "flash.h"
+#include "crc16.h"
+#include <stddef.h>
+#include <string.h>
+
+#define LOG_MODULE LOG_MODULE_ADC_ARCH
+#include "log.h"
+
+#define ADC_CAL_OFFSET_MIN        (-8)      /* SINGLEOFFSET is a 4 bit two's complement value */
+#define ADC_CAL_OFFSET_STEPS      16
+#define ADC_CAL_GAIN_STEPS        128       /* SINGLEGAIN is 7 bit */
+#define ADC_CAL_FULL_SCALE        ((uint32_t)ADC_RESOLUTION << ADC_CAL_SAMPLES_SHIFT)
+
+static const adc_cal_ref_config_t adc_cal_refs[] = BOARD_ADC_CAL_REFS;
+#define ADC_CAL_REF_COUNT         (sizeof(adc_cal_refs) / sizeof(adc_cal_refs[0]))
+
+static const crc16_cfg_t adc_cal_crc_cfg = {
+  .polynomial = CRC16_CCITT_POLYNOMIAL,
+  .intial_remainder = CRC16_CCITT_INITIAL_REMAINDER,
+  .final_xor_value = CRC16_CCITT_FINAL_XOR_VALUE
+};
+static adc_cal_record_t adc_cal;
+static bool adc_cal_valid = false;
+static bool adc_cal_store_pending = false;    /* calibrated without a supply reading, not in flash yet */
+/*---------------------------------------------------------------------------*/
+static uint32_t
+adc_cal_ref_mv(ADC_Ref_TypeDef reference)
+{
+  switch(reference) {
+    case adcRef1V25:
+      return 1250;
+    case adcRef2V5:
+      return 2500;
+    case adcRef5V:
+      return 5000;
+#ifdef BOARD_ADC_REF_mVDD
+    case adcRefVDD:
+      return BOARD_ADC_REF_mVDD;
+#endif  /* BOARD_ADC_REF_mVDD */
+    default:
+      return 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* single conversion setup with 16x oversampling. ADC_InitSingle loads the factory calibration */
+static void
+adc_cal_setup(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, ADC_PosSel_TypeDef input)
+{
+  ADC_InitSingle_TypeDef single_init = ADC_INITSINGLE_DEFAULT;
+
+  single_init.reference = reference;
+  single_init.posSel = input;
+  single_init.negSel = adcNegSelVSS;
+  single_init.acqTime = adcAcqTime16;
+  single_init.resolution = adcResOVS;
+  single_init.fifoOverwrite = true;
+  adc->CTRL = (adc->CTRL & ~_ADC_CTRL_OVSRSEL_MASK)
+              | (((uint32_t)(ADC_CAL_SAMPLES_SHIFT - 1) << _ADC_CTRL_OVSRSEL_SHIFT) & _ADC_CTRL_OVSRSEL_MASK);
+  ADC_InitSingle(adc, &single_init);
+}
+/*---------------------------------------------------------------------------*/
+static void
+adc_cal_set(ADC_TypeDef *adc, int8_t offset, uint8_t gain)
+{
+  uint32_t cal = adc->CAL & ~(_ADC_CAL_SINGLEOFFSET_MASK | _ADC_CAL_SINGLEGAIN_MASK);
+  cal |= ((uint32_t)(offset & 0x0F) << _ADC_CAL_SINGLEOFFSET_SHIFT) & _ADC_CAL_SINGLEOFFSET_MASK;
+  cal |= ((uint32_t)gain << _ADC_CAL_SINGLEGAIN_SHIFT) & _ADC_CAL_SINGLEGAIN_MASK;
+  adc->CAL = cal;
+}
+/*---------------------------------------------------------------------------*/
+/* one conversion with the current setup, 16 bit result */
+static uint32_t
+adc_cal_sample(ADC_TypeDef *adc)
+{
+  uint32_t sample;
+  adc->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+  ADC_Start(adc, adcStartSingle);
+  while(!(adc->IF & ADC_IF_SINGLE));
+  sample = ADC_DataSingleGet(adc) & 0x0000FFFF;
+  ADC_IntClear(adc, ADC_IF_SINGLE);
+  return sample;
+}
+/*---------------------------------------------------------------------------*/
+/* VSS reads as 0 or, in calibration mode, as a negative value once the offset is low enough */
+static bool
+adc_cal_offset_low(ADC_TypeDef *adc, int8_t offset, uint8_t gain)
+{
+  uint32_t sample;
+  adc_cal_set(adc, offset, gain);
+  sample = adc_cal_sample(adc);
+  return (sample == 0) || (sample & 0x8000);
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Offset calibration: VSS is converted and the last setting that still reads 0 before the
+ * result turns positive is searched. The direction of the register is taken from the two
+ * ends, then the boundary is found in 4 conversions instead of up to 16.
+ */
+static bool
+adc_cal_find_offset(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, uint8_t gain, int8_t *offset)
+{
+  bool low_first, low_last;
+  uint8_t lo, hi, mid;
+  int8_t start, step;
+
+  adc_cal_setup(adc, reference, adcPosSelVSS);
+  adc->CAL |= ADC_CAL_CALEN;
+  low_first = adc_cal_offset_low(adc, ADC_CAL_OFFSET_MIN, gain);
+  low_last = adc_cal_offset_low(adc, ADC_CAL_OFFSET_MIN + ADC_CAL_OFFSET_STEPS - 1, gain);
+  if(low_first == low_last) {
+    adc->CAL &= ~(ADC_CAL_CALEN);
+    return false;
+  }
+  /* walk from the end that reads low towards the other one: lo reads low, hi does not */
+  start = low_first ? ADC_CAL_OFFSET_MIN : (ADC_CAL_OFFSET_MIN + ADC_CAL_OFFSET_STEPS - 1);
+  step = low_first ? 1 : -1;
+  lo = 0;
+  hi = ADC_CAL_OFFSET_STEPS - 1;
+  while((hi - lo) > 1) {
+    mid = (lo + hi) / 2;
+    if(adc_cal_offset_low(adc, start + (step * mid), gain)) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  *offset = start + (step * lo);
+  /* exit calibration mode */
+  adc->CAL &= ~(ADC_CAL_CALEN);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/*
+ * Gain calibration: the gain input is converted with the factory calibrated 2.5V reference,
+ * which gives the code the same input must read with the reference under test. The gain
+ * register is then searched for the reading closest to it in 7 conversions.
+ */
+static bool
+adc_cal_find_gain(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, ADC_PosSel_TypeDef input, int8_t offset, uint8_t *gain)
+{
+  uint32_t expected, first, last, sample, lo_sample, hi_sample;
+  uint8_t lo, hi, mid;
+  bool rising;
+
+  if(adc_cal_ref_mv(reference) == 0) {
+    return false;
+  }
+  adc_cal_setup(adc, adcRef2V5, input);
+  adc_cal_arch_apply(adc, adcRef2V5, false);
+  expected = (uint32_t)(((uint64_t)adc_cal_sample(adc) * 2500) / adc_cal_ref_mv(reference));
+  /* a reading close to the ends of the range does not show the gain */
+  if(expected < (ADC_CAL_FULL_SCALE / 8) || expected > (ADC_CAL_FULL_SCALE - (ADC_CAL_FULL_SCALE / 16))) {
+    LOG_WARN("ADC cal: gain input out of range for reference %u\n", reference);
+    return false;
+  }
+  adc_cal_setup(adc, reference, input);
+  adc_cal_set(adc, offset, 0);
+  first = adc_cal_sample(adc);
+  adc_cal_set(adc, offset, ADC_CAL_GAIN_STEPS - 1);
+  last = adc_cal_sample(adc);
+  rising = last > first;
+  lo_sample = rising ? first : last;
+  hi_sample = rising ? last : first;
+  if(expected < lo_sample || expected > hi_sample) {
+    LOG_WARN("ADC cal: gain out of range for reference %u\n", reference);
+    return false;
+  }
+  /* index i maps to gain i when rising, to 127 - i otherwise. lo reads below expected, hi above */
+  lo = 0;
+  hi = ADC_CAL_GAIN_STEPS - 1;
+  while((hi - lo) > 1) {
+    mid = (lo + hi) / 2;
+    adc_cal_set(adc, offset, rising ? mid : (ADC_CAL_GAIN_STEPS - 1 - mid));
+    sample = adc_cal_sample(adc);
+    if(sample < expected) {
+      lo = mid;
+      lo_sample = sample;
+    } else {
+      hi = mid;
+      hi_sample = sample;
+    }
+  }
+  mid = ((expected - lo_sample) <= (hi_sample - expected)) ? lo : hi;
+  *gain = rising ? mid : (ADC_CAL_GAIN_STEPS - 1 - mid);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+adc_cal_store(void)
+{
+  const uint32_t *word = (const uint32_t *)&adc_cal;
+  flash_status_t status;
+  uint8_t i;
+
+  adc_cal.crc = crc16_calc_buff(&adc_cal_crc_cfg, (const uint8_t *)&adc_cal, offsetof(adc_cal_record_t, crc));
+  flash_unlock();
+  status = flash_erase_sector(ADC_CAL_FLASH_ADDRESS);
+  for(i = 0; status == FLASH_STATUS_OK && i < (sizeof(adc_cal) / sizeof(uint32_t)); i++) {
+    status = flash_write_word(ADC_CAL_FLASH_ADDRESS + (i * sizeof(uint32_t)), word[i]);
+  }
+  flash_lock();
+  if(status != FLASH_STATUS_OK) {
+    LOG_ERR("ADC cal: flash write failed:%d\n", status);
+    return false;
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/* a stored record is used only if it was made for the same list of references */
+static bool
+adc_cal_load(void)
+{
+  adc_cal_record_t record;
+  uint8_t i;
+
+  if(flash_read(ADC_CAL_FLASH_ADDRESS, &record, sizeof(record)) != FLASH_STATUS_OK
+     || record.magic != ADC_CAL_MAGIC || record.version != ADC_CAL_VERSION || record.count != ADC_CAL_REF_COUNT
+     || record.crc != crc16_calc_buff(&adc_cal_crc_cfg, (const uint8_t *)&record, offsetof(adc_cal_record_t, crc))) {
+    return false;
+  }
+  for(i = 0; i < ADC_CAL_REF_COUNT; i++) {
+    if(record.entry[i].reference != adc_cal_refs[i].reference
+       || record.entry[i].gain_calibrated != (adc_cal_refs[i].gain_input != adcPosSelVSS)) {
+      return false;
+    }
+  }
+  adc_cal = record;
+  adc_cal_valid = true;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+adc_cal_arch_read_temp_mC(ADC_TypeDef *adc)
+{
+  ADC_InitSingle_TypeDef single_init = ADC_INITSINGLE_DEFAULT;
+  int32_t cal_temp_C, cal_value, sample;
+
+  /* the sensor is calibrated at production with the factory calibrated 1.25V reference */
+  single_init.reference = adcRef1V25;
+  single_init.posSel = adcPosSelTEMP;
+  single_init.negSel = adcNegSelVSS;
+  single_init.acqTime = adcAcqTime16;
+  single_init.fifoOverwrite = true;
+  ADC_InitSingle(adc, &single_init);
+  adc->SINGLEFIFOCLEAR = ADC_SINGLEFIFOCLEAR_SINGLEFIFOCLEAR;
+  ADC_Start(adc, adcStartSingle);
+  while(!(adc->IF & ADC_IF_SINGLE));
+  sample = (int32_t)(ADC_DataSingleGet(adc) & 0x00000FFF);
+  ADC_IntClear(adc, ADC_IF_SINGLE);
+  cal_temp_C = (int32_t)((DEVINFO->CAL & _DEVINFO_CAL_TEMP_MASK) >> _DEVINFO_CAL_TEMP_SHIFT);
+  cal_value = (int32_t)((DEVINFO->ADC0CAL3 & _DEVINFO_ADC0CAL3_TEMPREAD1V25_MASK) >> _DEVINFO_ADC0CAL3_TEMPREAD1V25_SHIFT);
+  /* -1.84 mV/'C slope: T = T(cal) + (code(cal) - code) x 1250 mV / (4096 x 1.84 mV/'C) */
+  return (cal_temp_C * 1000) + (int32_t)(((int64_t)(cal_value - sample) * 125000000) / (4096 * 184));
+}
+/*---------------------------------------------------------------------------*/
+static bool
+adc_cal_run(ADC_TypeDef *adc, uint32_t supply_mV)
+{
+  ADC_Ref_TypeDef reference;
+  adc_cal_entry_t *entry;
+  int8_t offset;
+  uint8_t gain;
+  uint8_t i;
+
+  memset(&adc_cal, 0, sizeof(adc_cal));
+  adc_cal.magic = ADC_CAL_MAGIC;
+  adc_cal.version = ADC_CAL_VERSION;
+  adc_cal.temp_mC = adc_cal_arch_read_temp_mC(adc);
+  adc_cal.supply_mV = (uint16_t)supply_mV;
+  /* the entries found so far are applied, list 2.5V first so that the gain transfer uses its offset */
+  adc_cal_valid = true;
+  for(i = 0; i < ADC_CAL_REF_COUNT && i < ADC_CAL_MAX_REFS; i++) {
+    reference = adc_cal_refs[i].reference;
+    entry = &adc_cal.entry[i];
+    /* start from the factory values loaded by ADC_InitSingle */
+    adc_cal_setup(adc, reference, adcPosSelVSS);
+    offset = (int8_t)((int8_t)(((adc->CAL & _ADC_CAL_SINGLEOFFSET_MASK) >> _ADC_CAL_SINGLEOFFSET_SHIFT) << 4) >> 4);
+    gain = (uint8_t)((adc->CAL & _ADC_CAL_SINGLEGAIN_MASK) >> _ADC_CAL_SINGLEGAIN_SHIFT);
+    if(!adc_cal_find_offset(adc, reference, gain, &offset)) {
+      LOG_WARN("ADC cal: offset not found for reference %u, factory value kept\n", reference);
+    }
+    entry->reference = (uint8_t)reference;
+    entry->offset = offset;
+    entry->gain = gain;
+    adc_cal.count = i + 1;
+    if(adc_cal_refs[i].gain_input != adcPosSelVSS) {
+      /* the entry keeps the factory gain if the search fails */
+      entry->gain_calibrated = 1;
+      if(adc_cal_find_gain(adc, reference, adc_cal_refs[i].gain_input, offset, &gain)) {
+        entry->gain = gain;
+      }
+    }
+    LOG_INFO("ADC cal: reference:%u offset:%d gain:%u\n", reference, entry->offset, entry->gain);
+  }
+  /* without a supply reading the store waits for adc_cal_arch_poll, one page erase per calibration */
+  adc_cal_store_pending = (supply_mV == 0);
+  if(adc_cal_store_pending) {
+    return false;
+  }
+  return adc_cal_store();
+}
+/*---------------------------------------------------------------------------*/
+bool
+adc_cal_arch_calibrate(ADC_TypeDef *adc)
+{
+  return adc_cal_run(adc, 0);
+}
+/*---------------------------------------------------------------------------*/
+void
+adc_cal_arch_init(ADC_TypeDef *adc)
+{
+  int32_t drift_mC;
+  if(adc_cal_load()) {
+    drift_mC = adc_cal_arch_read_temp_mC(adc) - adc_cal.temp_mC;
+    if(drift_mC < ADC_CAL_TEMP_DRIFT_mC && drift_mC > -ADC_CAL_TEMP_DRIFT_mC) {
+      LOG_INFO("ADC cal: loaded from flash\n");
+      return;
+    }
+  }
+  adc_cal_arch_calibrate(adc);
+}
+/*---------------------------------------------------------------------------*/
+void
+adc_cal_arch_apply(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, bool scan)
+{
+  const adc_cal_entry_t *entry = NULL;
+  uint32_t cal;
+  uint8_t i;
+
+  if(!adc_cal_valid) {
+    return;
+  }
+  for(i = 0; i < adc_cal.count; i++) {
+    if(adc_cal.entry[i].reference == (uint8_t)reference) {
+      entry = &adc_cal.entry[i];
+      break;
+    }
+  }
+  if(entry == NULL) {
+    return;   /* not listed, the factory calibration stays */
+  }
+  if(scan) {
+    cal = adc->CAL & ~(_ADC_CAL_SCANOFFSET_MASK | _ADC_CAL_SCANGAIN_MASK);
+    cal |= ((uint32_t)(entry->offset & 0x0F) << _ADC_CAL_SCANOFFSET_SHIFT) & _ADC_CAL_SCANOFFSET_MASK;
+    cal |= ((uint32_t)entry->gain << _ADC_CAL_SCANGAIN_SHIFT) & _ADC_CAL_SCANGAIN_MASK;
+    adc->CAL = cal;
+  } else {
+    adc_cal_set(adc, entry->offset, entry->gain);
+  }
+}
+/*---------------------------------------------------------------------------*/
+bool
+adc_cal_arch_poll(ADC_TypeDef *adc, uint32_t supply_mV)
+{
+  int32_t drift_mC, drift_mV;
+
+  if(!adc_cal_valid || adc_arch_busy()) {
+    return false;
+  }
+  drift_mC = adc_cal_arch_read_temp_mC(adc) - adc_cal.temp_mC;
+  if(adc_cal.supply_mV == 0 && supply_mV) {
+    /* first supply reading after a calibration becomes the reference point */
+    adc_cal.supply_mV = (uint16_t)supply_mV;
+    if(adc_cal_store_pending) {
+      adc_cal_store_pending = false;
+      adc_cal_store();
+    }
+  }
+  drift_mV = supply_mV ? ((int32_t)supply_mV - adc_cal.supply_mV) : 0;
+  if(drift_mC < ADC_CAL_TEMP_DRIFT_mC && drift_mC > -ADC_CAL_TEMP_DRIFT_mC
+     && drift_mV < ADC_CAL_SUPPLY_DRIFT_mV && drift_mV > -ADC_CAL_SUPPLY_DRIFT_mV) {
+    return false;
+  }
+  LOG_INFO("ADC cal: drift %ld mC %ld mV, recalibrating\n", (long)drift_mC, (long)drift_mV);
+  adc_cal_run(adc, supply_mV);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+const adc_cal_record_t *
+adc_cal_arch_get_record(void)
+{
+  return &adc_cal;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,114 @@
+#ifndef _ADC_CAL_ARCH_H_
+#define _ADC_CAL_ARCH_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <em_adc.h>
+#include "board.h"
+
+#define ADC_CAL_MAX_REFS              4                 /* references with a calibration entry */
+#define ADC_CAL_MAGIC                 0x4C414341UL      /* "ACAL" */
+#define ADC_CAL_VERSION               1
+#define ADC_CAL_SAMPLES_SHIFT         4                 /* calibration conversions are 16x oversampled */
+#define ADC_CAL_FLASH_ADDRESS         (FLASH_BASE + FLASH_SIZE - FLASH_PAGE_SIZE) /* last page, kept out of the linker script */
+
+#ifndef ADC_CAL_CONF_TEMP_DRIFT_mC
+#define ADC_CAL_TEMP_DRIFT_mC         10000             /* recalibrate when the die temperature moved 10 'C */
+#else
+#define ADC_CAL_TEMP_DRIFT_mC         ADC_CAL_CONF_TEMP_DRIFT_mC
+#endif /* ADC_CAL_CONF_TEMP_DRIFT_mC */
+
+#ifndef ADC_CAL_CONF_SUPPLY_DRIFT_mV
+#define ADC_CAL_SUPPLY_DRIFT_mV       100               /* recalibrate when the supply moved 100 mV */
+#else
+#define ADC_CAL_SUPPLY_DRIFT_mV       ADC_CAL_CONF_SUPPLY_DRIFT_mV
+#endif /* ADC_CAL_CONF_SUPPLY_DRIFT_mV */
+
+/*
+ * References to calibrate, { reference, gain input }. The offset of every listed reference is
+ * calibrated against VSS. The gain is transferred from the factory calibrated 2.5V reference
+ * by converting the gain input with both references, adcPosSelVSS keeps the factory gain.
+ * Keep the factory gain for VDD when VDD also supplies ratiometric dividers, e.g. NTCs.
+ */
+#ifndef BOARD_ADC_CAL_REFS
+#define BOARD_ADC_CAL_REFS            { { adcRef2V5, adcPosSelVSS } }
+#endif /* BOARD_ADC_CAL_REFS */
+
+typedef struct adc_cal_ref_config {
+  ADC_Ref_TypeDef reference;
+  ADC_PosSel_TypeDef gain_input;
+} adc_cal_ref_config_t;
+
+typedef struct adc_cal_entry {
+  uint8_t reference;            /* ADC_Ref_TypeDef */
+  int8_t offset;                /* SINGLEOFFSET, -8 to 7 */
+  uint8_t gain;                 /* SINGLEGAIN, 0 to 127 */
+  uint8_t gain_calibrated;      /* 0 when the factory gain is kept */
+} adc_cal_entry_t;
+
+/* flash record, a multiple of 4 bytes so that it can be written word by word */
+typedef struct adc_cal_record {
+  uint32_t magic;
+  int32_t temp_mC;              /* die temperature at calibration */
+  uint16_t supply_mV;           /* supply at calibration, 0 until the application reported it */
+  uint8_t version;
+  uint8_t count;                /* used entries */
+  adc_cal_entry_t entry[ADC_CAL_MAX_REFS];
+  uint16_t reserved;
+  uint16_t crc;                 /* CRC16 CCITT of all the fields before */
+} adc_cal_record_t;
+
+/*!
+* \fn     void adc_cal_arch_init(ADC_TypeDef *adc)
+* \brief  Function loads the calibration from flash. The ADC is calibrated when the flash holds
+*         no valid record for the BOARD_ADC_CAL_REFS list, the record is stored by the first
+*         adc_cal_arch_poll that reports the supply.
+*         Called by adc_arch_init.
+* \param  adc ADC peripheral.
+*/
+void adc_cal_arch_init(ADC_TypeDef *adc);
+
+/*!
+* \fn     bool adc_cal_arch_calibrate(ADC_TypeDef *adc)
+* \brief  Function calibrates offset and gain of all the listed references with a binary
+*         search. The supply is unknown here, so the result is stored in flash by the first
+*         adc_cal_arch_poll that reports it. It blocks for about 20 ms.
+* \param  adc ADC peripheral.
+* \return Function returns false, the record is not in flash until adc_cal_arch_poll stores it.
+*/
+bool adc_cal_arch_calibrate(ADC_TypeDef *adc);
+
+/*!
+* \fn     void adc_cal_arch_apply(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, bool scan)
+* \brief  Function writes the calibration of a reference into the CAL register. ADC_InitSingle
+*         and ADC_InitScan load the factory values, so call it after them.
+* \param  adc ADC peripheral.
+* \param  reference reference of the following conversions.
+* \param  scan true for the scan fields, false for the single fields.
+*/
+void adc_cal_arch_apply(ADC_TypeDef *adc, ADC_Ref_TypeDef reference, bool scan);
+
+/*!
+* \fn     bool adc_cal_arch_poll(ADC_TypeDef *adc, uint32_t supply_mV)
+* \brief  Function measures the die temperature and recalibrates when it or the supply moved
+*         more than ADC_CAL_TEMP_DRIFT_mC or ADC_CAL_SUPPLY_DRIFT_mV since the calibration.
+*         Call it from the application while no ADC read is running.
+* \param  adc ADC peripheral.
+* \param  supply_mV supply voltage measured by the application, 0 if unknown.
+* \return Function returns true if the ADC was recalibrated.
+*/
+bool adc_cal_arch_poll(ADC_TypeDef *adc, uint32_t supply_mV);
+
+/*!
+* \fn     int32_t adc_cal_arch_read_temp_mC(ADC_TypeDef *adc)
+* \brief  Function reads the internal temperature sensor with its factory calibration.
+* \param  adc ADC peripheral.
+* \return Function returns die temperature in millidegree Celsius.
+*/
+int32_t adc_cal_arch_read_temp_mC(ADC_TypeDef *adc);
+
+/*!
+* \fn     const adc_cal_record_t *adc_cal_arch_get_record(void)
+* \brief  Function returns the calibration in use.
+*/
+const adc_cal_record_t *adc_cal_arch_get_record(void);
+#endif /* _ADC_CAL_ARCH_H_ */
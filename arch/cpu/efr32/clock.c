@@ -50,6 +50,10 @@ clock_init(void)
   /* set system tick to generate interrupt at 1ms. Accuracy depends upon crystal tune */
   SysTick_Config(sys_clk / CLOCK_TICKS_CONF);
   usecond_clocks_10X = sys_clk / 100000;  /* for 38.4 MHz clock. This would be 384 */
+  /* start the DWT cycle counter for time measurements */
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
@@ -65,6 +69,26 @@ clock_get_time_ms(void)
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
+clock_get_time_us(void)
+{
+  clock_time_t ticks;
+  uint32_t val;
+  uint32_t load = SysTick->LOAD + 1;
+  bool pending;
+
+  do {
+    ticks = clock_ticks;
+    val = SysTick->VAL;
+    pending = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+  } while(ticks != clock_ticks);
+  /* the counter reloaded but the tick interrupt did not run yet, e.g. interrupts are disabled */
+  if(pending && val > (load / 2)) {
+    ticks++;
+  }
+  return (ticks * (1000000 / CLOCK_TICKS_CONF)) + (((clock_time_t)(load - val) * 10) / usecond_clocks_10X);
+}
+/*---------------------------------------------------------------------------*/
+clock_time_t
 clock_get_seconds(void)
 {
   return (clock_get_time_ms() / 1000);
@@ -94,3 +118,15 @@ clock_delay_us(uint32_t time_us)
   }
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+clock_get_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+clock_cycles_to_us(uint32_t cycles)
+{
+  return (uint32_t)(((uint64_t)cycles * 10) / usecond_clocks_10X);
+}
+/*---------------------------------------------------------------------------*/
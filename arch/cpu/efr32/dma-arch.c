@@ -0,0 +1,159 @@
+/**
+ * @file dma-arch.c
+ * @author Varun Marolia
+ * @brief This file contains arch specific methods for the LDMA controller.
+ *        The LDMA interrupt is shared by all the channels, every channel
+ *        can register its own callback which is called from the interrupt.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "dma-arch.h"
+#include "swo_debug.h"
+#include <em_cmu.h>
+#include <stddef.h>
+
+#define LOG_MODULE LOG_MODULE_DMA_ARCH
+#include "log.h"
+
+#pragma GCC diagnostic ignored "-Wattributes" /* for GCC V12 it gives warning of FP regsiters might be clobbered */
+void LDMA_IRQHandler() __attribute__((interrupt));
+
+typedef struct dma_channel {
+  void (* callback)(uint8_t channel, void *ctx);  /* called on channel done interrupt */
+  void *ctx;                                      /* context passed to the callback */
+} dma_channel_t;
+
+static dma_channel_t dma_channels[DMA_CHAN_COUNT];
+/* descriptors must stay in memory as long as the channel is running, looping descriptors are reloaded */
+static LDMA_Descriptor_t dma_descriptors[DMA_CHAN_COUNT];
+static bool dma_initialized = false;
+static volatile uint32_t dma_errors = 0;  /* bus or descriptor errors seen by the interrupt */
+/*---------------------------------------------------------------------------*/
+void
+dma_arch_init(void)
+{
+  LDMA_Init_t ldma_init = LDMA_INIT_DEFAULT;
+  if(dma_initialized) {
+    return;
+  }
+  CMU_ClockEnable(cmuClock_LDMA, true);
+  LDMA_Init(&ldma_init);    /* this also enables the LDMA interrupt in NVIC */
+  dma_initialized = true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+dma_arch_start_p2m_loop(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src,
+                        uint8_t *dst, uint16_t size, void (*callback)(uint8_t channel, void *ctx), void *ctx)
+{
+  LDMA_TransferCfg_t transfer_cfg = LDMA_TRANSFER_CFG_PERIPHERAL(signal);
+  if(channel >= DMA_CHAN_COUNT || dst == NULL || size == 0
+     || size > ((_LDMA_CH_CTRL_XFERCNT_MASK >> _LDMA_CH_CTRL_XFERCNT_SHIFT) + 1)) {
+    LOG_ERR("DMA (%s): invalid parameters\n", __func__);
+    return false;
+  }
+  dma_arch_init();
+  /* single descriptor linked to itself, relative jump of 0 descriptors */
+  dma_descriptors[channel] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_LINKREL_P2M_BYTE(src, dst, size, 0);
+  dma_descriptors[channel].xfer.doneIfs = 1;    /* raise channel interrupt on every wrap around */
+  dma_channels[channel].callback = callback;
+  dma_channels[channel].ctx = ctx;
+  LDMA_StartTransfer(channel, &transfer_cfg, &dma_descriptors[channel]);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+dma_arch_start_p2m_word(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src,
+                        uint32_t *dst, uint16_t count, void (*callback)(uint8_t channel, void *ctx), void *ctx)
+{
+  LDMA_TransferCfg_t transfer_cfg = LDMA_TRANSFER_CFG_PERIPHERAL(signal);
+  if(channel >= DMA_CHAN_COUNT || dst == NULL || count == 0
+     || count > ((_LDMA_CH_CTRL_XFERCNT_MASK >> _LDMA_CH_CTRL_XFERCNT_SHIFT) + 1)) {
+    LOG_ERR("DMA (%s): invalid parameters\n", __func__);
+    return false;
+  }
+  dma_arch_init();
+  /* single descriptor, raises the channel interrupt when done */
+  dma_descriptors[channel] = (LDMA_Descriptor_t)LDMA_DESCRIPTOR_SINGLE_P2M_BYTE(src, dst, count);
+  dma_descriptors[channel].xfer.size = ldmaCtrlSizeWord;
+  dma_channels[channel].callback = callback;
+  dma_channels[channel].ctx = ctx;
+  LDMA_StartTransfer(channel, &transfer_cfg, &dma_descriptors[channel]);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+dma_arch_get_index(uint8_t channel, uint16_t size)
+{
+  uint16_t remaining;
+  if(channel >= DMA_CHAN_COUNT || size == 0) {
+    return 0;
+  }
+  /* LDMA_TransferRemainingCount reports 0 for a looping channel once its done flag is set,
+   * so read the transfer count directly. XFERCNT holds the remaining count minus one */
+  remaining = ((LDMA->CH[channel].CTRL & _LDMA_CH_CTRL_XFERCNT_MASK) >> _LDMA_CH_CTRL_XFERCNT_SHIFT) + 1;
+  if(remaining > size) {
+    remaining = size;
+  }
+  return (size - remaining) % size;
+}
+/*---------------------------------------------------------------------------*/
+void
+dma_arch_stop(uint8_t channel)
+{
+  if(channel >= DMA_CHAN_COUNT || !dma_initialized) {
+    return;
+  }
+  LDMA_StopTransfer(channel);
+  dma_channels[channel].callback = NULL;
+  dma_channels[channel].ctx = NULL;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+dma_arch_get_errors(void)
+{
+  return dma_errors;
+}
+/*---------------------------------------------------------------------------*/
+void
+LDMA_IRQHandler()
+{
+  uint32_t pending;
+  uint8_t ch;
+  SWO_ISR_ENTER();
+  pending = LDMA_IntGetEnabled();
+  if(pending & LDMA_IF_ERROR) {
+    /* bus or descriptor error, the controller halts. Nothing to recover here */
+    LDMA_IntClear(LDMA_IF_ERROR);
+    dma_errors++;   /* no printf from the interrupt, see dma_arch_get_errors() */
+  }
+  for(ch = 0; ch < DMA_CHAN_COUNT; ch++) {
+    if(pending & (1UL << ch)) {
+      LDMA_IntClear(1UL << ch);
+      if(dma_channels[ch].callback != NULL) {
+        dma_channels[ch].callback(ch, dma_channels[ch].ctx);
+      }
+    }
+  }
+  SWO_ISR_EXIT();
+}
+/*---------------------------------------------------------------------------*/
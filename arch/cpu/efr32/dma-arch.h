@@ -0,0 +1,72 @@
+#ifndef _DMA_ARCH_H_
+#define _DMA_ARCH_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <em_ldma.h>
+
+#define DMA_ARCH_CHANNEL_UART_RX    0   /* LDMA channel used for debug UART RX circular buffer */
+#define DMA_ARCH_CHANNEL_UART_RX_2  1   /* LDMA channel used for a second UART RX circular buffer e.g. host link */
+#define DMA_ARCH_CHANNEL_ADC_SCAN   2   /* LDMA channel used for ADC scan results */
+#define DMA_ARCH_CHANNEL_INVALID    0xFF
+
+/*!
+* \fn     void dma_arch_init(void)
+* \brief  Function initializes the LDMA controller. Safe to call more than once.
+*/
+void dma_arch_init(void);
+
+/*!
+* \fn     bool dma_arch_start_p2m_loop(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src, uint8_t *dst, uint16_t size, void (*callback)(uint8_t channel, void *ctx), void *ctx)
+* \brief  Function starts a peripheral to memory byte transfer into a circular buffer. The
+*         descriptor links to itself so the buffer is refilled endlessly. The callback is
+*         called from the LDMA interrupt every time the buffer wraps around.
+* \param  channel LDMA channel number.
+* \param  signal peripheral request signal, e.g. ldmaPeripheralSignal_USART0_RXDATAV.
+* \param  src peripheral data register address.
+* \param  dst circular buffer.
+* \param  size size of the circular buffer, max 2048 bytes.
+* \param  callback wrap around callback, can be NULL.
+* \param  ctx context pointer passed to the callback.
+* \return Function returns true if the transfer was started.
+*/
+bool dma_arch_start_p2m_loop(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src,
+                             uint8_t *dst, uint16_t size, void (*callback)(uint8_t channel, void *ctx), void *ctx);
+
+/*!
+* \fn     bool dma_arch_start_p2m_word(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src, uint32_t *dst, uint16_t count, void (*callback)(uint8_t channel, void *ctx), void *ctx)
+* \brief  Function starts a single peripheral to memory word transfer. The callback is called
+*         from the LDMA interrupt once all the words were moved.
+* \param  channel LDMA channel number.
+* \param  signal peripheral request signal, e.g. ldmaPeripheralSignal_ADC0_SCAN.
+* \param  src peripheral data register address.
+* \param  dst destination buffer.
+* \param  count number of words, max 2048.
+* \param  callback done callback, can be NULL.
+* \param  ctx context pointer passed to the callback.
+* \return Function returns true if the transfer was started.
+*/
+bool dma_arch_start_p2m_word(uint8_t channel, LDMA_PeripheralSignal_t signal, volatile const void *src,
+                             uint32_t *dst, uint16_t count, void (*callback)(uint8_t channel, void *ctx), void *ctx);
+
+/*!
+* \fn     uint16_t dma_arch_get_index(uint8_t channel, uint16_t size)
+* \brief  Function returns the index in the circular buffer the next byte will be written to.
+* \param  channel LDMA channel number.
+* \param  size size of the circular buffer.
+*/
+uint16_t dma_arch_get_index(uint8_t channel, uint16_t size);
+
+/*!
+* \fn     void dma_arch_stop(uint8_t channel)
+* \brief  Function stops the transfer on given channel and removes its callback.
+* \param  channel LDMA channel number.
+*/
+void dma_arch_stop(uint8_t channel);
+
+/*!
+* \fn     uint32_t dma_arch_get_errors(void)
+* \brief  Function returns the number of LDMA bus or descriptor errors since boot. The
+*         interrupt only counts them, it does not print.
+*/
+uint32_t dma_arch_get_errors(void);
+#endif /* _DMA_ARCH_H_ */
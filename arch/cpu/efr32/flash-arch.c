@@ -1,6 +1,7 @@
 #include "dev/common/flash.h"
 #include <em_msc.h>
 #include <em_system.h>
+#include <string.h>
 
 #define EFR32_FLASH_PAGE_MASK (0xFFFFFFFF - FLASH_PAGE_SIZE  + 1) /* flash page size of 2KB */
 /*---------------------------------------------------------------------------*/
@@ -21,17 +22,19 @@ msc_status_to_flash_status(MSC_Status_TypeDef status) {
 }
 /*---------------------------------------------------------------------------*/
 flash_status_t flash_lock(void) {
-  /* All em_msc.c functions lock and unlock the flash pages */
+  /* lock the MSC registers and disable writes again */
+  MSC_Deinit();
   return FLASH_STATUS_OK;
 }
 /*---------------------------------------------------------------------------*/
 flash_status_t flash_unlock(void) {
-  /* All em_msc.c functions lock and unlock the flash pages */
+  /* em_msc.c erase and write functions expect the MSC to be unlocked by MSC_Init */
+  MSC_Init();
   return FLASH_STATUS_OK;
 }
 /*---------------------------------------------------------------------------*/
 flash_status_t flash_erase_sector(uint32_t address) {
-  if(address < FLASH_SIZE) {
+  if((address - FLASH_BASE) >= FLASH_SIZE) {
     return FLASH_STATUS_INVALID_ADDRESS;
   }
   /* make sure the address is beginning of a flash page */
@@ -41,8 +44,17 @@ flash_status_t flash_erase_sector(uint32_t address) {
 /*---------------------------------------------------------------------------*/
 flash_status_t flash_write_word(uint32_t address, uint32_t data) {
   /* check if address is multiplication of word size */
-  if((address & 0x3) != 0 && address < FLASH_SIZE) {
-    return FLASH_STATUS_INVALID_ADDRESS; /* address is not word aligned */
+  if((address & 0x3) != 0 || (address - FLASH_BASE) >= FLASH_SIZE) {
+    return FLASH_STATUS_INVALID_ADDRESS; /* address is not word aligned or outside the flash */
   }
   return msc_status_to_flash_status(MSC_WriteWord((uint32_t *)address, &data, 4)); /* write the data to flash */
 }
+/*---------------------------------------------------------------------------*/
+flash_status_t flash_read(uint32_t address, void *data, uint32_t len) {
+  if(data == NULL || len > FLASH_SIZE || (address - FLASH_BASE) > (FLASH_SIZE - len)) {
+    return FLASH_STATUS_INVALID_ADDRESS;
+  }
+  /* the flash is memory mapped */
+  memcpy(data, (const void *)address, len);
+  return FLASH_STATUS_OK;
+}
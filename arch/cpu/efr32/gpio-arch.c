@@ -31,6 +31,7 @@
 #include <em_gpio.h>
 #include <em_cmu.h>
 #include "clock.h"
+#include "swo_debug.h"
 #include <stdio.h>
 
 #define MAX_EXT_INT 16  /* maximum number of external interrupts */
@@ -86,16 +87,20 @@ void GPIO_EVEN_IRQHandler(void) __attribute__((interrupt));
 void 
 GPIO_EVEN_IRQHandler(void)
 {
+  SWO_ISR_ENTER();
   GPIO_common_IRQHandler();
   NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+  SWO_ISR_EXIT();
 }
 /*---------------------------------------------------------------------------*/
 void GPIO_ODD_IRQHandler(void) __attribute__((interrupt));
 void 
 GPIO_ODD_IRQHandler(void)
 {
+  SWO_ISR_ENTER();
   GPIO_common_IRQHandler();
   NVIC_ClearPendingIRQ(GPIO_ODD_IRQn);
+  SWO_ISR_EXIT();
 }
 /*---------------------------------------------------------------------------*/
 static 
@@ -34,13 +34,8 @@
 #include "pwm-dev.h"
 #include <em_cmu.h>
 
-#define DEBUG_PWM_ARCH 0     /**< Set this to 1 for debug printf output */
-#if DEBUG_PWM_ARCH
-#include <stdio.h>
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)      /**< Replace printf with nothing */
-#endif /* PWM_ARCH */
+#define LOG_MODULE LOG_MODULE_PWM_ARCH
+#include "log.h"
 
 #ifdef TIMER0
 const pwm_config_t *pwm_config_timer0 = NULL;
@@ -58,7 +53,7 @@ pwm_arch_init(pwm_dev_t *dev)
   uint32_t counter_top = CMU_ClockFreqGet(cmuClock_HFPER) / dev->config->freq_hz - 1;
   uint32_t compare_value = (counter_top * dev->duty_cycle_100x) / 10000;
   if(!TIMER_REF_VALID(dev->config->timer_per)) {
-    PRINTF("PWM-ARCH: Given timer is not supported by this arch !!!\n");
+    LOG_ERR("PWM-ARCH: Given timer is not supported by this arch !!!\n");
     return PWM_STATUS_INVALID_TIMER;
   }
   /* Select CC (capture and compare) channel parameters. */
@@ -99,16 +94,16 @@ pwm_arch_init(pwm_dev_t *dev)
     if(dev->config != pwm_config_timer0) {
       if(pwm_config_timer0 != NULL) {
         /* timer is set in different config already by some other device! */
-        PRINTF("PWM-ARCH: Timer0 is already in use by some other device!!!\n");
+        LOG_WARN("PWM-ARCH: Timer0 is already in use by some other device!!!\n");
         return PWM_STATUS_BUSY;
       } 
       /* enable the timer clock frequency */
       CMU_ClockEnable(cmuClock_TIMER0, true);
       /* Set Top Value, TOP=(F_HFPER/(2^PRESC x F_PWM))-1 here PRESC value = 0 */
       TIMER_TopSet(TIMER0, counter_top);
-      PRINTF("PWM-ARCH: Set Timer0 Top: %lu\n", counter_top);
+      LOG_DBG("PWM-ARCH: Set Timer0 Top: %lu\n", counter_top);
     } else {
-      PRINTF("PWM-ARCH: Timer0 is already configured with same config.\n");
+      LOG_DBG("PWM-ARCH: Timer0 is already configured with same config.\n");
     }
     /* Configure CC channel */
     TIMER_InitCC(TIMER0, dev->cc_channel, &timerCCInit);
@@ -123,7 +118,7 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER0->ROUTELOC0 = (TIMER0->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC0LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC0LOC_SHIFT);
         TIMER0->ROUTEPEN |= TIMER_ROUTEPEN_CC0PEN; /*CC Channel 0 pin Enable */
-        PRINTF("PWM-ARCH: Timer0 CC channel 0 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer0 CC channel 0 is configured.\n");
       break;
       
       case 1:
@@ -133,7 +128,7 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER0->ROUTELOC0 = (TIMER0->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC1LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC1LOC_SHIFT);
         TIMER0->ROUTEPEN |= TIMER_ROUTEPEN_CC1PEN; /*CC Channel 1 pin Enable */
-        PRINTF("PWM-ARCH: Timer0 CC channel 1 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer0 CC channel 1 is configured.\n");
       break;
       
       case 2:
@@ -143,11 +138,11 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER0->ROUTELOC0 = (TIMER0->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC2LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC2LOC_SHIFT);
         TIMER0->ROUTEPEN |= TIMER_ROUTEPEN_CC2PEN; /*CC Channel 2 pin Enable */
-        PRINTF("PWM-ARCH: Timer0 CC channel 2 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer0 CC channel 2 is configured.\n");
       break;
       
       default:
-        PRINTF("PWM-ARCH: Timer0 CC channel: %u not Available!!!\n", dev->cc_channel);
+        LOG_ERR("PWM-ARCH: Timer0 CC channel: %u not Available!!!\n", dev->cc_channel);
         return PWM_STATUS_INVALID_CHANNEL;
       break;
     }
@@ -160,7 +155,7 @@ pwm_arch_init(pwm_dev_t *dev)
     /* Configure timer if it has not been configured. this will also start the timer */
     if(pwm_config_timer0 == NULL) {
       TIMER_Init(TIMER0, &timerInit);
-      PRINTF("PWM-ARCH: Timer0 is configured and started.\n");
+      LOG_DBG("PWM-ARCH: Timer0 is configured and started.\n");
     }
     /* assign the config to this timer */
     pwm_config_timer0 = dev->config;
@@ -172,16 +167,16 @@ pwm_arch_init(pwm_dev_t *dev)
     if(dev->config != pwm_config_timer1) {
       if(pwm_config_timer1 != NULL) {
         /* timer is set in different config already by some other device! */
-        PRINTF("PWM-ARCH: Timer1 is already in use by some other device!!!\n");
+        LOG_WARN("PWM-ARCH: Timer1 is already in use by some other device!!!\n");
         return PWM_STATUS_BUSY;
       }
       /* enable the timer clock frequency */
       CMU_ClockEnable(cmuClock_TIMER1, true);
       /* Set Top Value, TOP=(F_HFPER/(2^PRESC x F_PWM))-1 here PRESC value=0 */
       TIMER_TopSet(TIMER1, counter_top);
-      PRINTF("PWM-ARCH: Set Timer1 Top: %lu\n", counter_top);
+      LOG_DBG("PWM-ARCH: Set Timer1 Top: %lu\n", counter_top);
     } else {
-      PRINTF("PWM-ARCH: Timer1 is already configured with same config.\n");
+      LOG_DBG("PWM-ARCH: Timer1 is already configured with same config.\n");
     }
     /* Configure CC channel 0 */
     TIMER_InitCC(TIMER1, dev->cc_channel, &timerCCInit);
@@ -195,7 +190,7 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER1->ROUTELOC0 = (TIMER1->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC0LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC0LOC_SHIFT);
         TIMER1->ROUTEPEN |= TIMER_ROUTEPEN_CC0PEN; /*CC Channel 0 pin Enable */
-        PRINTF("PWM-ARCH: Timer1 CC channel 0 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer1 CC channel 0 is configured.\n");
       break;
       
       case 1:
@@ -205,7 +200,7 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER1->ROUTELOC0 = (TIMER1->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC1LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC1LOC_SHIFT);
         TIMER1->ROUTEPEN |= TIMER_ROUTEPEN_CC1PEN; /*CC Channel 1 pin Enable */
-        PRINTF("PWM-ARCH: Timer1 CC channel 1 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer1 CC channel 1 is configured.\n");
       break;
       
       case 2:
@@ -215,7 +210,7 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER1->ROUTELOC0 = (TIMER1->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC2LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC2LOC_SHIFT);
         TIMER1->ROUTEPEN |= TIMER_ROUTEPEN_CC2PEN; /*CC Channel 2 pin Enable */
-        PRINTF("PWM-ARCH: Timer1 CC channel 2 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer1 CC channel 2 is configured.\n");
       break;
       
       case 3:
@@ -225,11 +220,11 @@ pwm_arch_init(pwm_dev_t *dev)
         TIMER1->ROUTELOC0 = (TIMER1->ROUTELOC0 & ~_TIMER_ROUTELOC0_CC3LOC_MASK)
         | (dev->gpio_loc << _TIMER_ROUTELOC0_CC3LOC_SHIFT);
         TIMER1->ROUTEPEN |= TIMER_ROUTEPEN_CC3PEN; /*CC Channel 0 pin Enable */
-        PRINTF("PWM-ARCH: Timer1 CC channel 3 is configured.\n");
+        LOG_DBG("PWM-ARCH: Timer1 CC channel 3 is configured.\n");
       break;
       
       default:
-        PRINTF("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
+        LOG_ERR("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
         return PWM_STATUS_INVALID_CHANNEL;
       break;
     }
@@ -242,13 +237,13 @@ pwm_arch_init(pwm_dev_t *dev)
     /* Configure timer. this will also start the timer */
     if(pwm_config_timer1 == NULL) {
       TIMER_Init(TIMER1, &timerInit);
-      PRINTF("PWM-ARCH: Timer1 is configured and started.\n");
+      LOG_DBG("PWM-ARCH: Timer1 is configured and started.\n");
     }
     pwm_config_timer1 = dev->config;
   }
 #endif /* TIMER1 */
   else {
-    PRINTF("PWM-ARCH: Given timer is not implemented !!!\n");
+    LOG_ERR("PWM-ARCH: Given timer is not implemented !!!\n");
     return PWM_STATUS_INVALID_TIMER;
   }
   return PWM_STATUS_OK;
@@ -260,7 +255,7 @@ pwm_arch_reset(pwm_dev_t *dev)
   GPIO_Port_TypeDef pwm_port;
   uint8_t pwm_pin;
   if(!TIMER_REF_VALID(dev->config->timer_per)) {
-    PRINTF("PWM-ARCH: Given timer is not supported by this arch !!!\n");
+    LOG_ERR("PWM-ARCH: Given timer is not supported by this arch !!!\n");
     return PWM_STATUS_INVALID_TIMER;
   }
 #ifdef TIMER0
@@ -289,7 +284,7 @@ pwm_arch_reset(pwm_dev_t *dev)
       break;
       
       default:
-        PRINTF("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
+        LOG_ERR("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
         return PWM_STATUS_INVALID_CHANNEL;
       break;
     }
@@ -335,7 +330,7 @@ pwm_arch_reset(pwm_dev_t *dev)
       break;
       
       default:
-        PRINTF("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
+        LOG_ERR("PWM-ARCH: TIMER1 CC channel:%u not Available!!!\n", dev->cc_channel);
         return PWM_STATUS_INVALID_CHANNEL;
       break;
     }
@@ -357,7 +352,7 @@ pwm_arch_set_duty_cycle(pwm_dev_t *dev)
   uint32_t compare_value;
   uint32_t counter_top;
   if(!TIMER_REF_VALID(dev->config->timer_per)) {
-    PRINTF("PWM-ARCH: Given timer is not supported by this arch !!!\n");
+    LOG_ERR("PWM-ARCH: Given timer is not supported by this arch !!!\n");
     return PWM_STATUS_INVALID_TIMER;
   }
   counter_top = CMU_ClockFreqGet(cmuClock_HFPER) / dev->config->freq_hz - 1;
@@ -369,17 +364,17 @@ pwm_arch_set_duty_cycle(pwm_dev_t *dev)
   if(dev->config->timer_per == TIMER0) {
     /* Set compare value for PWM compare channel (CC) to compare value. */
     TIMER_CompareBufSet(TIMER0, dev->cc_channel, compare_value);
-    PRINTF("PWM-ARCH: Set Timer0 CC channel %u compare value: %lu\n", dev->cc_channel, compare_value);
+    LOG_DBG("PWM-ARCH: Set Timer0 CC channel %u compare value: %lu\n", dev->cc_channel, compare_value);
   }
 #endif /* TIMER0 */
 #ifdef TIMER1
   else if(dev->config->timer_per == TIMER1){
     TIMER_CompareBufSet(TIMER1, dev->cc_channel, compare_value);
-    PRINTF("PWM-ARCH: Set Timer1 CC channel %u compare value: %lu\n", dev->cc_channel, compare_value);
+    LOG_DBG("PWM-ARCH: Set Timer1 CC channel %u compare value: %lu\n", dev->cc_channel, compare_value);
   }
 #endif /* TIMER1 */
   else {
-    PRINTF("PWM-ARCH: Timer is not implemented!!!\n");
+    LOG_ERR("PWM-ARCH: Timer is not implemented!!!\n");
     return PWM_STATUS_INVALID_TIMER;
   }
   return PWM_STATUS_OK;
@@ -392,18 +387,18 @@ pwm_arch_enable_device(pwm_dev_t *dev, uint8_t on_off)
     if(on_off == PWM_DEVICE_ENABLE) {
       if(dev->dev_enable->logic == ENABLE_ACTIVE_LOW) {
         GPIO_PinModeSet(dev->dev_enable->port, dev->dev_enable->pin, gpioModePushPull, 0);
-        PRINTF("PWM-ARCH: PWM device enabled active low...\n");
+        LOG_DBG("PWM-ARCH: PWM device enabled active low...\n");
       } else {
         GPIO_PinModeSet(dev->dev_enable->port, dev->dev_enable->pin, gpioModePushPull, 1);
-        PRINTF("PWM-ARCH: PWM device enabled active high...\n");
+        LOG_DBG("PWM-ARCH: PWM device enabled active high...\n");
       }
     } else {
       if(dev->dev_enable->logic == ENABLE_ACTIVE_LOW) {
         GPIO_PinModeSet(dev->dev_enable->port, dev->dev_enable->pin, gpioModeDisabled, 1);
-        PRINTF("PWM-ARCH: PWM device disabled high...\n");
+        LOG_DBG("PWM-ARCH: PWM device disabled high...\n");
       } else {
         GPIO_PinModeSet(dev->dev_enable->port, dev->dev_enable->pin, gpioModeDisabled, 0);
-        PRINTF("PWM-ARCH: PWM device disabled low...\n");
+        LOG_DBG("PWM-ARCH: PWM device disabled low...\n");
       }
     }
   }
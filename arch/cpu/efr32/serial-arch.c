@@ -5,7 +5,10 @@
  *        communication. Current implementation of all serial TX, RX 
  *        is poll based design except for UART RX which uses interrupt 
  *        based design for obvious reason. The mode of operation for SPI
- *        and I2C is master only.
+ *        and I2C is master only. UART RX can either raise an interrupt per
+ *        byte or let LDMA fill a circular buffer, in which case the
+ *        consumer is notified once per burst using the USART timer
+ *        (idle line) and the LDMA wrap around interrupt.
  * 
  * @copyright Copyright (c) 2025 Varun Marolia
  *   MIT License
@@ -31,35 +34,31 @@
 
 #include "serial-arch.h"
 #include "serial-dev.h"
+#include "atomic-arch.h"
+#include "swo_debug.h"
 #include <stdbool.h>
 #define RX_NVIC 0
 #define TX_NVIC 1
 
-#define DEBUG_SERIAL_ARCH 0     /**< Set this to 1 for debug printf output */
-#if DEBUG_SERIAL_ARCH
-#include <stdio.h>
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)      /**< Replace printf with nothing */
-#endif /* DEBUG_SERIAL_ARCH */
+#define LOG_MODULE LOG_MODULE_SERIAL_ARCH
+#include "log.h"
 
 #pragma GCC diagnostic ignored "-Wattributes" /* for GCC V12 it gives warning of FP regsiters might be clobbered */
 
 #ifdef USART0
 void USART0_RX_IRQHandler() __attribute__((interrupt));
 void USART0_TX_IRQHandler() __attribute__((interrupt));
-static serial_dev_t *dev_on_uart0 = NULL;
 #endif  /* USART0 */
 #ifdef USART1
 void USART1_RX_IRQHandler() __attribute__((interrupt));
 void USART1_TX_IRQHandler() __attribute__((interrupt));
-static serial_dev_t *dev_on_uart1 = NULL;
 #endif  /* USART1 */
 #ifdef USART2
 void USART2_RX_IRQHandler() __attribute__((interrupt));
 void USART2_TX_IRQHandler() __attribute__((interrupt));
-static serial_dev_t *dev_on_uart2 = NULL;
 #endif  /* USART2 */
+/* UART device currently owning each USART, indexed by USART number. Used to dispatch interrupts */
+static serial_dev_t *uart_devs[USART_COUNT];
 /*---------------------------------------------------------------------------*/
 static serial_bus_status_t
 serial_init_I2C(serial_dev_t *dev)
@@ -71,7 +70,7 @@ serial_init_I2C(serial_dev_t *dev)
   /* check if the speed is configured correctly. Usual speed are 100KHz or 400KHz */
   if(dev->speed_hz != I2C_SPEED_NORMAL_HZ &&
     dev->speed_hz != I2C_SPEED_FAST_HZ) {
-    PRINTF("I2C (%s): speed %lu is invalid\n", __func__, dev->speed);
+    LOG_ERR("I2C (%s): speed %lu is invalid\n", __func__, dev->speed_hz);
     return BUS_INVALID;
   }
   /* Check if the I2C bus is supported by the hardware
@@ -106,11 +105,11 @@ serial_init_I2C(serial_dev_t *dev)
     scl_pin = AF_I2C1_SCL_PIN(bus_config->clk_loc);
   #endif /* I2C1 */
   } else {
-    PRINTF("I2C (%s): unsupported I2Cx: %p\n", __func__, conf->I2Cx);
+    LOG_ERR("I2C (%s): unsupported I2Cx: %p\n", __func__, (void *)bus_config->I2Cx);
     return BUS_INVALID;
   }
-  PRINTF("I2C: SDA PORT: %d, PIN: %d\n", (int)sda_port, (int)sda_pin);
-  PRINTF("I2C: SCL PORT: %d, PIN: %d\n", (int)scl_port, (int)scl_pin);
+  LOG_DBG("I2C: SDA PORT: %d, PIN: %d\n", (int)sda_port, (int)sda_pin);
+  LOG_DBG("I2C: SCL PORT: %d, PIN: %d\n", (int)scl_port, (int)scl_pin);
   /* enable GPIO clock  */
   CMU_ClockEnable(cmuClock_GPIO, true);
   /* Set the GPIO pin mode Open-drain output with filter */
@@ -145,7 +144,7 @@ serial_init_SPI(serial_dev_t *dev)
   } else if(spi_uart == USART2) {
     CMU_ClockEnable(cmuClock_USART2, true);
   } else {
-    PRINTF("SPI (%s): interface not supported!\n", __func__);
+    LOG_ERR("SPI (%s): interface not supported!\n", __func__);
     return BUS_INVALID;
   }
   CMU_ClockEnable(cmuClock_GPIO, true);
@@ -177,7 +176,7 @@ serial_init_SPI(serial_dev_t *dev)
     GPIO_PinModeSet(AF_USART2_RX_PORT(bus_config->data_in_loc), AF_USART2_RX_PIN(bus_config->data_in_loc), gpioModeInput, 0);
     GPIO_PinModeSet(AF_USART2_CLK_PORT(bus_config->clk_loc), AF_USART2_CLK_PIN(bus_config->clk_loc), gpioModePushPull, 1);
   } else {
-    PRINTF("SPI (%s): controller not supported!\n", __func__);
+    LOG_ERR("SPI (%s): controller not supported!\n", __func__);
     return BUS_INVALID;
   }
 
@@ -253,37 +252,99 @@ serial_uart_NVIC_clear_interrupt(USART_TypeDef *uart, uint8_t rxtx)
   }
 }
 /*---------------------------------------------------------------------------*/
+static int8_t
+serial_uart_index(USART_TypeDef *uart)
+{
+  if(uart == USART0) {
+    return 0;
+  }
+#ifdef USART1
+  if(uart == USART1) {
+    return 1;
+  }
+#endif  /* USART1 */
+#ifdef USART2
+  if(uart == USART2) {
+    return 2;
+  }
+#endif  /* USART2 */
+#ifdef USART3
+  if(uart == USART3) {
+    return 3;
+  }
+#endif  /* USART3 */
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+static serial_dev_t *
+serial_uart_get_dev(USART_TypeDef *uart)
+{
+  int8_t index = serial_uart_index(uart);
+  if(index < 0 || index >= USART_COUNT) {
+    return NULL;
+  }
+  return uart_devs[index];
+}
+/*---------------------------------------------------------------------------*/
+static void
+uart_rx_dma_deliver(serial_dev_t *dev)
+{
+  serial_bus_config_t *bus_config = &dev->bus->config;
+  uint16_t head;
+  uint16_t tail = bus_config->rx_dma_tail;
+  uint16_t len;
+  head = dma_arch_get_index(bus_config->rx_dma_channel, bus_config->rx_dma_buff_size);
+  /* deliver the data in maximum two contiguous chunks, till the end of buffer and from the start */
+  while(tail != head) {
+    len = (head > tail) ? (head - tail) : (bus_config->rx_dma_buff_size - tail);
+    if(bus_config->input_block_handler != NULL) {
+      bus_config->input_block_handler(bus_config->handler_ctx, &bus_config->rx_dma_buff[tail], len);
+    }
+    bus_config->rx_stats.bytes += len;
+    tail = (tail + len) % bus_config->rx_dma_buff_size;
+  }
+  bus_config->rx_dma_tail = tail;
+}
+/*---------------------------------------------------------------------------*/
+static void
+uart_rx_dma_callback(uint8_t channel, void *ctx)
+{
+  (void)channel;
+  /* buffer wrapped around during a long burst, hand over the data before it gets overwritten */
+  uart_rx_dma_deliver((serial_dev_t *)ctx);
+}
+/*---------------------------------------------------------------------------*/
 static void
 uart_rx_interrupt_handler(USART_TypeDef *uart)
 {
   uint8_t data;
+  serial_dev_t *dev = serial_uart_get_dev(uart);
   uint32_t interrupt_flags = USART_IntGetEnabled(uart);
   /* clear interrupt flags */
-  USART_IntClear(uart, interrupt_flags & (USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF));
+  USART_IntClear(uart, interrupt_flags & (USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF | USART_IF_TCMP1));
+  if(dev == NULL) {
+    return;
+  }
+  if(interrupt_flags & USART_IF_FERR) {
+    dev->bus->config.rx_stats.framing_errors++;
+  }
+  if(interrupt_flags & USART_IF_PERR) {
+    dev->bus->config.rx_stats.parity_errors++;
+  }
+  if(interrupt_flags & USART_IF_RXOF) {
+    dev->bus->config.rx_stats.overflow_errors++;
+  }
+  if(interrupt_flags & USART_IF_TCMP1) {
+    /* RX line has been idle for rx_idle_bits, end of burst */
+    dev->bus->config.rx_stats.bursts++;
+    uart_rx_dma_deliver(dev);
+  }
   if(interrupt_flags & USART_IF_RXDATAV) {
     if(uart->STATUS & USART_STATUS_RXDATAV) {
       data = USART_RxDataGet(uart);
-#ifdef USART0
-      if(uart == USART0 && dev_on_uart0 != NULL) {
-        if(dev_on_uart0->bus->config.input_handler != NULL) {
-          dev_on_uart0->bus->config.input_handler(data);
-        }
-      }
-#endif  /* USART0 */
-#ifdef USART1
-      if(uart == USART1 && dev_on_uart1 != NULL) {
-        if(dev_on_uart1->bus->config.input_handler != NULL) {
-          dev_on_uart1->bus->config.input_handler(data);
-        }
+      if(dev->bus->config.input_handler != NULL) {
+        dev->bus->config.input_handler(dev->bus->config.handler_ctx, data);
       }
-#endif  /* USART1 */
-#ifdef USART2
-      if(uart == USART2 && dev_on_uart2 != NULL) {
-        if(dev_on_uart2->bus->config.input_handler != NULL) {
-          dev_on_uart2->bus->config.input_handler(data);
-        }
-      }
-#endif  /* USART2 */
       /* clear RXDATAV interrupt flag */
       USART_IntClear(uart, USART_IF_RXDATAV);
     }
@@ -293,20 +354,35 @@ uart_rx_interrupt_handler(USART_TypeDef *uart)
 static void
 uart_tx_interrupt_handler(USART_TypeDef *uart)
 {
-
+  uint8_t data;
+  serial_dev_t *dev = serial_uart_get_dev(uart);
+  /* keep filling the TX buffer as long as there is space in it and data to send */
+  while(uart->STATUS & USART_STATUS_TXBL) {
+    if(dev == NULL || dev->bus->config.output_handler == NULL
+       || !dev->bus->config.output_handler(dev->bus->config.handler_ctx, &data)) {
+      /* nothing more to send, TXBL interrupt will be enabled again by serial_arch_enable_tx */
+      USART_IntDisable(uart, USART_IF_TXBL);
+      break;
+    }
+    uart->TXDATA = data;
+  }
 }
 /*---------------------------------------------------------------------------*/
 #ifdef USART0
 void
 USART0_TX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_tx_interrupt_handler(USART0);
+  SWO_ISR_EXIT();
 }
 /*---------------------------------------------------------------------------*/
 void
 USART0_RX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_rx_interrupt_handler(USART0);
+  SWO_ISR_EXIT();
 }
 #endif  /* USART0 */
 /*---------------------------------------------------------------------------*/
@@ -314,13 +390,17 @@ USART0_RX_IRQHandler()
 void
 USART1_TX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_tx_interrupt_handler(USART1);
+  SWO_ISR_EXIT();
 }
 /*---------------------------------------------------------------------------*/
 void
 USART1_RX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_rx_interrupt_handler(USART1);
+  SWO_ISR_EXIT();
 }
 #endif  /* USART1 */
 /*---------------------------------------------------------------------------*/
@@ -328,13 +408,17 @@ USART1_RX_IRQHandler()
 void
 USART2_TX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_tx_interrupt_handler(USART2);
+  SWO_ISR_EXIT();
 }
 /*---------------------------------------------------------------------------*/
 void
 USART2_RX_IRQHandler()
 {
+  SWO_ISR_ENTER();
   uart_rx_interrupt_handler(USART2);
+  SWO_ISR_EXIT();
 }
 #endif  /* USART2 */
 /*---------------------------------------------------------------------------*/
@@ -370,7 +454,6 @@ serial_init_UART(serial_dev_t *dev)
       cts_port = AF_USART0_CTS_PORT(bus_config->cts_loc);
       cts_pin = AF_USART0_CTS_PIN(bus_config->cts_loc);
     }
-    dev_on_uart0 = dev;
   }
   else if(bus_config->SPI_UART_USARTx == USART1) {
     CMU_ClockEnable(cmuClock_USART1, true);
@@ -384,7 +467,6 @@ serial_init_UART(serial_dev_t *dev)
       cts_port = AF_USART1_CTS_PORT(bus_config->cts_loc);
       cts_pin = AF_USART1_CTS_PIN(bus_config->cts_loc);
     }
-    dev_on_uart1 = dev;
   }
   else if(bus_config->SPI_UART_USARTx == USART2) {
     CMU_ClockEnable(cmuClock_USART2, true);
@@ -398,12 +480,13 @@ serial_init_UART(serial_dev_t *dev)
       cts_port = AF_USART2_CTS_PORT(bus_config->cts_loc);
       cts_pin = AF_USART2_CTS_PIN(bus_config->cts_loc);
     }
-    dev_on_uart2 = dev;
   }
   else {
-    PRINTF("UART (%s): interface not supported!\n", __func__);
+    LOG_ERR("UART (%s): interface not supported!\n", __func__);
     return BUS_INVALID;
   }
+  /* register the device for interrupt dispatch */
+  uart_devs[serial_uart_index(bus_config->SPI_UART_USARTx)] = dev;
   /* Configure GPIO pin, To avoid false start, configure TX pin as initial high */
   GPIO_PinModeSet(tx_port, tx_pin, gpioModePushPull, 1);
   if(bus_config->uart_mode != UART_MODE_TX_ONLY) {
@@ -532,7 +615,7 @@ serial_arch_lock(serial_dev_t *dev)
     if(dev->timeout_ms && timer_timedout(&bus_config->bus_timer)) {
       serial_arch_unlock(dev);
     } else {
-      PRINTF("Serial bus (%s): bus is locked\n", __func__);
+      LOG_DBG("Serial bus (%s): bus is locked\n", __func__);   /* normal contention, the caller retries */
       return BUS_LOCKED;
     }
   }
@@ -550,7 +633,7 @@ serial_arch_lock(serial_dev_t *dev)
         bus_status = serial_init_UART(dev);
       break;
       default:
-        PRINTF("Serial bus (%s): wrong bus type\n", __func__);
+        LOG_ERR("Serial bus (%s): wrong bus type\n", __func__);
         bus_status = BUS_INVALID;
       break;
     }
@@ -587,24 +670,27 @@ serial_arch_unlock(serial_dev_t *dev)
         break;
         case BUS_TYPE_SPI:
         case BUS_TYPE_UART:
+          if(bus_config->type == BUS_TYPE_UART && bus_config->rx_dma_buff != NULL) {
+            dma_arch_stop(bus_config->rx_dma_channel);
+          }
+          if(bus_config->type == BUS_TYPE_UART) {
+            uart_devs[serial_uart_index(bus_config->SPI_UART_USARTx)] = NULL;
+          }
           /* Reset the SPI controller */
           USART_Reset(dev->bus->config.SPI_UART_USARTx);
           /* turn off clocks to reduce power consumption */
           if(bus_config->SPI_UART_USARTx == USART0) {
             CMU_ClockEnable(cmuClock_USART0, false);
-            dev_on_uart0 = NULL;
           }
           if(bus_config->SPI_UART_USARTx == USART1) {
             CMU_ClockEnable(cmuClock_USART1, false);
-            dev_on_uart1 = NULL;
           }
           if(bus_config->SPI_UART_USARTx == USART2) {
             CMU_ClockEnable(cmuClock_USART2, false);
-            dev_on_uart2 = NULL;
           }
         break;
         default:
-          PRINTF("Serial bus (%s): wrrong bus typr\n", __func__);
+          LOG_ERR("Serial bus (%s): wrong bus type\n", __func__);
         break;
       } 
     } else {
@@ -722,7 +808,7 @@ serial_arch_transfer(serial_dev_t *dev, const uint8_t *wdata,
         break;
         
         default:
-          PRINTF("Serial bus (%s): wrong bus type\n", __func__);
+          LOG_ERR("Serial bus (%s): wrong bus type\n", __func__);
       }
     } else {
       return BUS_NOT_OWNED;
@@ -743,16 +829,79 @@ serial_arch_write(serial_dev_t *dev, const uint8_t *data, uint16_t len)
   return serial_arch_transfer(dev, data, len, NULL, 0);
 }
 /*---------------------------------------------------------------------------*/
+static bool
+serial_uart_start_rx_dma(serial_dev_t *dev)
+{
+  serial_bus_config_t *bus_config = &dev->bus->config;
+  USART_TypeDef *uart = bus_config->SPI_UART_USARTx;
+  LDMA_PeripheralSignal_t signal;
+  uint8_t idle_bits = bus_config->rx_idle_bits ? bus_config->rx_idle_bits : SERIAL_UART_RX_IDLE_BITS;
+
+  if(uart == USART0) {
+    signal = ldmaPeripheralSignal_USART0_RXDATAV;
+  } else if(uart == USART1) {
+    signal = ldmaPeripheralSignal_USART1_RXDATAV;
+#ifdef USART2
+  } else if(uart == USART2) {
+    signal = ldmaPeripheralSignal_USART2_RXDATAV;
+#endif  /* USART2 */
+  } else {
+    return false;
+  }
+  bus_config->rx_dma_tail = 0;
+  if(!dma_arch_start_p2m_loop(bus_config->rx_dma_channel, signal, &uart->RXDATA, bus_config->rx_dma_buff,
+                              bus_config->rx_dma_buff_size, uart_rx_dma_callback, dev)) {
+    return false;
+  }
+  /* Timer compare 1 is started at the end of every received frame and stopped by
+   * the next start bit. It reaches the compare value only if the line stays idle */
+  uart->TIMECMP1 = ((uint32_t)idle_bits << _USART_TIMECMP1_TCMPVAL_SHIFT)
+                   | USART_TIMECMP1_TSTART_RXEOF | USART_TIMECMP1_TSTOP_RXACT | USART_TIMECMP1_RESTARTEN;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
 void
 serial_arch_enable_rx(serial_dev_t *dev)
 {
-  /* Clear Framing err, parity err and RX overflow err flags */
-  USART_IntClear(dev->bus->config.SPI_UART_USARTx, USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF);
+  serial_bus_config_t *bus_config = &dev->bus->config;
+  uint32_t rx_flags = USART_IF_RXDATAV;
+  /* Clear Framing err, parity err, RX overflow err and idle timer flags */
+  USART_IntClear(bus_config->SPI_UART_USARTx, USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF | USART_IF_TCMP1);
   /* clear any pending NVIC interrupts */
-  serial_uart_NVIC_clear_interrupt(dev->bus->config.SPI_UART_USARTx, RX_NVIC);
-  /* Enable RX data available, framing, parity and overflow interrupt flags */
-  USART_IntEnable(dev->bus->config.SPI_UART_USARTx, USART_IF_RXDATAV | USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF);
+  serial_uart_NVIC_clear_interrupt(bus_config->SPI_UART_USARTx, RX_NVIC);
+  if(bus_config->rx_dma_buff != NULL && bus_config->input_block_handler != NULL) {
+    /* LDMA consumes RXDATAV, only the idle line interrupt is needed */
+    if(serial_uart_start_rx_dma(dev)) {
+      rx_flags = USART_IF_TCMP1;
+    } else {
+      LOG_ERR("UART (%s): failed to start RX DMA\n", __func__);
+    }
+  }
+  /* Enable RX data available or idle, framing, parity and overflow interrupt flags */
+  USART_IntEnable(bus_config->SPI_UART_USARTx, rx_flags | USART_IF_FERR | USART_IF_PERR | USART_IF_RXOF);
   /* Enable RX NVIC interrupt request */
-  serial_uart_NVIC_interrupt(dev->bus->config.SPI_UART_USARTx, RX_NVIC, true);
+  serial_uart_NVIC_interrupt(bus_config->SPI_UART_USARTx, RX_NVIC, true);
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_arch_enable_tx(serial_dev_t *dev)
+{
+  /* TXBL interrupt is raised right away if there is space in TX buffer */
+  USART_IntEnable(dev->bus->config.SPI_UART_USARTx, USART_IF_TXBL);
+  /* Enable TX NVIC interrupt request */
+  serial_uart_NVIC_interrupt(dev->bus->config.SPI_UART_USARTx, TX_NVIC, true);
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_arch_get_rx_stats(serial_dev_t *dev, uart_rx_stats_t *stats)
+{
+  ATOMIC_SECTION(*stats = dev->bus->config.rx_stats;);
+}
+/*---------------------------------------------------------------------------*/
+bool
+serial_arch_has_rx_dma(serial_dev_t *dev)
+{
+  return dev->bus->config.type == BUS_TYPE_UART && dev->bus->config.rx_dma_buff != NULL
+         && dev->bus->config.rx_dma_buff_size != 0;
 }
 /*---------------------------------------------------------------------------*/
@@ -10,10 +10,12 @@
 #include "timer.h"
 #include "clock.h"
 #include "common-arch.h"
+#include "dma-arch.h"
 
 #define SERIAL_BUS_DEFAULT_TIMEOUT_MS   250     /* default bus timeout of 500 mseconds */
 #define SERIAL_UART_DEFAUT_BAUDRATE     115200
 #define SERIAL_SPI_DEFAUT_SPEED         4000000
+#define SERIAL_UART_RX_IDLE_BITS        20      /* default idle time in bit times (2 frames) which ends an RX burst in LDMA mode. Max 255 */
 #define CHIP_SELECT_ENABLE 0
 #define CHIP_SELECT_DISBALE 1
 
@@ -29,6 +31,14 @@ typedef enum {
   UART_MODE_TX_RX_FLOW = 2
 } uart_mode_t;
 
+typedef struct uart_rx_stats {
+  uint32_t framing_errors;                      /* number of frames received with framing error */
+  uint32_t parity_errors;                       /* number of frames received with parity error */
+  uint32_t overflow_errors;                     /* number of RX buffer overflows */
+  uint32_t bursts;                              /* number of input_block_handler calls in LDMA mode */
+  uint32_t bytes;                               /* number of bytes delivered in LDMA mode */
+} uart_rx_stats_t;
+
 typedef struct serial_bus_config {
   const uint32_t data_in_loc;                   /* SPI:MISO, I2C:SDA, UART:MCU RX */
   const uint32_t data_out_loc;                  /* SPI:MOSI, I2C:SDA, UART:MCU TX */
@@ -41,8 +51,16 @@ typedef struct serial_bus_config {
   const uint32_t rts_loc;                       /* uart signal ready to send */
   I2C_TypeDef *I2Cx;                            /* pointer to I2C bus address */
   USART_TypeDef *SPI_UART_USARTx;               /* pointer to SPI/USART/UART bus address */
-  void (* input_handler)(uint8_t c);            /* input handler, RX interrupt handler */
-  uint8_t (* output_handler)(void);             /* output handler, TX interrupt handler */
+  void (* input_handler)(void *ctx, uint8_t c); /* input handler, RX interrupt handler */
+  bool (* output_handler)(void *ctx, uint8_t *c); /* output handler, TX interrupt handler. Returns false when there is nothing to send */
+  void (* input_block_handler)(void *ctx, const uint8_t *data, uint16_t len);  /* input handler for LDMA RX mode, called once per burst */
+  void *handler_ctx;                            /* context passed to input, input block and output handlers e.g. owning guart instance */
+  uint8_t *rx_dma_buff;                         /* UART RX circular buffer filled by LDMA. NULL for interrupt per byte RX */
+  uint16_t rx_dma_buff_size;                    /* size of rx_dma_buff */
+  uint8_t rx_dma_channel;                       /* LDMA channel used for RX */
+  uint8_t rx_idle_bits;                         /* RX idle time in bit times which ends a burst, 0 for SERIAL_UART_RX_IDLE_BITS */
+  volatile uint16_t rx_dma_tail;                /* index of next byte in rx_dma_buff to be delivered */
+  uart_rx_stats_t rx_stats;                     /* RX error and burst counters */
   USART_ClockMode_TypeDef clock_mode;           /* SPI clock mode, e.g. idle low, sample on rising edge */
   bool msb_first;                               /* MSB goes out first */
   ttimer_t bus_timer;                           /* timer for the bus used in bus timeout */
@@ -3,7 +3,10 @@
  * @author Varun Marolia
  * @brief This file contains arch specific methods for using Serial wire output 
  *        (SWO) for debugging. In order to use this the USE_SWO_DEBUG must be
- *        defined in the project configuration/Make file.
+ *        defined in the project configuration/Make file. USE_SWO_DEBUG routes
+ *        stdout to ITM port 0, USE_SWO_TRACE only enables the non blocking
+ *        trace channels (log, telemetry, profiler and ISR markers) and
+ *        leaves stdout on the uart.
  * 
  * @copyright Copyright (c) 2025 Varun Marolia
  *   MIT License
@@ -32,11 +35,14 @@
 #include "board.h"
 #include "swo_debug.h"
 #include "stdio-op.h"
+#include "atomic.h"
+#include <stddef.h>
 
 /*!
  \todo SWO output is not working!
  */
-#ifdef USE_SWO_DEBUG
+#if defined(USE_SWO_DEBUG) || defined(USE_SWO_TRACE)
+static volatile uint32_t swo_dropped[SWO_CHANNEL_COUNT];   /* bytes dropped per channel */
 /*---------------------------------------------------------------------------*/
 void 
 SWO_init(void)
@@ -58,15 +64,15 @@ SWO_init(void)
   CMU_AUXHFRCOBandSet(cmuAUXHFRCOFreq_4M0Hz);
   /* Enable trace in core debug. Must be enabled before using ITM */
   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
-  //div  = (CMU_ClockFreqGet(cmuClock_DBG) + (SWO_DEBUG_DEFAULT_CLOCK_HZ / 2)) / SWO_DEBUG_DEFAULT_CLOCK_HZ;
-  div = (4000000 / SWO_DEBUG_DEFAULT_CLOCK_HZ) - 1;
+  /* SWO bit rate = trace clock / (ACPR + 1) */
+  div = 4000000 / SWO_DEBUG_DEFAULT_CLOCK_HZ;
   TPIU->SPPR = 2;            /* set protocol to NRZ */
-  TPIU->ACPR = div -1;       /* Scale the baud rate of the asynchronous output */
+  TPIU->ACPR = div - 1;      /* Scale the baud rate of the asynchronous output */
   ITM->LAR  = 0xC5ACCE55;    /* Unlock ITM and output data */
   ITM->TCR  = (ITM_TCR_TRACEBUSID_Msk | ITM_TCR_DWTENA_Msk| ITM_TCR_SWOENA_Msk 
               | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk); /* ITM Trace Control Register */
   ITM->TPR  = ITM_TPR_PRIVMASK_Msk; /* ITM Trace Privilege Register make channel 0 accessible by user code*/
-  ITM->TER  = 0x1;          /* ITM Trace Enable Register. Enabled tracing on stimulus ports. One bit per stimulus port. */
+  ITM->TER  = (1UL << SWO_CHANNEL_COUNT) - 1;  /* ITM Trace Enable Register. One bit per stimulus port, enable log, telemetry, profile and ISR ports */
   DWT->CTRL = 0x400003FE;
   TPIU->FFCR = 0x00000100;
 }
@@ -81,10 +87,117 @@ SWO_flush(void)
   }
 }
 /*---------------------------------------------------------------------------*/
+static bool
+SWO_channel_enabled(uint8_t channel)
+{
+  return channel < SWO_CHANNEL_COUNT
+         && (ITM->TCR & ITM_TCR_ITMENA_Msk) != 0UL
+         && (ITM->TER & (1UL << channel)) != 0UL;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+SWO_write_nb(uint8_t channel, const uint8_t *data, uint16_t len)
+{
+  uint16_t i = 0;
+  uint32_t word;
+  bool written = true;
+  if(data == NULL || !SWO_channel_enabled(channel)) {
+    return 0;
+  }
+  while(i < len && written) {
+    written = false;
+    /* the ISR markers share the ITM, an interrupt between the check and the write
+       could take the free slot and the write would be lost */
+    ATOMIC_SECTION(
+      /* reading the stimulus port returns 1 when its FIFO slot is free */
+      if(ITM->PORT[channel].u32 != 0UL) {
+        written = true;
+        if(len - i >= 4) {
+          /* ITM is little endian, the host sees the bytes in order */
+          word = (uint32_t)data[i] | ((uint32_t)data[i + 1] << 8)
+                 | ((uint32_t)data[i + 2] << 16) | ((uint32_t)data[i + 3] << 24);
+          ITM->PORT[channel].u32 = word;
+          i += 4;
+        } else {
+          ITM->PORT[channel].u8 = data[i];
+          i++;
+        }
+      }
+    );
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+bool
+SWO_write_u8_nb(uint8_t channel, uint8_t value)
+{
+  bool written = false;
+  if(!SWO_channel_enabled(channel)) {
+    return false;
+  }
+  ATOMIC_SECTION(
+    if(ITM->PORT[channel].u32 != 0UL) {
+      ITM->PORT[channel].u8 = value;
+      written = true;
+    }
+  );
+  if(!written) {
+    swo_dropped[channel]++;
+  }
+  return written;
+}
+/*---------------------------------------------------------------------------*/
+bool
+SWO_write_u32_nb(uint8_t channel, uint32_t value)
+{
+  bool written = false;
+  if(!SWO_channel_enabled(channel)) {
+    return false;
+  }
+  ATOMIC_SECTION(
+    if(ITM->PORT[channel].u32 != 0UL) {
+      ITM->PORT[channel].u32 = value;
+      written = true;
+    }
+  );
+  if(!written) {
+    swo_dropped[channel] += 4;
+  }
+  return written;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+SWO_get_dropped(uint8_t channel)
+{
+  if(channel >= SWO_CHANNEL_COUNT) {
+    return 0;
+  }
+  return swo_dropped[channel];
+}
+/*---------------------------------------------------------------------------*/
+void
+SWO_isr_marker(bool exit)
+{
+  /* IPSR holds the exception number, external interrupts start at 16 */
+  uint32_t exception = __get_IPSR();
+  uint8_t marker;
+  if(exception < 16) {
+    return;
+  }
+  marker = (uint8_t)((exception - 16) & 0x7F);
+  if(exit) {
+    marker |= SWO_ISR_EXIT_FLAG;
+  }
+  SWO_write_u8_nb(SWO_CHANNEL_ISR, marker);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* defined(USE_SWO_DEBUG) || defined(USE_SWO_TRACE) */
+#ifdef USE_SWO_DEBUG
 #undef stdio_put_char_bw
 void
 stdio_put_char_bw(char c)
 {
-  ITM_SendChar(c);
+  /* log text never waits for the probe, a full FIFO drops the character and counts it */
+  SWO_write_u8_nb(SWO_CHANNEL_LOG, (uint8_t)c);
 }
 #endif /* USE_SWO_DEBUG */
@@ -1,7 +1,51 @@
 #ifndef _SWO_H_
 #define _SWO_H_
+#include <stdint.h>
+#include <stdbool.h>
 
 #define SWO_DEBUG_DEFAULT_CLOCK_HZ 1000000
+
+/* ITM stimulus port assignment */
+#define SWO_CHANNEL_LOG           0   /* log text, also stdout under USE_SWO_DEBUG, drops when full */
+#define SWO_CHANNEL_TELEMETRY     1   /* COBS framed binary telemetry */
+#define SWO_CHANNEL_PROFILE       2   /* profiler events, 32 bit words: id:8 | value:24 */
+#define SWO_CHANNEL_ISR           3   /* ISR markers, 8 bit: bit 7 set on exit, bits 6..0 IRQ number */
+#define SWO_CHANNEL_COUNT         4
+
+#define SWO_ISR_EXIT_FLAG         0x80
+
+#if defined(USE_SWO_DEBUG) || defined(USE_SWO_TRACE)
+#define SWO_TRACE_ENABLED         1
 void SWO_init(void);
 void SWO_flush(void);
+/*!
+* \fn     uint16_t SWO_write_nb(uint8_t channel, const uint8_t *data, uint16_t len)
+* \brief  Function writes data on given ITM stimulus port without waiting. Data is written
+*         in 32 bit words where possible. Writing stops at the first full FIFO slot, the
+*         caller keeps the remaining bytes and writes them later, e.g. from a poll loop.
+* \param  channel ITM stimulus port, see SWO_CHANNEL_x.
+* \param  data pointer to data.
+* \param  len number of bytes.
+* \return Function returns number of bytes written.
+*/
+uint16_t SWO_write_nb(uint8_t channel, const uint8_t *data, uint16_t len);
+bool SWO_write_u8_nb(uint8_t channel, uint8_t value);
+bool SWO_write_u32_nb(uint8_t channel, uint32_t value);
+/*!
+* \fn     uint32_t SWO_get_dropped(uint8_t channel)
+* \brief  Function returns number of bytes dropped on given channel as the ITM FIFO was full.
+*         Only the single value writes drop, SWO_write_nb leaves the rest to the caller.
+*/
+uint32_t SWO_get_dropped(uint8_t channel);
+void SWO_isr_marker(bool exit);
+
+#define SWO_ISR_ENTER()                 SWO_isr_marker(false)
+#define SWO_ISR_EXIT()                  SWO_isr_marker(true)
+#define SWO_PROFILE_EVENT(id, value)    SWO_write_u32_nb(SWO_CHANNEL_PROFILE, ((uint32_t)(id) << 24) | ((value) & 0x00FFFFFF))
+#else   /* defined(USE_SWO_DEBUG) || defined(USE_SWO_TRACE) */
+#define SWO_TRACE_ENABLED         0
+#define SWO_ISR_ENTER()
+#define SWO_ISR_EXIT()
+#define SWO_PROFILE_EVENT(id, value)
+#endif  /* defined(USE_SWO_DEBUG) || defined(USE_SWO_TRACE) */
 #endif /* _SWO_H_ */
@@ -28,30 +28,28 @@
 #include "watchdog-arch.h"
 #include "watchdog.h"
 #include <em_wdog.h>
+#include <em_rmu.h>
 
-#if defined DEBUG
-#include <stdio.h>
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)
-#endif  /* defined DEBUG */
+#define LOG_MODULE LOG_MODULE_WATCHDOG
+#include "log.h"
 
+#define WDOG_WARNING_MAGIC      0x57444F47    /* "WDOG", wdog_warning_pc holds a saved PC */
+
+/* where the last warning hit. Kept in noinit RAM over the watchdog reset that follows it when
+   the main loop hangs, reported by watchdog_feed() before or after that reset */
+static volatile uint32_t wdog_warning_pc __attribute__((section(".noinit")));
+static volatile uint32_t wdog_warning_magic __attribute__((section(".noinit")));
+static bool wdog_reset = false;               /* the last reset was a watchdog timeout */
 /*---------------------------------------------------------------------------*/
 static void __attribute__((used))
 wdog_isr_handler(uint32_t sp)
 {
-#if DEBUG
-  uint32_t irq_flags;
-  uint32_t pc;
-  pc = *(uint32_t *)(sp + 24);  /* Address where wdog IRQ occured is on the stack */
-  irq_flags = WDOGn_IntGet(WDOG0);
-  if(irq_flags & WDOG_IF_WARN) {
-    PRINTF("WDOG: Warning @ 0x%08lx\n", pc);
-  }
-  if(irq_flags & WDOG_IF_TOUT) {
-    PRINTF("WDOG: Timeout @ 0x%08lx\n", pc);
+  /* no printf from the interrupt, the next watchdog_feed reports the warning, after the reset
+     if the main loop does not come back */
+  if(WDOGn_IntGet(WDOG0) & WDOG_IF_WARN) {
+    wdog_warning_pc = *(uint32_t *)(sp + 24);  /* Address where wdog IRQ occured is on the stack */
+    wdog_warning_magic = WDOG_WARNING_MAGIC;
   }
-#endif  /* DEBUG */
   /* clear irq */
   WDOGn_IntClear(WDOG0, WDOG_IF_TOUT | WDOG_IEN_WARN);  /* clear any pending interrupts */
 }
@@ -90,6 +88,12 @@ watchdog_init(wdog_time_t wdtime)
 {
   WDOG_Init_TypeDef wdog_init = WDOG_INIT_DEFAULT;
   
+  /* a saved warning is valid only over a watchdog reset, the causes add up until cleared */
+  wdog_reset = (RMU_ResetCauseGet() & RMU_RSTCAUSE_WDOGRST) != 0;
+  RMU_ResetCauseClear();
+  if(!wdog_reset) {
+    wdog_warning_magic = 0;
+  }
   wdog_init.enable = false;
   wdog_init.debugRun = false;           /* don't run during degbugging */
   wdog_init.em2Run = false;             /* don't run in EM2 and EM3 LP modes */
@@ -124,6 +128,11 @@ void
 watchdog_feed(void)
 {
   WDOGn_Feed(WDOG0);
+  if(wdog_warning_magic == WDOG_WARNING_MAGIC) {
+    wdog_warning_magic = 0;
+    LOG_WARN("WDOG: Warning @ 0x%08lx%s\n", wdog_warning_pc, wdog_reset ? ", reset" : "");
+  }
+  wdog_reset = false;
 }
 /*---------------------------------------------------------------------------*/
 void 
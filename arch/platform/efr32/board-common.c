@@ -79,12 +79,10 @@ print_chip_info(void)
 }
 /*---------------------------------------------------------------------------*/
 uint32_t
-board_read_voltage_divider_mv(adc_dev_t *dev, uint32_t r1, uint32_t r2)
+board_voltage_divider_mv(uint32_t adc_uv, uint32_t r1, uint32_t r2)
 {
-  uint32_t adc_uv = 0;
   uint64_t mv = 0;
-  if(dev && r2) {
-    adc_dev_read_microvolts(dev, &adc_uv);
+  if(r2) {
     mv = adc_uv / 1000; /* convert into millivolts */
     mv *= (r1 + r2);
     mv /= r2;         /* voltage divider ratio */
@@ -92,4 +90,14 @@ board_read_voltage_divider_mv(adc_dev_t *dev, uint32_t r1, uint32_t r2)
   return (uint32_t)mv;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+board_read_voltage_divider_mv(adc_dev_t *dev, uint32_t r1, uint32_t r2)
+{
+  uint32_t adc_uv = 0;
+  if(dev && r2) {
+    adc_dev_read_microvolts(dev, &adc_uv);
+  }
+  return board_voltage_divider_mv(adc_uv, r1, r2);
+}
+/*---------------------------------------------------------------------------*/
 
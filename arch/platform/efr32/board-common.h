@@ -16,4 +16,5 @@ void led_sys_set(gpio_port_t port, uint8_t pin, uint8_t on_off);
 void led_sys_blink(gpio_port_t port, uint8_t pin, uint8_t times, uint32_t delay_ms);
 void print_chip_info(void);
 uint32_t board_read_voltage_divider_mv(adc_dev_t *dev, uint32_t r1, uint32_t r2);
+uint32_t board_voltage_divider_mv(uint32_t adc_uv, uint32_t r1, uint32_t r2);
 #endif /* _BOARD_COMMON_H_ */
@@ -50,9 +50,9 @@ platform_init(void)
 {
   CHIP_Init();    /* Initialize the chip */
   board_init();   /* this will setup and select 38.4MHz Xtal and configure LEDs and button IO pins */
-#ifdef USE_SWO_DEBUG
+#if SWO_TRACE_ENABLED
   SWO_init();
-#endif  /* USE_SWO_DEBUG */
+#endif  /* SWO_TRACE_ENABLED */
   clock_init();                       /* Initialize clock */
   RESET_BUTTON.callback = reset_button_handler;  /* Set callback function for reset button */
   gpio_interrupt(&RESET_BUTTON, true);  /* Enable GPIO interrupt for reset button */
@@ -48,6 +48,7 @@ serial_dev_t SHT4X_DEV = {
   .cs_config    = NULL
 };  /**< sht4x temp-humidity sensor is an i2c device */
 /*---------------------------------------------------------------------------*/
+static uint8_t generic_uart_rx_dma_buff[UART_RX_DMA_BUFF_SIZE];
 serial_bus_t generic_uart_bus = {
   .lock = false,
   .current_dev = NULL,
@@ -59,6 +60,11 @@ serial_bus_t generic_uart_bus = {
     .uart_mode = UART_MODE_TX_RX,
     .input_handler = NULL,
     .output_handler = NULL,
+    .input_block_handler = NULL,
+    .rx_dma_buff = generic_uart_rx_dma_buff,
+    .rx_dma_buff_size = UART_RX_DMA_BUFF_SIZE,
+    .rx_dma_channel = DMA_ARCH_CHANNEL_UART_RX,
+    .rx_idle_bits = SERIAL_UART_RX_IDLE_BITS,
     .type = BUS_TYPE_UART,
     .I2Cx = NULL,
     .SPI_UART_USARTx = UART_USART
@@ -80,11 +86,23 @@ adc_config_t ntc_hrv_config = {
   .pos_input = HA_NTC_ADC_INPUT,
   .neg_input = adcNegSelVSS
 };
+/* the heater switching couples spikes into the NTC line, raw ADC codes (about 45 per 'C at 25 'C).
+   Fed once per acquisition cycle (ACQUISITION_PERIOD_MS) by acquisition_read_adc(). At that rate a
+   spike hits single samples: up to 2 in a row are held, a real step passes after 2 s and the
+   light EMA settles it within 4 s, see tools/adc_filter_bench.c */
+static const filter_cfg_t ntc_hrv_filter_cfg = {
+  .stage = {
+    { .type = FILTER_OUTLIER, .param = 100, .hold = 3 },
+    { .type = FILTER_EMA, .param = FILTER_ALPHA_ONE * 3 / 4 }
+  }
+};
+static filter_t ntc_hrv_filter = { .cfg = &ntc_hrv_filter_cfg };
 adc_dev_t ntc_ha_adc = {
-  .adc_avg_samples = 100,
+  .adc_avg_samples = 128,                /* power of 2, averaged by the ADC oversampling */
   .power_up_delay_ms = 0,
   .adc_config = &ntc_hrv_config,
-  .adc_dev_enable = NULL
+  .adc_dev_enable = NULL,
+  .filter = &ntc_hrv_filter
 };
 /*---------------------------------------------------------------------------*/
 /* on board NTC 100K sensor */
@@ -95,7 +113,7 @@ adc_config_t ntc_board_config = {
   .neg_input = adcNegSelVSS
 };
 adc_dev_t BOARD_NTC_ADC_DEV = {
-  .adc_avg_samples = 10,
+  .adc_avg_samples = 16,
   .power_up_delay_ms = 0,
   .adc_config = &ntc_board_config,
   .adc_dev_enable = NULL
@@ -109,7 +127,7 @@ adc_config_t supply_board_config = {
   .neg_input = adcNegSelVSS
 };
 adc_dev_t BOARD_SUPPLY_ADC_DEV = {
-  .adc_avg_samples = 10,
+  .adc_avg_samples = 16,
   .power_up_delay_ms = 0,
   .adc_config = &supply_board_config,
   .adc_dev_enable = NULL
@@ -123,7 +141,7 @@ adc_config_t fan_12v_config = {
   .neg_input = adcNegSelVSS
 };
 adc_dev_t FAN_12V_ADC_DEV = {
-  .adc_avg_samples = 10,
+  .adc_avg_samples = 16,
   .power_up_delay_ms = 0,
   .adc_config = &fan_12v_config,
   .adc_dev_enable = NULL
@@ -178,6 +196,17 @@ gpio_interrupt_t MODE_BUTTON = {
   .pulse_time_ms = 0,
   .callback = NULL
 };
+gpio_interrupt_t FAN_TECHO_INTERRUPT = {
+  .pin = FAN_TECHO_PIN,
+  .port = FAN_TECHO_PORT,
+  .gpio_mode = GPIO_MODE_INPUT_INTERNAL_PULL_UP, /* open collector techo output */
+  .debouncing_time_ms = 0,
+  .int_mode = GPIO_INTERRUPT_MODE_FALLING_EDGE,
+  .int_no = FAN_TECHO_PIN,
+  .low_power_interrupt = false,
+  .pulse_time_ms = 0,
+  .callback = NULL                              /* set by fan_blower_init() */
+};
 /*---------------------------------------------------------------------------*/
 void
 board_init(void) {
@@ -32,6 +32,7 @@
 #define UART_MCU_TX_LOC       _USART_ROUTELOC0_RXLOC_LOC6
 
 #define UART_GENERIC_DEV        guart_dev
+#define UART_RX_DMA_BUFF_SIZE   256     /* LDMA RX circular buffer, ~2 ms of data at 1.2 Mbps */
 
 #define SWO_DEBUG_LOC                 GPIO_ROUTELOC0_SWVLOC_LOC3    /* PC11 */
 
@@ -66,6 +67,7 @@
 #define FAN_PWM_ROUTE_LOC            _TIMER_ROUTELOC0_CC0LOC_LOC1 /* Timer 0 CC0 PA1 */
 #define FAN_TECHO_PORT               GPIO_PORT_A
 #define FAN_TECHO_PIN                2
+#define FAN_TECHO_INTERRUPT          fan_techo_interrupt
 #define FAN_PWM_DEV                  fan_dev
 #define FAN_DIR_FORWARD              1          /* exhaust */
 #define FAN_DIR_REVERSE              0          /* inlet */
@@ -78,6 +80,8 @@
 
 #define BOARD_ADC_PER                ADC0
 #define BOARD_ADC_REF_mVDD           3000  /* 3 Volts onboard regulator output of Akashvani */
+/* offset of both references. VDD keeps the factory gain, it also feeds the ratiometric NTC dividers */
+#define BOARD_ADC_CAL_REFS           { { adcRef2V5, adcPosSelVSS }, { adcRefVDD, adcPosSelVSS } }
 
 #define I2C_BUS_DATA_PORT             GPIO_PORT_A
 #define I2C_BUS_DATA_PIN              5
@@ -105,6 +109,7 @@ extern pwm_dev_t HA_HEATER_DEV;
 extern serial_dev_t UART_GENERIC_DEV;
 extern gpio_interrupt_t RESET_BUTTON;
 extern gpio_interrupt_t MODE_BUTTON;
+extern gpio_interrupt_t FAN_TECHO_INTERRUPT;
 
 /* common board and platform functions */
 void board_init(void);
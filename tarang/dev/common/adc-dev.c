@@ -27,6 +27,67 @@
 
 #include "adc-dev.h"
 #include "clock.h"
+#include "atomic.h"
+
+/* completion of the running asynchronous read, one single read runs at a time */
+static adc_dev_callback_t adc_dev_callback;
+static void *adc_dev_ctx;
+/*---------------------------------------------------------------------------*/
+/* switches the device on and waits until it settled. A device in a power domain only pays the
+   settling time when its window was not open yet */
+static void
+adc_dev_power_up(adc_dev_t *dev)
+{
+  if(dev->power_domain) {
+    adc_power_domain_open(dev->power_domain);
+    adc_power_domain_wait(dev->power_domain);
+    return;
+  }
+  /* check if device needs to be enabled */
+  if(dev->adc_dev_enable) {
+    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_ENABLE);
+    /* wait for power up delay time */
+    if(dev->power_up_delay_ms) {
+      clock_wait_ms(dev->power_up_delay_ms);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* switches the device on without waiting, the first call opens the window. Returns true once
+   the device settled */
+static bool
+adc_dev_power_settled(adc_dev_t *dev)
+{
+  if(!dev->powering) {
+    dev->powering = true;
+    if(dev->power_domain) {
+      adc_power_domain_open(dev->power_domain);
+      if(!adc_power_domain_settled(dev->power_domain)) {
+        dev->power_domain->stats.settle_waits++;
+      }
+    } else if(dev->adc_dev_enable) {
+      adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_ENABLE);
+      timer_set(&dev->power_timer, dev->power_up_delay_ms);
+    }
+  }
+  if(dev->power_domain) {
+    return adc_power_domain_settled(dev->power_domain);
+  }
+  if(dev->adc_dev_enable && dev->power_up_delay_ms) {
+    return timer_timedout(&dev->power_timer);
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+static void
+adc_dev_power_down(adc_dev_t *dev)
+{
+  if(dev->power_domain) {
+    adc_power_domain_close(dev->power_domain);
+  } else if(dev->adc_dev_enable) {
+    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_DISABLE);
+  }
+}
 /*---------------------------------------------------------------------------*/
 adc_status_t 
 adc_dev_init(adc_dev_t *dev)
@@ -41,47 +102,253 @@ adc_dev_init(adc_dev_t *dev)
 adc_status_t
 adc_dev_read_single(adc_dev_t *dev, uint32_t *adc_value)
 {
+  adc_status_t status;
+
   if(dev == NULL || dev->adc_config == NULL) {
     return ADC_INVALID;
   }
-  /* check if device needs to be enabled */
-  if(dev->adc_dev_enable) {
-    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_ENABLE);
-    /* wait for power up delay time */
-    if(dev->power_up_delay_ms) {
-      clock_wait_ms(dev->power_up_delay_ms);
-    }
-  }
+  adc_dev_power_up(dev);
   /* read ADC */
-  *adc_value = adc_arch_read_single(dev);
+  status = adc_arch_read_single(dev, adc_value);
   /* Disable the device */
-  if(dev->adc_dev_enable) {
-    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_DISABLE);
-  }
-  return ADC_OK;
+  adc_dev_power_down(dev);
+  return status;
 }
 /*---------------------------------------------------------------------------*/
 adc_status_t
 adc_dev_read_microvolts(adc_dev_t *dev, uint32_t *microvolts)
 {
+  adc_status_t status;
+
   if(dev == NULL || dev->adc_config == NULL) {
     return ADC_INVALID;
   }
-  /* check if device needs to be enabled */
-  if(dev->adc_dev_enable) {
-    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_ENABLE);
-    /* wait for power up delay time */
-    if(dev->power_up_delay_ms) {
-      clock_wait_ms(dev->power_up_delay_ms);
+  adc_dev_power_up(dev);
+  status = adc_arch_read_microvolts(dev, microvolts);
+  /* Disable the device */
+  adc_dev_power_down(dev);
+  return status;
+}
+/*---------------------------------------------------------------------------*/
+/* called from the ADC interrupt */
+static void
+adc_dev_read_done(adc_dev_t *dev, uint32_t adc_value, void *ctx)
+{
+  adc_dev_callback_t callback = adc_dev_callback;
+  (void)ctx;
+  adc_dev_power_down(dev);
+  if(callback) {
+    callback(dev, adc_value / ADC_OVS_SCALE, adc_dev_ctx);
+  }
+}
+/*---------------------------------------------------------------------------*/
+adc_status_t
+adc_dev_start(adc_dev_t *dev, adc_dev_callback_t callback, void *ctx)
+{
+  adc_status_t status;
+
+  if(dev == NULL || dev->adc_config == NULL) {
+    return ADC_INVALID;
+  }
+  if(adc_arch_busy()) {
+    return ADC_BUSY;
+  }
+  /* no waiting for the power up, the caller polls again until the device settled */
+  if(!adc_dev_power_settled(dev)) {
+    return ADC_BUSY;
+  }
+  adc_dev_callback = callback;
+  adc_dev_ctx = ctx;
+  status = adc_arch_start_single(dev, adc_dev_read_done, NULL);
+  if(status == ADC_BUSY) {
+    return status;    /* stays on, started by the next poll */
+  }
+  dev->powering = false;
+  if(status != ADC_OK) {
+    adc_dev_power_down(dev);
+  }
+  return status;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+adc_dev_filter(adc_dev_t *dev, uint32_t value)
+{
+  if(dev == NULL || dev->filter == NULL) {
+    return value;
+  }
+  return (uint32_t)filter_update(dev->filter, (int32_t)value);
+}
+/*---------------------------------------------------------------------------*/
+bool
+adc_dev_busy(void)
+{
+  return adc_arch_busy();
+}
+/*---------------------------------------------------------------------------*/
+const adc_sleep_stats_t *
+adc_dev_get_sleep_stats(void)
+{
+  return adc_arch_get_sleep_stats();
+}
+/*---------------------------------------------------------------------------*/
+adc_status_t
+adc_dev_scan_init(adc_scan_group_t *group)
+{
+  uint16_t samples = 0;
+  uint8_t i;
+
+  if(group == NULL || group->devs == NULL || group->dev_count == 0
+     || group->dev_count > ADC_SCAN_MAX_CHANNELS || group->buff == NULL) {
+    return ADC_INVALID;
+  }
+  for(i = 0; i < group->dev_count; i++) {
+    if(group->devs[i] == NULL || group->devs[i]->adc_config == NULL) {
+      return ADC_INVALID;
+    }
+    if(group->devs[i]->adc_avg_samples > samples) {
+      samples = group->devs[i]->adc_avg_samples;
     }
   }
-  *microvolts = adc_arch_read_microvolts(dev);
-  /* Disable the device */
-  if(dev->adc_dev_enable) {
-    adc_arch_dev_enable(dev->adc_dev_enable, ADC_DEV_DISABLE);
+  if(group->samples) {
+    samples = group->samples;
   }
-  return ADC_OK;
+  if(samples == 0) {
+    samples = ADC_DEFAULT_SAMPLES;
+  }
+  /* fit the scans into the buffer */
+  if(((uint32_t)samples * group->dev_count) > group->buff_size) {
+    samples = group->buff_size / group->dev_count;
+    if(samples == 0) {
+      return ADC_INVALID;
+    }
+  }
+  group->scan_samples = samples;
+  group->busy = false;
+  return adc_arch_scan_init(group);
+}
+/*---------------------------------------------------------------------------*/
+adc_status_t
+adc_dev_scan_start(adc_scan_group_t *group)
+{
+  if(group == NULL || group->scan_samples == 0) {
+    return ADC_INVALID;
+  }
+  if(group->busy) {
+    return ADC_BUSY;
+  }
+  return adc_arch_scan_start(group);
+}
+/*---------------------------------------------------------------------------*/
+adc_status_t
+adc_dev_scan_read(adc_scan_group_t *group)
+{
+  adc_status_t status;
+  uint32_t power_up_delay_ms = 0;
+  uint8_t i;
+
+  if(group == NULL || group->scan_samples == 0) {
+    return ADC_INVALID;
+  }
+  if(group->busy) {
+    return ADC_BUSY;
+  }
+  /* enable all the channels and wait once for the slowest one */
+  for(i = 0; i < group->dev_count; i++) {
+    if(group->devs[i]->power_domain) {
+      adc_power_domain_open(group->devs[i]->power_domain);
+    } else if(group->devs[i]->adc_dev_enable) {
+      adc_arch_dev_enable(group->devs[i]->adc_dev_enable, ADC_DEV_ENABLE);
+      if(group->devs[i]->power_up_delay_ms > power_up_delay_ms) {
+        power_up_delay_ms = group->devs[i]->power_up_delay_ms;
+      }
+    }
+  }
+  if(power_up_delay_ms) {
+    clock_wait_ms(power_up_delay_ms);
+  }
+  /* the domains settle in parallel, after the first wait the others are mostly done */
+  for(i = 0; i < group->dev_count; i++) {
+    if(group->devs[i]->power_domain) {
+      adc_power_domain_wait(group->devs[i]->power_domain);
+    }
+  }
+  status = adc_arch_scan_start(group);
+  if(status == ADC_OK) {
+    adc_arch_sleep_while(&group->busy);
+  }
+  for(i = 0; i < group->dev_count; i++) {
+    adc_dev_power_down(group->devs[i]);
+  }
+  return status;
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+adc_dev_scan_get_microvolts(adc_scan_group_t *group, uint8_t index)
+{
+  if(group == NULL || index >= group->dev_count) {
+    return 0;
+  }
+  return adc_arch_microvolts_from_raw(group->devs[index], group->result[index]);
+}
+/*---------------------------------------------------------------------------*/
+void
+adc_power_domain_open(adc_power_domain_t *domain)
+{
+  if(domain == NULL) {
+    return;
+  }
+  ATOMIC_SECTION(
+    if(domain->holds++ == 0) {
+      adc_arch_dev_enable(domain->enable, ADC_DEV_ENABLE);
+      timer_set(&domain->settle_timer, domain->settle_ms);
+      domain->stats.windows++;
+    }
+    domain->stats.opens++;
+  );
+}
 /*---------------------------------------------------------------------------*/
+void
+adc_power_domain_close(adc_power_domain_t *domain)
+{
+  uint32_t window_ms;
+
+  if(domain == NULL) {
+    return;
+  }
+  ATOMIC_SECTION(
+    if(domain->holds > 0 && --domain->holds == 0) {
+      adc_arch_dev_enable(domain->enable, ADC_DEV_DISABLE);
+      window_ms = (uint32_t)(clock_get_time_ms() - domain->settle_timer.start_time);
+      domain->stats.on_ms += window_ms;
+      if(window_ms > domain->stats.max_window_ms) {
+        domain->stats.max_window_ms = window_ms;
+      }
+    }
+  );
+}
+/*---------------------------------------------------------------------------*/
+void
+adc_power_domain_wait(adc_power_domain_t *domain)
+{
+  clock_time_t elapsed_ms;
+
+  if(domain == NULL || domain->holds == 0 || timer_timedout(&domain->settle_timer)) {
+    return;
+  }
+  domain->stats.settle_waits++;
+  elapsed_ms = clock_get_time_ms() - domain->settle_timer.start_time;
+  clock_wait_ms(domain->settle_timer.interval - elapsed_ms);
+}
+/*---------------------------------------------------------------------------*/
+bool
+adc_power_domain_settled(adc_power_domain_t *domain)
+{
+  return domain != NULL && domain->holds != 0 && timer_timedout(&domain->settle_timer);
+}
+/*---------------------------------------------------------------------------*/
+const adc_power_stats_t *
+adc_power_domain_get_stats(const adc_power_domain_t *domain)
+{
+  return (domain != NULL) ? &domain->stats : NULL;
+}
 /*---------------------------------------------------------------------------*/
@@ -1,8 +1,11 @@
 #ifndef _ADC_DEV_H_
 #define _ADC_DEV_H_
 
+#include <stdbool.h>
 #include "adc-arch.h"
 #include "common-arch.h"
+#include "filter.h"
+#include "timer.h"
 
 typedef enum adc_status {
   ADC_OK = 0,
@@ -10,20 +13,83 @@ typedef enum adc_status {
   ADC_INVALID = 2
 } adc_status_t;
 
+typedef struct adc_dev_stats {
+  uint32_t reads;                         /** completed reads */
+  uint32_t last_latency_us;               /** start to result time of the last read */
+  uint32_t max_latency_us;                /** longest start to result time */
+  uint64_t total_latency_us;              /** sum of the start to result times, divide by reads for the average */
+} adc_dev_stats_t;
+
+typedef struct adc_sleep_stats {
+  uint64_t wait_us;                       /** time the blocking reads and scans waited for the ADC */
+  uint64_t em1_us;                        /** part of the wait time the core slept in EM1, the rest is EM0 */
+  uint32_t sleeps;                        /** number of EM1 entries */
+} adc_sleep_stats_t;
+
+typedef struct adc_power_stats {
+  uint32_t windows;                       /** times the domain was switched on */
+  uint32_t opens;                         /** reads and batches that used the domain */
+  uint32_t settle_waits;                  /** opens that had to wait for the settling time */
+  uint64_t on_ms;                         /** time the domain was on, added when a window closes */
+  uint32_t max_window_ms;                 /** longest window */
+} adc_power_stats_t;
+
+/* devices that share an enable pin. The pin is switched on by the first open and off by the last
+   close, so a batch of reads or a whole acquisition cycle pays the settling time once */
+typedef struct adc_power_domain {
+  gpio_config_t *enable;                  /** enable pin shared by the devices of the domain */
+  const uint32_t settle_ms;               /** time from switch on until the outputs are valid */
+  volatile uint8_t holds;                 /** open windows, the pin is on while not 0 */
+  ttimer_t settle_timer;                  /** started at switch on, runs settle_ms */
+  adc_power_stats_t stats;
+} adc_power_domain_t;
+
 typedef struct adc_dev {
-  const uint16_t adc_avg_samples;         /** number of samples to take and average */
+  const uint16_t adc_avg_samples;         /** number of samples to take and average. Powers of 2 up to 4096 use the
+                                              hardware oversampling, other counts are averaged in software */
+  const bool adc_sw_average;              /** true to average in software even if the hardware can oversample */
   const uint32_t power_up_delay_ms;       /** power up delay in case the end device needs to be enabled before measurement, will be used by adc_dev_enable if assigned */
   /* arch specific variables */
   adc_config_t *adc_config;               /** Pointer to ADC configuration */
   gpio_config_t *adc_dev_enable;          /** pointer to GPIO port, pin to enable device before reading analogue signal */
+  adc_dev_stats_t stats;                  /** latency counters, updated when a read completes */
+  filter_t *filter;                       /** optional filter chain, applied by the owner of the sample stream
+                                              with adc_dev_filter(), in one unit. The reads return raw values */
+  adc_power_domain_t *power_domain;       /** optional power domain, used instead of adc_dev_enable and
+                                              power_up_delay_ms when set */
+  ttimer_t power_timer;                   /** power up delay of an asynchronous start, runs power_up_delay_ms */
+  bool powering;                          /** adc_dev_start switched the device on, the read has not started */
 } adc_dev_t; 
 
+/* called from the ADC interrupt when an asynchronous read completes. adc_value is the raw average */
+typedef void (* adc_dev_callback_t)(adc_dev_t *dev, uint32_t adc_value, void *ctx);
+/* arch level completion, adc_value is the average scaled by ADC_OVS_SCALE */
+typedef void (* adc_arch_callback_t)(adc_dev_t *dev, uint32_t adc_value, void *ctx);
+
+typedef struct adc_scan_group adc_scan_group_t;
+typedef void (* adc_scan_callback_t)(adc_scan_group_t *group, void *ctx);
+
+struct adc_scan_group {
+  adc_dev_t * const *devs;                /** channels of the group. All must use the same ADC peripheral and reference */
+  const uint8_t dev_count;                /** number of channels, max ADC_SCAN_MAX_CHANNELS */
+  const uint16_t samples;                 /** scans to take and average, 0 for the max adc_avg_samples of the channels */
+  uint32_t *buff;                         /** DMA buffer, samples x dev_count words */
+  const uint16_t buff_size;               /** size of the buffer in words */
+  adc_scan_callback_t callback;           /** called from interrupt when the results are ready, can be NULL */
+  void *ctx;                              /** context passed to the callback */
+  volatile bool busy;                     /** true while the scan is running */
+  uint16_t scan_samples;                  /** scans taken per start, set by adc_dev_scan_init */
+  uint32_t result[ADC_SCAN_MAX_CHANNELS]; /** averaged raw ADC value of each channel, in devs order */
+  /* arch specific variables */
+  adc_scan_config_t arch;
+};
+
 /**
  * @brief function read microvolts on the ADC input pin with selected internal ADC Vref
  * 
  * @param dev         Pointer to the ADC device structure
  * @param microvolts  Pointer to the variable where microvolts will be stored
- * @return * adc_status_t   ADC status
+ * @return * adc_status_t   ADC status, the status of adc_arch_read_microvolts when the read failed
  */
 adc_status_t adc_dev_read_microvolts(adc_dev_t *dev, uint32_t *microvolts);
 
@@ -32,10 +98,47 @@ adc_status_t adc_dev_read_microvolts(adc_dev_t *dev, uint32_t *microvolts);
  * 
  * @param  dev         Pointer to the ADC device structure
  * @param  adc_value   Pointer to the variable where raw ADC value will be stored
- * @return * adc_status_t   ADC status
+ * @return * adc_status_t   ADC status, the status of adc_arch_read_single when the read failed
  */
 adc_status_t adc_dev_read_single(adc_dev_t *dev, uint32_t *adc_value);
 
+/**
+ * @brief function starts a read without blocking. The core can sleep or do other work while
+ *        the samples are converted, the callback is called from the ADC interrupt with the
+ *        raw average and the device is disabled again. The first call switches the device on,
+ *        while it settles the function returns ADC_BUSY and the caller polls it again, the
+ *        device stays on meanwhile. The read starts with the first call after the settling time.
+ * 
+ * @param  dev         Pointer to the ADC device structure
+ * @param  callback    completion callback, can be NULL when polling adc_dev_busy
+ * @param  ctx         context passed to the callback
+ * @return * adc_status_t   ADC status, ADC_BUSY if the device settles or a single read or a scan
+ *                          is running
+ */
+adc_status_t adc_dev_start(adc_dev_t *dev, adc_dev_callback_t callback, void *ctx);
+
+/**
+ * @brief function runs a value through the filter chain of the device. The reads of this
+ *        driver do not filter, the chain keeps state. Call this from one place, in one unit
+ *        and from the main loop only, e.g. once per acquisition cycle
+ * 
+ * @param  dev         Pointer to the ADC device structure
+ * @param  value       raw ADC value or microvolts, the unit the filter is set up for
+ * @return uint32_t    filtered value, the value itself if the device has no filter
+ */
+uint32_t adc_dev_filter(adc_dev_t *dev, uint32_t value);
+
+/**
+ * @brief function returns true while an asynchronous or blocking single read is running
+ */
+bool adc_dev_busy(void);
+
+/**
+ * @brief function returns the counters of the time spent waiting for the ADC and how much
+ *        of it the core slept
+ */
+const adc_sleep_stats_t *adc_dev_get_sleep_stats(void);
+
 /**
  * @brief function initializes the ADC device
  * 
@@ -44,14 +147,118 @@ adc_status_t adc_dev_read_single(adc_dev_t *dev, uint32_t *adc_value);
  */
 adc_status_t adc_dev_init(adc_dev_t *dev);
 
+/**
+ * @brief function sets up a scan group. The channel list is configured once, every start
+ *        then converts all the channels in one pass and the DMA moves the results.
+ * 
+ * @param group       Pointer to the scan group structure
+ * @return * adc_status_t   ADC status, ADC_INVALID if the channels can not be scanned together
+ */
+adc_status_t adc_dev_scan_init(adc_scan_group_t *group);
+
+/**
+ * @brief function starts a scan without blocking. The caller must power up the channels
+ *        that have an enable pin or a power domain. The group callback is called when the
+ *        results are ready.
+ * 
+ * @param group       Pointer to the scan group structure
+ * @return * adc_status_t   ADC status, ADC_BUSY if a scan or a single read is running
+ */
+adc_status_t adc_dev_scan_start(adc_scan_group_t *group);
+
+/**
+ * @brief function enables the channels, scans them and waits for the results
+ * 
+ * @param group       Pointer to the scan group structure
+ * @return * adc_status_t   ADC status
+ */
+adc_status_t adc_dev_scan_read(adc_scan_group_t *group);
+
+/**
+ * @brief function returns the result of a channel of the last scan in microvolts
+ * 
+ * @param group       Pointer to the scan group structure
+ * @param index       channel index in the devs list
+ * @return uint32_t   microvolts on the ADC input pin
+ */
+uint32_t adc_dev_scan_get_microvolts(adc_scan_group_t *group, uint8_t index);
+
+/**
+ * @brief function opens a power window. The first open switches the enable pin on and starts
+ *        the settling timer, every open must be closed again. Safe from interrupt context
+ * 
+ * @param domain      Pointer to the power domain
+ */
+void adc_power_domain_open(adc_power_domain_t *domain);
+
+/**
+ * @brief function closes a power window. The last close switches the enable pin off and adds
+ *        the window to the on time. Safe from interrupt context
+ * 
+ * @param domain      Pointer to the power domain
+ */
+void adc_power_domain_close(adc_power_domain_t *domain);
+
+/**
+ * @brief function waits until the settling time since the switch on has passed. Returns at
+ *        once when the window was already open long enough
+ * 
+ * @param domain      Pointer to the power domain, must be open
+ */
+void adc_power_domain_wait(adc_power_domain_t *domain);
+
+/**
+ * @brief function returns true when the domain is open and the settling time has passed,
+ *        the non-blocking counterpart of adc_power_domain_wait
+ * 
+ * @param domain      Pointer to the power domain
+ */
+bool adc_power_domain_settled(adc_power_domain_t *domain);
+
+/**
+ * @brief function returns the window counters and the on time of the domain. The on time of
+ *        an open window is added when it is closed
+ */
+const adc_power_stats_t *adc_power_domain_get_stats(const adc_power_domain_t *domain);
+
 /*********** Arch specific functions **************/
+/**
+ * @brief function starts an interrupt driven single read. The samples are averaged in the
+ *        ADC interrupt, which then updates the device stats and calls the callback.
+ * 
+ * @param  dev         Pointer to the ADC device structure
+ * @param  callback    completion callback, can be NULL
+ * @param  ctx         context passed to the callback
+ * @return * adc_status_t   ADC status, ADC_BUSY if a single read or a scan is running
+ */
+adc_status_t adc_arch_start_single(adc_dev_t *dev, adc_arch_callback_t callback, void *ctx);
+
+/**
+ * @brief function returns true while a single read or a scan is running
+ */
+bool adc_arch_busy(void);
+
+/**
+ * @brief function sleeps in EM1 until the flag is cleared by an interrupt and counts the
+ *        wait and sleep time
+ * 
+ * @param  busy        flag cleared from interrupt context
+ */
+void adc_arch_sleep_while(volatile bool *busy);
+
+/**
+ * @brief function returns the wait and sleep counters
+ */
+const adc_sleep_stats_t *adc_arch_get_sleep_stats(void);
+
 /**
  * @brief function reads raw adc value in single mode for given input parameters
  * 
  * @param  dev         Pointer to the ADC device structure
- * @return uint32_t    function returns raw ADC value
+ * @param  adc_value   Pointer to the raw ADC value, unchanged when the read failed
+ * @return * adc_status_t   ADC status of the conversion start
  */
-uint32_t adc_arch_read_single(adc_dev_t *dev);
+adc_status_t adc_arch_read_single(adc_dev_t *dev, uint32_t *adc_value);
 
 /**
  * @brief function reads ADC value and converts it in microvolts based on 
@@ -59,13 +266,41 @@ uint32_t adc_arch_read_single(adc_dev_t *dev);
  *        using internal reference voltage as ADC reference voltage.
  * 
  * @param  dev         Pointer to the ADC device structure
- * @return uint32_t    function returns microvolts on the ADC input pin with selected internal ADC Vref
+ * @param  microvolts  Pointer to the microvolts on the ADC input pin with selected internal ADC Vref,
+ *                     unchanged when the read failed
+ * @return * adc_status_t   ADC status of the conversion start
+ */
+adc_status_t adc_arch_read_microvolts(adc_dev_t *dev, uint32_t *microvolts);
+
+/**
+ * @brief function converts a raw ADC value into microvolts for the reference of the device
+ * 
+ * @param  dev         Pointer to the ADC device structure
+ * @param  adc_value   raw ADC value
+ * @return uint32_t    microvolts, 0 for an unsupported reference
+ */
+uint32_t adc_arch_microvolts_from_raw(adc_dev_t *dev, uint32_t adc_value);
+
+/**
+ * @brief function checks the channels of a scan group and builds the scan input setup
+ * 
+ * @param  group       Pointer to the scan group structure
+ * @return * adc_status_t   ADC status
+ */
+adc_status_t adc_arch_scan_init(adc_scan_group_t *group);
+
+/**
+ * @brief function starts the repeated scan and the DMA transfer of the results. The results
+ *        are averaged in the DMA interrupt and the group callback is called.
+ * 
+ * @param  group       Pointer to the scan group structure
+ * @return * adc_status_t   ADC status, ADC_BUSY if a scan or a single read is running
  */
-uint32_t adc_arch_read_microvolts(adc_dev_t *dev);
+adc_status_t adc_arch_scan_start(adc_scan_group_t *group);
 /**
  * @brief function initializes the ADC module by selecting auxiliary clock source
- *        with EFR32_ADC_CLOCK_HZ clock rate. It also calibrates the ADC for 
- *        2.5V reference voltage
+ *        with EFR32_ADC_CLOCK_HZ clock rate. It also loads the stored offset and gain
+ *        of the board references, or calibrates them if there are none
  */
 void adc_arch_init(ADC_TypeDef *adc_peripheral);
 /**
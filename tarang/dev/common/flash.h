@@ -13,4 +13,5 @@ flash_status_t flash_lock();
 flash_status_t flash_unlock();
 flash_status_t flash_erase_sector(uint32_t address);
 flash_status_t flash_write_word(uint32_t address, uint32_t data);
+flash_status_t flash_read(uint32_t address, void *data, uint32_t len);
 #endif /* _TARANG_FLASH_H_ */
@@ -30,13 +30,8 @@
 #include <stddef.h>
 #include "atomic.h"
 
-#define DEBUG_SERIAL_DEV 0     /**< Set this to 1 for debug printf output */
-#if DEBUG_SERIAL_DEV
-#include <stdio.h>
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)      /**< Replace printf with nothing */
-#endif /* DEBUG_SERIAL_DEV */
+#define LOG_MODULE LOG_MODULE_SERIAL_DEV
+#include "log.h"
 /*---------------------------------------------------------------------------*/
 bool
 serial_dev_has_bus(const serial_dev_t *dev)
@@ -67,7 +62,7 @@ serial_dev_bus_acquire(serial_dev_t *dev)
    */
   if(dev->cs_config != NULL) {
     if(!dev->bus->lock && !serial_arch_chip_is_selected(dev)) {
-      PRINTF("Selecting chip(%s)\n",__func__);
+      LOG_DBG("Selecting chip(%s)\n",__func__);
       serial_arch_chip_select(dev, CHIP_SELECT_ENABLE);
     }
   }
@@ -158,7 +153,16 @@ serial_dev_chip_select(serial_dev_t *dev, uint8_t on_off)
 }
 /*---------------------------------------------------------------------------*/
 void
-serial_dev_set_input_handler(serial_dev_t *dev, void (*handler)(unsigned char c))
+serial_dev_set_handler_ctx(serial_dev_t *dev, void *ctx)
+{
+  if(dev == NULL || dev->bus == NULL) {
+    return;
+  }
+  dev->bus->config.handler_ctx = ctx;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_dev_set_input_handler(serial_dev_t *dev, void (*handler)(void *ctx, uint8_t c))
 {
   if(dev->bus->config.uart_mode == UART_MODE_TX_ONLY) {
     return;
@@ -167,4 +171,33 @@ serial_dev_set_input_handler(serial_dev_t *dev, void (*handler)(unsigned char c)
   serial_arch_enable_rx(dev);
 }
 /*---------------------------------------------------------------------------*/
+bool
+serial_dev_set_input_block_handler(serial_dev_t *dev, void (*handler)(void *ctx, const uint8_t *data, uint16_t len))
+{
+  if(dev == NULL || dev->bus == NULL || dev->bus->config.uart_mode == UART_MODE_TX_ONLY
+     || !serial_arch_has_rx_dma(dev)) {
+    return false;
+  }
+  dev->bus->config.input_block_handler = handler;
+  serial_arch_enable_rx(dev);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_dev_set_output_handler(serial_dev_t *dev, bool (*handler)(void *ctx, uint8_t *c))
+{
+  if(dev == NULL || dev->bus == NULL) {
+    return;
+  }
+  dev->bus->config.output_handler = handler;
+}
+/*---------------------------------------------------------------------------*/
+void
+serial_dev_start_tx(serial_dev_t *dev)
+{
+  if(dev == NULL || dev->bus == NULL || dev->bus->config.output_handler == NULL) {
+    return;
+  }
+  serial_arch_enable_tx(dev);
+}
 /*---------------------------------------------------------------------------*/
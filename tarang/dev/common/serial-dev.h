@@ -41,7 +41,11 @@ serial_bus_status_t serial_dev_write_byte(serial_dev_t *dev, uint8_t data);
 serial_bus_status_t serial_dev_read_byte(serial_dev_t *dev, uint8_t *data);
 serial_bus_status_t serial_dev_write_reg(serial_dev_t *dev, uint8_t reg, const uint8_t *data, uint16_t size);
 serial_bus_status_t serial_dev_read_reg(serial_dev_t *dev, uint8_t reg, const uint8_t *data, uint16_t size);
-void serial_dev_set_input_handler(serial_dev_t *dev, void (*handler)(unsigned char c));
+void serial_dev_set_handler_ctx(serial_dev_t *dev, void *ctx);
+void serial_dev_set_input_handler(serial_dev_t *dev, void (*handler)(void *ctx, uint8_t c));
+bool serial_dev_set_input_block_handler(serial_dev_t *dev, void (*handler)(void *ctx, const uint8_t *data, uint16_t len));
+void serial_dev_set_output_handler(serial_dev_t *dev, bool (*handler)(void *ctx, uint8_t *c));
+void serial_dev_start_tx(serial_dev_t *dev);
 
 /* Arch specific functions must be implemented in arch specific file */
 serial_bus_status_t serial_arch_lock(serial_dev_t *dev);
@@ -53,4 +57,7 @@ serial_bus_status_t serial_arch_transfer(serial_dev_t *dev, const uint8_t *wdata
 void serial_arch_chip_select(serial_dev_t *dev, uint8_t on_off);
 bool serial_arch_chip_is_selected(serial_dev_t *dev);
 void serial_arch_enable_rx(serial_dev_t *dev);
+void serial_arch_enable_tx(serial_dev_t *dev);
+bool serial_arch_has_rx_dma(serial_dev_t *dev);
+void serial_arch_get_rx_stats(serial_dev_t *dev, uart_rx_stats_t *stats);
 #endif /* _SERIAL_DEV_H_ */
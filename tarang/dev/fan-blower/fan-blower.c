@@ -2,8 +2,10 @@
  * @file fan-blower.c
  * @author Varun Marolia
  * @brief This is a driver for DC fan/blowers with PWM input signal, Direction control
- *         and Techo input.
- * @todo Add support for Techo input and control system for fan/blower speed
+ *         and Techo input. The techo pulses are timestamped with the SysTick based
+ *         microsecond clock in the GPIO interrupt, the RPM is taken over a sliding window of pulse periods
+ *         and a fixed point PI loop on top of the open loop duty cycle holds the
+ *         requested RPM when the duct pressure changes.
  * 
  * @copyright Copyright (c) 2025 Varun Marolia
  *   MIT License
@@ -28,34 +30,166 @@
  */
 
 #include "fan-blower.h"
+#include "clock.h"
+#include "atomic.h"
 
-#define FAN_BLOWER_DEBUG 0
-#if FAN_BLOWER_DEBUG
-#include <stdio.h>
-#undef PRINTF
-#define PRINTF(...) printf(__VA_ARGS__)
-#else  /* FAN_BLOWER_DEBUG */
-/**< Replace printf with nothing */
-#define PRINTF(...)
-#endif /* FAN_BLOWER_DEBUG */
+#define LOG_MODULE LOG_MODULE_FAN_BLOWER
+#include "log.h"
+/*---------------------------------------------------------------------------*/
+static fan_blower_t *tach_fans[FAN_TACH_MAX_FANS];
+/*---------------------------------------------------------------------------*/
+/* largest duty cycle magnitude, for a bi-direction fan over pwm it is the distance from 50% */
+static int32_t
+fan_blower_max_magnitude(fan_blower_t *fb)
+{
+  return (fb->bidir == FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM) ? 5000 : 10000;
+}
+/*---------------------------------------------------------------------------*/
+/* open loop duty cycle magnitude of an rpm, linear from max_rpm */
+static uint32_t
+fan_blower_feed_forward(fan_blower_t *fb, uint32_t rpm)
+{
+  uint32_t duty_cycle_100x;
+
+  if(fb->bidir == FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM) {
+    duty_cycle_100x = (50 - fb->min_pwm) * 1000 / fb->max_rpm;
+  } else {
+    duty_cycle_100x = 100000 / fb->max_rpm;
+  }
+  duty_cycle_100x *= rpm;
+  duty_cycle_100x /= 10;
+  if(duty_cycle_100x > (uint32_t)fan_blower_max_magnitude(fb)) {
+    duty_cycle_100x = fan_blower_max_magnitude(fb);
+  }
+  if(duty_cycle_100x < (fb->min_pwm * 100) && duty_cycle_100x > 0) {
+    duty_cycle_100x = fb->min_pwm * 100;
+  }
+  return duty_cycle_100x;
+}
+/*---------------------------------------------------------------------------*/
+static void
+fan_blower_apply(fan_blower_t *fb, uint32_t magnitude_100x, uint8_t dir)
+{
+  uint32_t new_duty_cycle_100x = magnitude_100x;
+
+  if(fb->bidir == FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM) {
+    if(dir) {
+      /* Forward direction */
+      new_duty_cycle_100x = 5000 - magnitude_100x;
+    } else {
+      /* reverse direction */
+      new_duty_cycle_100x = 5000 + magnitude_100x;
+    }
+  }
+  pwm_dev_set_duty_cycle(fb->pwm_dev, new_duty_cycle_100x);
+  LOG_DBG("Fan-blower: new duty cycle:%u\n", (uint16_t)new_duty_cycle_100x);
+}
+/*---------------------------------------------------------------------------*/
+/* GPIO interrupt callback, one call per techo pulse */
+static void
+fan_tach_edge(gpio_interrupt_t *irq)
+{
+  /* not the DWT cycle counter, it stops while the core waits for the ADC in EM1 */
+  uint32_t now_us = (uint32_t)clock_get_time_us();
+  uint32_t period_us;
+  fan_blower_t *fb = NULL;
+  fan_tach_t *tach;
+  uint8_t i;
+
+  for(i = 0; i < FAN_TACH_MAX_FANS; i++) {
+    if(tach_fans[i] != NULL && tach_fans[i]->tach->irq == irq) {
+      fb = tach_fans[i];
+      break;
+    }
+  }
+  if(fb == NULL) {
+    return;
+  }
+  tach = fb->tach;
+  tach->pulses++;
+  period_us = now_us - tach->last_edge_us;
+  if(tach->edge_seen && period_us < (FAN_TACH_TIMEOUT_MS * 1000UL)) {
+    /* a period shorter than half the one at max_rpm is ringing on the line, not a pulse */
+    if(period_us < (30000000UL / ((uint32_t)fb->max_rpm * fb->pulses_per_rev))) {
+      tach->glitches++;
+      return;
+    }
+    tach->period_us[tach->index] = period_us;
+    tach->index = (tach->index + 1) % FAN_TACH_WINDOW;
+    if(tach->count < FAN_TACH_WINDOW) {
+      tach->count++;
+    }
+  }
+  tach->edge_seen = true;
+  tach->last_edge_us = now_us;
+}
+/*---------------------------------------------------------------------------*/
+/* rpm over the periods in the window, 0 when the pulses stopped */
+static uint16_t
+fan_tach_rpm(fan_blower_t *fb)
+{
+  fan_tach_t *tach = fb->tach;
+  uint32_t sum_us = 0;
+  uint32_t last_edge_us = 0;
+  uint32_t rpm;
+  uint8_t count = 0;
+  uint8_t i;
+
+  ATOMIC_SECTION(
+    count = tach->count;
+    for(i = 0; i < count; i++) {
+      sum_us += tach->period_us[i];
+    }
+    last_edge_us = tach->last_edge_us;
+  );
+  if(count == 0 || ((uint32_t)clock_get_time_us() - last_edge_us) >= (FAN_TACH_TIMEOUT_MS * 1000UL)) {
+    /* fan stopped, start a new window with the next pulse */
+    ATOMIC_SECTION(
+      tach->count = 0;
+      tach->index = 0;
+      tach->edge_seen = false;
+    );
+    return 0;
+  }
+  rpm = ((60000000UL / fb->pulses_per_rev) * count) / sum_us;
+  return (rpm > UINT16_MAX) ? UINT16_MAX : rpm;
+}
 /*---------------------------------------------------------------------------*/
 void 
 fan_blower_init(fan_blower_t *fb)
 {
+  uint8_t i;
+
   if(fb != NULL && fb->pwm_dev != NULL) {
     /* Initialize the pwm unit and enable the device */
     if(pwm_dev_init(fb->pwm_dev) != PWM_STATUS_OK) {
-      PRINTF("fan-blower: Could not initialize the pwm device !!!\n");
+      LOG_ERR("fan-blower: Could not initialize the pwm device !!!\n");
+    }
+    if(fb->tach != NULL && fb->tach->irq != NULL && fb->pulses_per_rev > 0) {
+      for(i = 0; i < FAN_TACH_MAX_FANS; i++) {
+        if(tach_fans[i] == NULL || tach_fans[i] == fb) {
+          break;
+        }
+      }
+      if(i < FAN_TACH_MAX_FANS) {
+        tach_fans[i] = fb;
+        fb->tach->irq->callback = fan_tach_edge;
+        gpio_interrupt(fb->tach->irq, true);
+        timer_set(&fb->control_timer, FAN_BLOWER_CONTROL_PERIOD_MS);
+      } else {
+        LOG_ERR("fan-blower: too many techo inputs, running open loop !!!\n");
+      }
     }
   } else {
-    PRINTF("fan-blower: Null pointer input!!!\n");
+    LOG_ERR("fan-blower: Null pointer input!!!\n");
   }
 }
 /*---------------------------------------------------------------------------*/
 void 
 fan_blower_set_rpm(fan_blower_t *fb, uint32_t rpm, uint8_t dir)
 {
-  uint32_t new_duty_cycle_100x = fb->min_pwm * 100;
+  int32_t output;
+
   if(fb != NULL && fb->pwm_dev != NULL) {
     if(rpm < fb->min_rpm && rpm > 0) {
       rpm = fb->min_rpm;
@@ -63,55 +197,89 @@ fan_blower_set_rpm(fan_blower_t *fb, uint32_t rpm, uint8_t dir)
     if( rpm > fb->max_rpm) {
       rpm = fb->max_rpm;
     }
-    switch (fb->bidir) {
-      case FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_GPIO:
-        if(fb->fan_blower_dir_handler !=NULL) {
-          fb->fan_blower_dir_handler(dir);
-        } else {
-          PRINTF("Fan-blower: setup for gpio based direction control but no direction control function assigned !!!\n");
-        }
-      case FAN_BLOWER_DIR_SINGLE:
-        new_duty_cycle_100x = 100000 / fb->max_rpm;
-        new_duty_cycle_100x *= rpm;
-        new_duty_cycle_100x /= 10;
-        if(new_duty_cycle_100x > 10000) {
-          new_duty_cycle_100x = 10000;
-        }
-        if(new_duty_cycle_100x < (fb->min_pwm * 100) && new_duty_cycle_100x > 0) {
-          new_duty_cycle_100x = fb->min_pwm * 100;
-        }
-      break;
-      
-      case FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM:
-        new_duty_cycle_100x = (50 - fb->min_pwm) * 1000 / fb->max_rpm;
-        new_duty_cycle_100x *= rpm;
-        new_duty_cycle_100x /= 10;
-        if(new_duty_cycle_100x < (fb->min_pwm * 100) && new_duty_cycle_100x > 0) {
-          new_duty_cycle_100x = fb->min_pwm * 100;
-        }
-        if(dir) {
-          /* Forward direction */
-          new_duty_cycle_100x = 5000 - new_duty_cycle_100x;
-        } else {
-          /* reverse direction */
-          new_duty_cycle_100x = 5000 + new_duty_cycle_100x;
-        }
-      break;
-      
-      default:
-      break;
+    if(fb->bidir == FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_GPIO) {
+      if(fb->fan_blower_dir_handler !=NULL) {
+        fb->fan_blower_dir_handler(dir);
+      } else {
+        LOG_WARN("Fan-blower: setup for gpio based direction control but no direction control function assigned !!!\n");
+      }
+    }
+    /* a new set point starts from the open loop duty cycle, the same one keeps the loop state */
+    if(rpm != fb->current_rpm || (rpm > 0 && dir != fb->current_dir)) {
+      fb->integral = 0;
+      fb->stalled = false;
+      timer_set(&fb->spin_up_timer, FAN_BLOWER_SPIN_UP_MS);
+    }
+    fb->feed_forward_100x = fan_blower_feed_forward(fb, rpm);
+    output = fb->feed_forward_100x + (fb->integral / FAN_BLOWER_GAIN_ONE);
+    if(rpm == 0 || output < 0) {
+      output = fb->feed_forward_100x;
     }
     /* apply the new duty cycle */
-    pwm_dev_set_duty_cycle(fb->pwm_dev, new_duty_cycle_100x);
+    fan_blower_apply(fb, output, dir);
     /* update direction only if rpm > 0 else preserve the last direction value */
     if(rpm > 0) {
       fb->current_dir = dir;
     }
     fb->current_rpm = rpm;
-    PRINTF("Fan-blower: new duty cycle:%u\n", (uint16_t)new_duty_cycle_100x);
   } else {
-    PRINTF("Fan-blower: Could not find the device !!!\n");
+    LOG_ERR("Fan-blower: Could not find the device !!!\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+fan_blower_poll(fan_blower_t *fb)
+{
+  int32_t error;
+  int32_t output;
+  int32_t step;
+
+  if(fb == NULL || fb->tach == NULL || fb->pwm_dev == NULL || !timer_timedout(&fb->control_timer)) {
+    return;
+  }
+  timer_set(&fb->control_timer, FAN_BLOWER_CONTROL_PERIOD_MS);
+  fb->measured_rpm = fan_tach_rpm(fb);
+  if(fb->current_rpm == 0 || (fb->kp == 0 && fb->ki == 0) || !timer_timedout(&fb->spin_up_timer)) {
+    return;
+  }
+  if(fb->measured_rpm == 0) {
+    /* blocked fan or no techo signal, winding up the integral would drive the fan to full speed */
+    if(!fb->stalled) {
+      LOG_WARN("Fan-blower: no techo pulses, running open loop\n");
+      fb->stalled = true;
+      fb->integral = 0;
+      fan_blower_apply(fb, fb->feed_forward_100x, fb->current_dir);
+    }
+    return;
+  }
+  fb->stalled = false;
+  error = (int32_t)fb->current_rpm - fb->measured_rpm;
+  step = error * (int32_t)fb->ki;
+  fb->integral += step;
+  output = fb->feed_forward_100x + ((error * (int32_t)fb->kp) / FAN_BLOWER_GAIN_ONE)
+           + (fb->integral / FAN_BLOWER_GAIN_ONE);
+  /* clamp, and stop integrating into the limit */
+  if(output > fan_blower_max_magnitude(fb)) {
+    output = fan_blower_max_magnitude(fb);
+    if(error > 0) {
+      fb->integral -= step;
+    }
+  } else if(output < (fb->min_pwm * 100)) {
+    output = fb->min_pwm * 100;
+    if(error < 0) {
+      fb->integral -= step;
+    }
+  }
+  fan_blower_apply(fb, output, fb->current_dir);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+fan_blower_get_rpm(fan_blower_t *fb)
+{
+  if(fb == NULL) {
+    return 0;
   }
+  return (fb->tach != NULL) ? fb->measured_rpm : fb->current_rpm;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -119,6 +287,7 @@ fan_blower_reset(fan_blower_t *fb)
 {
   if(fb != NULL && fb->pwm_dev != NULL) {
     pwm_dev_reset(fb->pwm_dev);
+    fb->integral = 0;
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -2,14 +2,34 @@
 #define _FAN_BLOWER_H_
 #include <stdint.h>
 #include "pwm-dev.h"
+#include "gpio.h"
+#include "timer.h"
 #include "common-arch.h"
 
+#define FAN_TACH_WINDOW               8       /* pulse periods in the sliding RPM window */
+#define FAN_TACH_TIMEOUT_MS           250     /* no pulse for this long reads as a stopped fan */
+#define FAN_TACH_MAX_FANS             2       /* fans with a tach input */
+#define FAN_BLOWER_CONTROL_PERIOD_MS  100     /* speed loop period */
+#define FAN_BLOWER_SPIN_UP_MS         2000    /* feed forward only after a new set point, the tach needs a full window */
+#define FAN_BLOWER_GAIN_ONE           65536   /* kp and ki are Q16, duty cycle 100x per RPM */
+
 typedef enum fb_dir_ctrl {
   FAN_BLOWER_DIR_SINGLE = 0,                   /* No direction control */
   FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_PWM = 1,   /* at 50% +/10% pwm the fan/blower is OFF from 0 to 40% duty cyle forward direciton from 60% t  */
   FAN_BLOWER_DIR_BIDIRECTIONAL_OVER_GPIO = 2   /* Direction control using GPIO */
 } fb_dir_ctrl_t;
 
+typedef struct fan_tach {
+  gpio_interrupt_t *irq;                          /* tach input, one interrupt per pulse */
+  volatile uint32_t period_us[FAN_TACH_WINDOW];   /* last pulse periods, circular */
+  volatile uint8_t index;                         /* next period position */
+  volatile uint8_t count;                         /* valid periods in the window */
+  volatile bool edge_seen;                        /* last_edge_us holds an edge */
+  volatile uint32_t last_edge_us;                 /* SysTick time of the last edge, keeps counting in EM1 */
+  volatile uint32_t pulses;
+  volatile uint32_t glitches;                     /* edges faster than max_rpm allows, dropped */
+} fan_tach_t;
+
 typedef struct fan_blower {
   const uint8_t pulses_per_rev;                   /* number of techo pulses per revolution */
   const fb_dir_ctrl_t bidir;                      /* set BIDIRECTIONAL if direction can be changed over PWM or GPIO */
@@ -17,8 +37,17 @@ typedef struct fan_blower {
   const uint16_t min_rpm;                         /* min rpm, start rpm */
   const uint8_t min_pwm;                          /* min pwm duty cycle in percentage for min RPM. for bi-direction fan over pwm, this is the duty cycle hysteresis where the fan/blower will stay off */
   void (* fan_blower_dir_handler)(uint8_t dir);
-  uint16_t current_rpm;
+  const uint32_t kp;                              /* proportional gain Q16, duty cycle 100x per RPM of error */
+  const uint32_t ki;                              /* integral gain Q16, per control period. kp = ki = 0 keeps the fan open loop */
+  fan_tach_t *tach;                               /* tach capture, NULL for open loop */
+  uint16_t current_rpm;                           /* requested rpm */
   uint8_t current_dir;
+  uint16_t measured_rpm;                          /* rpm from the tach window, updated by fan_blower_poll() */
+  uint16_t feed_forward_100x;                     /* open loop duty cycle magnitude of the requested rpm */
+  int32_t integral;                               /* controller integral, duty cycle 100x Q16 */
+  bool stalled;                                   /* running on feed forward, no tach pulses */
+  ttimer_t control_timer;
+  ttimer_t spin_up_timer;
   /* arch specific */
   pwm_dev_t *pwm_dev;
 } fan_blower_t;
@@ -28,4 +57,8 @@ typedef struct fan_blower dc_motor_t;
 void fan_blower_init(fan_blower_t *fb);
 void fan_blower_set_rpm(fan_blower_t *fb, uint32_t rpm, uint8_t dir);
 void fan_blower_reset(fan_blower_t *fb);
+/* runs the speed loop every FAN_BLOWER_CONTROL_PERIOD_MS, call from the application poll */
+void fan_blower_poll(fan_blower_t *fb);
+/* measured rpm if the fan has a tach, the requested rpm otherwise */
+uint16_t fan_blower_get_rpm(fan_blower_t *fb);
 #endif  /* _FAN_BLOWER_H_ */
@@ -5,6 +5,11 @@
  *        debug printf output and also implements an ISR callback method for RX 
  *        data reception in a circular buffer. In the event if the debug output 
  *        is on SWO pin, the UART TX will not use the printf function.
+ *        Every guart instance owns its RX and TX circular buffers, the serial
+ *        interrupts are dispatched to the owning instance using the handler
+ *        context so that more than one uart can run at the same time. The TX
+ *        buffer is drained by the TX interrupt so that the callers (printf,
+ *        telemetry) do not block.
  * 
  * @copyright Copyright (c) 2025 Varun Marolia
  *   MIT License
@@ -35,14 +40,6 @@
 #include <string.h>
 #include "atomic.h"
 
-#define DEBUG_GUART 0     /**< Set this to 1 for debug printf output */
-#if DEBUG_GUART
-#include <stdio.h>
-#define PRINTF(...) printf(__VA_ARGS__)
-#else
-#define PRINTF(...)      /**< Replace printf with nothing */
-#endif /* DEBUG_GUART */
-
 static guart_t *debug_uart = NULL;  /* pointer to debug uart. Will be used by stdout */
 /*---------------------------------------------------------------------------*/
 void
@@ -53,19 +50,68 @@ guart_init(guart_t *uart)
     uart->rx_buff_head = 0;
     uart->rx_buff_tail = 0;
     uart->new_line_buff_index = GUART_RX_BUFFER_SIZE;
+    uart->tx_buff_head = 0;
+    uart->tx_buff_tail = 0;
+    uart->tx_errors = 0;
+    serial_dev_set_handler_ctx(uart->guart_dev, uart);
+    serial_dev_set_output_handler(uart->guart_dev, guart_output_handler);
+    /* prefer LDMA burst reception if the board provides an RX DMA buffer */
+    if(!serial_dev_set_input_block_handler(uart->guart_dev, guart_input_block_handler)) {
+      serial_dev_set_input_handler(uart->guart_dev, guart_input_handler);
+    }
   }
 }
 /*---------------------------------------------------------------------------*/
 void
 guart_send_data(guart_t *uart, const uint8_t *data, uint16_t bytes)
 {
-  serial_bus_status_t bus_status;
   if(uart != NULL) {
-    bus_status = serial_arch_transfer(uart->guart_dev, data, bytes, NULL, 0);
-    if(bus_status != BUS_OK) {
-      PRINTF("GUART: failed to send data, error:%u\n", bus_status);
-    } 
+    /* stdout ends up here when the TX buffer is full, a log message on failure
+       would come straight back. Count the error instead */
+    if(serial_arch_transfer(uart->guart_dev, data, bytes, NULL, 0) != BUS_OK) {
+      uart->tx_errors++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+guart_tx_free(guart_t *uart)
+{
+  uint16_t used;
+  if(uart == NULL) {
+    return 0;
+  }
+  used = (uart->tx_buff_head + GUART_TX_BUFFER_SIZE - uart->tx_buff_tail) % GUART_TX_BUFFER_SIZE;
+  /* one slot is always kept empty to tell a full buffer from an empty one */
+  return GUART_TX_BUFFER_SIZE - 1 - used;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+guart_queue_data(guart_t *uart, const uint8_t *data, uint16_t bytes)
+{
+  uint16_t i;
+  uint16_t head;
+  uint16_t queued = 0;
+  if(uart == NULL || data == NULL || bytes == 0) {
+    return 0;
+  }
+  /* either queue the complete data or nothing, this keeps the frames intact
+   * even if printf is called from an interrupt context */
+  ATOMIC_SECTION(
+    if(guart_tx_free(uart) >= bytes) {
+      head = uart->tx_buff_head;
+      for(i = 0; i < bytes; i++) {
+        uart->tx_buff[head] = data[i];
+        head = (head + 1) % GUART_TX_BUFFER_SIZE;
+      }
+      uart->tx_buff_head = head;  /* publish the data to the TX interrupt */
+      queued = bytes;
+    }
+  );
+  if(queued) {
+    serial_dev_start_tx(uart->guart_dev);
   }
+  return queued;
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
@@ -121,35 +167,85 @@ guart_read_line(guart_t *uart, uint8_t *data)
 }
 /*---------------------------------------------------------------------------*/
 void
-guart_debug_input_handler(uint8_t data)
+guart_input_handler(void *ctx, uint8_t data)
 {
-  if(debug_uart != NULL) {
-    debug_uart->rx_buff[debug_uart->rx_buff_head] = data;
+  guart_t *uart = (guart_t *)ctx;
+  if(uart != NULL) {
+    uart->rx_buff[uart->rx_buff_head] = data;
     /* If received new line character. update the buffer index to latest new line index */
     if(data == '\n') {
-      debug_uart->new_line_buff_index = debug_uart->rx_buff_head;
+      uart->new_line_buff_index = uart->rx_buff_head;
+    }
+    uart->rx_buff_head = (uart->rx_buff_head + 1) % GUART_RX_BUFFER_SIZE;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+guart_input_block_handler(void *ctx, const uint8_t *data, uint16_t len)
+{
+  uint16_t i;
+  for(i = 0; i < len; i++) {
+    guart_input_handler(ctx, data[i]);
+  }
+}
+/*---------------------------------------------------------------------------*/
+bool
+guart_output_handler(void *ctx, uint8_t *data)
+{
+  guart_t *uart = (guart_t *)ctx;
+  if(uart == NULL || uart->tx_buff_tail == uart->tx_buff_head) {
+    return false;
+  }
+  *data = uart->tx_buff[uart->tx_buff_tail];
+  uart->tx_buff_tail = (uart->tx_buff_tail + 1) % GUART_TX_BUFFER_SIZE;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/* queues all the bytes in order with stdout, waits while the TX buffer is full */
+static void
+guart_queue_all(guart_t *uart, const uint8_t *data, uint16_t bytes)
+{
+  uint16_t chunk;
+  uint8_t byte;
+  if(uart == NULL || data == NULL) {
+    return;
+  }
+  while(bytes) {
+    chunk = guart_tx_free(uart);
+    if(chunk > bytes) {
+      chunk = bytes;
+    }
+    if(chunk && guart_queue_data(uart, data, chunk)) {
+      data += chunk;
+      bytes -= chunk;
+    } else {
+      /* TX buffer is full. Push one byte out from here so that a call from
+       * an interrupt context (TX interrupt masked) can not dead lock */
+      ATOMIC_SECTION(
+        if(guart_output_handler(uart, &byte)) {
+          guart_send_data(uart, &byte, 1);
+        }
+      );
     }
-    debug_uart->rx_buff_head = (debug_uart->rx_buff_head + 1) % GUART_RX_BUFFER_SIZE;
   }
 }
 /*---------------------------------------------------------------------------*/
 void
 guart_puts(guart_t *uart, const char *str)
 {
-  guart_send_data(uart, (uint8_t *)str, strlen(str));
+  guart_queue_all(uart, (const uint8_t *)str, strlen(str));
 }
 /*---------------------------------------------------------------------------*/
 void
 guart_debug_puts(const char *str)
 {
-  guart_send_data(debug_uart, (uint8_t *)str, strlen(str));
+  guart_queue_all(debug_uart, (const uint8_t *)str, strlen(str));
 }
 /*---------------------------------------------------------------------------*/
 void
 guart_set_debug_stdo(guart_t *uart)
 {
   debug_uart = uart;
-  serial_dev_set_input_handler(uart->guart_dev, guart_debug_input_handler);
 }
 /*---------------------------------------------------------------------------*/
 #ifndef USE_SWO_DEBUG
@@ -157,9 +253,7 @@ guart_set_debug_stdo(guart_t *uart)
 void 
 stdio_put_char_bw(char c)
 {
-  if(debug_uart != NULL) {
-    guart_send_data(debug_uart, (uint8_t *)&c, 1);
-  }
+  guart_queue_all(debug_uart, (const uint8_t *)&c, 1);
 }
 #endif /* USE_SWO_DEBUG */
 /*---------------------------------------------------------------------------*/
@@ -1,9 +1,11 @@
 #ifndef __GENERIC_UART_H__
 #define __GENERIC_UART_H__
 #include <stdint.h>
+#include <stdbool.h>
 #include "serial-dev.h"
 
 #define GUART_RX_BUFFER_SIZE                128
+#define GUART_TX_BUFFER_SIZE                1024            /* ~8.5 ms of data at GUART_MAX_USB_UART_EFR32_BAUDRATE */
 #define GUART_MAX_USB_UART_EFR32_BAUDRATE   1200000         /* 1.2Mbps, Actual speed 120000 Bps. This baud produces integer value for USART_CLKDIV on EFR32 */
 #define GUART_MAX_STD_UART_BAUDRATE         921600          /* 921.6Kbps, Actual speed 92160 Bps */
 
@@ -12,15 +14,22 @@ typedef struct guart {
   volatile uint16_t rx_buff_head;           /* buffer head */
   volatile uint16_t rx_buff_tail;           /* buffer tail */
   uint16_t new_line_buff_index;             /* new line character index in the rx_buff of last received byte */
+  uint8_t tx_buff[GUART_TX_BUFFER_SIZE];    /* Circular queue buffer for interrupt driven TX */
+  volatile uint16_t tx_buff_head;           /* tx buffer head, written by guart_queue_data */
+  volatile uint16_t tx_buff_tail;           /* tx buffer tail, written by the TX interrupt */
+  uint32_t tx_errors;                       /* failed blocking sends, not logged as stdout uses them */
   serial_dev_t *guart_dev;                  /* pointer to a generic uart device */
-  void (*rx_handler)(unsigned char c);      /* function pointer to Rx interrupt handler for this uart device */
 } guart_t;
 
-void guart_send_data(guart_t *uart, const uint8_t *data, uint16_t bytes);
+void guart_send_data(guart_t *uart, const uint8_t *data, uint16_t bytes);   /* blocking, bypasses the TX buffer. Use guart_queue_data or guart_puts */
+uint16_t guart_queue_data(guart_t *uart, const uint8_t *data, uint16_t bytes);
+uint16_t guart_tx_free(guart_t *uart);
 uint16_t guart_read_data(guart_t *uart, uint8_t *data);
 uint16_t guart_read_line(guart_t *uart, uint8_t *data);
 void guart_init(guart_t *uart);
-void guart_debug_input_handler(uint8_t data);
+void guart_input_handler(void *ctx, uint8_t data);
+void guart_input_block_handler(void *ctx, const uint8_t *data, uint16_t len);
+bool guart_output_handler(void *ctx, uint8_t *data);
 void guart_puts(guart_t *uart, const char *str);
 void guart_debug_puts(const char *str);
 void guart_set_debug_stdo(guart_t *uart);
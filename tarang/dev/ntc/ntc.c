@@ -3,8 +3,8 @@
  * @author Varun Marolia
  * @brief Generic NTC thermistor driver. The driver supports NTC thermistor
  *        with beta value method and temperature chart method. The NTC cane
- *        be connected in two configurations, pulled up or pulled down.
- * @todo Add support for temperature chart method.
+ *        be connected in two configurations, pulled up or pulled down, and read
+ *        against an absolute reference or ratiometric against its own supply.
  * 
  * @copyright Copyright (c) 2025 Varun Marolia
  *   MIT License
@@ -30,62 +30,222 @@
 #include "ntc.h"
 #include "board.h"
 #include "adc-dev.h"
+#include "interp.h"
 #include <math.h>
-#define NTC_DEBUG 0
-#if NTC_DEBUG
-#include <stdio.h>
-#undef PRINTF
-#define PRINTF(...) printf(__VA_ARGS__)
-#else  /* NTC_DEBUG */
-/**< Replace printf with nothing */
-#define PRINTF(...)
-#endif /* NTC_DEBUG */
+#define LOG_MODULE LOG_MODULE_NTC
+#include "log.h"
+/*---------------------------------------------------------------------------*/
+/* resistance of the NTC from the divider ratio value / full_scale, e.g. an ADC code against VDD
+   when VDD also supplies the divider. 32 bit integer math, returns 0 outside the divider range */
+static uint32_t
+ntc_resistance_from_ratio(ntc_thermistor_t *ntc, uint32_t value, uint32_t full_scale)
+{
+  uint32_t num, den, quotient;
+
+  /* a 16 bit ratio is finer than the ADC and keeps the products below in 32 bits */
+  while(full_scale > 0xFFFF) {
+    value >>= 1;
+    full_scale >>= 1;
+  }
+  if(value == 0 || value >= full_scale) {
+    return 0;
+  }
+  if(ntc->ntc_config == NTC_PULLED_DOWN_CONFIG) {
+    num = value;
+    den = full_scale - value;
+  } else {
+    num = full_scale - value;
+    den = value;
+  }
+  /* known resistance * num / den, split into quotient and remainder of known resistance / den */
+  quotient = ntc->known_resistance_ohm / den;
+  if(quotient > (UINT32_MAX / num) - 1) {
+    return UINT32_MAX;
+  }
+  return (quotient * num) + (((ntc->known_resistance_ohm % den) * num) / den);
+}
 /*---------------------------------------------------------------------------*/
 #if defined(__FPU_PRESENT) && (__FPU_PRESENT == 1)
-int32_t 
-ntc_read_temp_mc_using_beta(ntc_thermistor_t *ntc)
+static int32_t
+ntc_beta_temp_mc_from_resistance(ntc_thermistor_t *ntc, double resistance)
 {
-  uint32_t adc_mv;
-  double resistance;
   double temperature;
-  
-  if (adc_dev_read_microvolts(ntc->adc_dev, &adc_mv) != ADC_OK) {
-      return 0;
+
+  /* Calculate the temperature in Kelvin using the beta parameter equation */
+  temperature = 1.0 / ((1.0 / (ntc->T0_C + 273.15)) + (1.0 / ntc->beta_value_25) * log(resistance / ntc->R0_ohm));
+  /* Convert the temperature to Celsius */
+  temperature -= 273.15;
+  LOG_DBG("NTC: Resistance:%lu\n", (uint32_t)resistance);
+  if(temperature < ntc->max_negative_temp_C || temperature > ntc->max_positive_temp_C) {
+    LOG_WARN("NTC: Temperature out of range\n");
+    return NTC_ERROR;
   }
+  /* Convert the temperature to milli-Celsius */
+  return (int32_t)(temperature * 1000);
+}
+/*---------------------------------------------------------------------------*/
+static int32_t
+ntc_beta_temp_mc_from_microvolts(ntc_thermistor_t *ntc, uint32_t microvolts)
+{
+  uint32_t adc_mv;
+  double resistance;
+
   /* convert reading into millivolts */
-  adc_mv /= 1000;
-  PRINTF("NTC: ADC mv:%lu\n", adc_mv);
+  adc_mv = microvolts / 1000;
+  LOG_DBG("NTC: ADC mv:%lu\n", adc_mv);
   /* Calculate the resistance of the NTC thermistor using voltage divider rule */
   if (ntc->ntc_config == NTC_PULLED_DOWN_CONFIG) {
       resistance = ntc->known_resistance_ohm * ((double)adc_mv / (ntc->supply_mV - adc_mv));
   } else { // NTC_PULL_UP
       resistance = ntc->known_resistance_ohm * ((double)(ntc->supply_mV - adc_mv) / adc_mv);
   }
-  /* Calculate the temperature in Kelvin using the beta parameter equation */
-  temperature = 1.0 / ((1.0 / (ntc->T0_C + 273.15)) + (1.0 / ntc->beta_value_25) * log(resistance / ntc->R0_ohm));
-  /* Convert the temperature to Celsius */
-  temperature -= 273.15;
-  PRINTF("NTC: Resistance:%lu\n", (uint32_t)resistance);
-  if(temperature < ntc->max_negative_temp_C || temperature > ntc->max_positive_temp_C) {
-    PRINTF("NTC: Temperature out of range\n");
+  return ntc_beta_temp_mc_from_resistance(ntc, resistance);
+}
+/*---------------------------------------------------------------------------*/
+int32_t 
+ntc_read_temp_mc_using_beta(ntc_thermistor_t *ntc)
+{
+  uint32_t adc_uv;
+  uint32_t adc_code;
+  uint32_t resistance;
+
+  if(ntc->ratiometric) {
+    /* the ratio of codes is the divider ratio, the supply drops out */
+    if(adc_dev_read_single(ntc->adc_dev, &adc_code) != ADC_OK) {
+      return NTC_ERROR;
+    }
+    resistance = ntc_resistance_from_ratio(ntc, adc_code, ADC_RESOLUTION);
+    if(resistance == 0) {
+      LOG_WARN("NTC: Temperature out of range\n");
+      return NTC_ERROR;
+    }
+    return ntc_beta_temp_mc_from_resistance(ntc, resistance);
+  }
+  if (adc_dev_read_microvolts(ntc->adc_dev, &adc_uv) != ADC_OK) {
+      return 0;
+  }
+  return ntc_beta_temp_mc_from_microvolts(ntc, adc_uv);
+}
+#endif /* defined(__FPU_PRESENT) && (__FPU_PRESENT == 1) */
+/*---------------------------------------------------------------------------*/
+static int32_t
+ntc_chart_temp_mc_from_resistance(ntc_thermistor_t *ntc, uint32_t resistance)
+{
+  uint16_t entries;
+  int32_t temp_mC;
+
+  if(ntc->RT_chart == NULL || ntc->temp_step == 0) {
+    LOG_ERR("NTC: no RT chart\n");
     return NTC_ERROR;
   }
-  /* Convert the temperature to milli-Celsius */
-  return (int32_t)(temperature * 1000);
+  LOG_DBG("NTC: Resistance:%lu\n", resistance);
+  entries = ((ntc->max_positive_temp_C - ntc->max_negative_temp_C) / ntc->temp_step) + 1;
+  if(!interp_search_descending(ntc->RT_chart, entries, resistance, (int32_t)ntc->max_negative_temp_C * 1000,
+                               (int32_t)ntc->temp_step * 1000, &temp_mC)) {
+    LOG_WARN("NTC: Temperature out of range\n");
+    return NTC_ERROR;
+  }
+  return temp_mC;
 }
+/*---------------------------------------------------------------------------*/
+static int32_t
+ntc_chart_temp_mc_from_microvolts(ntc_thermistor_t *ntc, uint32_t microvolts)
+{
+  uint32_t supply_uv = (uint32_t)ntc->supply_mV * 1000;
+  uint32_t resistance;
+
+  if(microvolts == 0 || microvolts >= supply_uv) {
+    LOG_WARN("NTC: Temperature out of range\n");
+    return NTC_ERROR;
+  }
+  /* Calculate the resistance of the NTC thermistor using voltage divider rule. The
+     product of known resistance and microvolts needs 64 bits */
+  if(ntc->ntc_config == NTC_PULLED_DOWN_CONFIG) {
+    resistance = (uint32_t)(((uint64_t)ntc->known_resistance_ohm * microvolts) / (supply_uv - microvolts));
+  } else {
+    resistance = (uint32_t)(((uint64_t)ntc->known_resistance_ohm * (supply_uv - microvolts)) / microvolts);
+  }
+  return ntc_chart_temp_mc_from_resistance(ntc, resistance);
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+ntc_temp_mc_from_ratio(ntc_thermistor_t *ntc, uint32_t value, uint32_t full_scale)
+{
+  uint32_t resistance = ntc_resistance_from_ratio(ntc, value, full_scale);
+
+  if(resistance == 0) {
+    LOG_WARN("NTC: Temperature out of range\n");
+    return NTC_ERROR;
+  }
+  if(ntc->RT_chart != NULL) {
+    return ntc_chart_temp_mc_from_resistance(ntc, resistance);
+  }
+#if defined(__FPU_PRESENT) && (__FPU_PRESENT == 1)
+  return ntc_beta_temp_mc_from_resistance(ntc, resistance);
+#else
+  LOG_ERR("NTC: no RT chart\n");
+  return NTC_ERROR;
 #endif /* defined(__FPU_PRESENT) && (__FPU_PRESENT == 1) */
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+ntc_temp_mc_from_adc_code(ntc_thermistor_t *ntc, uint32_t adc_code)
+{
+  int32_t temp_cC;
+  bool found;
+
+  if(ntc->code_table == NULL) {
+    if(ntc->ratiometric) {
+      return ntc_temp_mc_from_ratio(ntc, adc_code, ADC_RESOLUTION);
+    }
+    LOG_ERR("NTC: no code table\n");
+    return NTC_ERROR;
+  }
+  /* the code table holds the whole chain from ADC code over the divider to temperature */
+  if(ntc->code_points != NULL) {
+    found = interp_breakpoints(ntc->code_points, ntc->code_table, ntc->code_entries, adc_code, &temp_cC);
+  } else {
+    found = interp_uniform(ntc->code_table, (ADC_RESOLUTION >> ntc->code_shift) + 1, ntc->code_shift,
+                           adc_code, &temp_cC);
+  }
+  if(!found
+     || temp_cC < ((int32_t)ntc->max_negative_temp_C * 100)
+     || temp_cC > ((int32_t)ntc->max_positive_temp_C * 100)) {
+    LOG_WARN("NTC: Temperature out of range\n");
+    return NTC_ERROR;
+  }
+  return temp_cC * 10;
+}
 /*---------------------------------------------------------------------------*/
 int32_t 
 ntc_read_temp_mc_using_charts(ntc_thermistor_t *ntc)
 {
-  /**
-   * @todo Implement method to calculate temperature value from resistance, temperature chart data.
-   *       Chart can be generated using beta function or manually uploaded from manufacturer.
-   *       The method must not be FPU dependent.
-   * 
-   */
-  return 0;
+  uint32_t adc_uv;
+  uint32_t adc_code;
+
+  if(ntc->code_table != NULL || ntc->ratiometric) {
+    if(adc_dev_read_single(ntc->adc_dev, &adc_code) != ADC_OK) {
+      return NTC_ERROR;
+    }
+    return ntc_temp_mc_from_adc_code(ntc, adc_code);
+  }
+  if(adc_dev_read_microvolts(ntc->adc_dev, &adc_uv) != ADC_OK) {
+    return NTC_ERROR;
+  }
+  return ntc_chart_temp_mc_from_microvolts(ntc, adc_uv);
 }
 /*---------------------------------------------------------------------------*/
+int32_t
+ntc_temp_mc_from_microvolts(ntc_thermistor_t *ntc, uint32_t microvolts)
+{
+  if(ntc->RT_chart != NULL) {
+    return ntc_chart_temp_mc_from_microvolts(ntc, microvolts);
+  }
+#if defined(__FPU_PRESENT) && (__FPU_PRESENT == 1)
+  return ntc_beta_temp_mc_from_microvolts(ntc, microvolts);
+#else
+  LOG_ERR("NTC: no RT chart\n");
+  return NTC_ERROR;
+#endif /* defined(__FPU_PRESENT) && (__FPU_PRESENT == 1) */
+}
 /*---------------------------------------------------------------------------*/
-
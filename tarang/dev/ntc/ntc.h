@@ -18,16 +18,37 @@ typedef struct ntc_thermistor {
   const ntc_config_t ntc_config;                /* configuration of NTC, NTC_PULLED_UP_CONFIG OR NTC_PULLED_DOWN_CONFIG */
   const int16_t max_negative_temp_C;            /* Max negative measurable temperature value for this NTC */
   const uint16_t max_positive_temp_C;           /* Max positive measurable temperature value for this NTC */
-  const uint16_t supply_mV;                     /* VCC of the voltage divider */
+  const uint16_t supply_mV;                     /* VCC of the voltage divider, not used in ratiometric mode */
+  const bool ratiometric;                       /* the divider is supplied by the ADC reference (adcRefVDD). The
+                                                   resistance is taken from the ratio of ADC codes in 32 bit integer
+                                                   math, supply drift drops out. A code table made with VCC equal to
+                                                   the ADC reference is ratiometric as well and is used first */
   /* arch specific */
   adc_dev_t *adc_dev;                           /* pointer to the ADC value */
-  const uint16_t *RT_chart;                     /* pointer to the Resistance temperature chart array */
+  const uint32_t *RT_chart;                     /* pointer to the Resistance temperature chart array, resistance in ohms
+                                                   from max_negative_temp_C to max_positive_temp_C, see tools/ntc_data_generator.c */
   const uint8_t temp_step;                      /* single step temperature increment in the RT table */
+  const int16_t *code_table;                    /* pointer to the ADC code temperature table, temperature in 0.01 C at
+                                                   every 2^code_shift ADC codes or at code_points, see tools/ntc_data_generator.c */
+  const uint8_t code_shift;                     /* ADC codes between two entries of the code table, as power of 2 */
+  const uint16_t *code_points;                  /* ascending ADC codes of the code table entries for a table with
+                                                   non-uniform breakpoints, NULL for a table at every 2^code_shift codes */
+  const uint16_t code_entries;                  /* entries of a code table with code_points */
 } ntc_thermistor_t;
 
 #if defined(__FPU_PRESENT) && (__FPU_PRESENT == 1)
 int32_t ntc_read_temp_mc_using_beta(ntc_thermistor_t *ntc);
 #endif  /* defined(__FPU_PRESENT) && (__FPU_PRESENT == 1) */
+/* integer only, lookup in code_table if the NTC has one, binary search and linear interpolation
+   in RT_chart otherwise */
 int32_t ntc_read_temp_mc_using_charts(ntc_thermistor_t *ntc);
+/* converts a raw ADC code that was already taken, needs code_table or ratiometric */
+int32_t ntc_temp_mc_from_adc_code(ntc_thermistor_t *ntc, uint32_t adc_code);
+/* converts a divider ratio value / full_scale, e.g. an ADC code against VDD, or the microvolts of the
+   divider and of its supply measured in the same batch. Integer only with RT_chart, beta equation otherwise */
+int32_t ntc_temp_mc_from_ratio(ntc_thermistor_t *ntc, uint32_t value, uint32_t full_scale);
+/* converts a reading that was already taken, e.g. in a batch. Uses the chart when the NTC has one,
+   the beta equation otherwise (FPU only) */
+int32_t ntc_temp_mc_from_microvolts(ntc_thermistor_t *ntc, uint32_t microvolts);
 
 #endif  /* _NTC_H_ */
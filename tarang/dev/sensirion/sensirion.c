@@ -28,20 +28,18 @@
  #include "timer.h"
 #include "sensirion.h"
 
-#define DEBUG_SENSIRION  0 /**< This macro enables/disables the debug printf for this file */
-
-#if DEBUG_SENSIRION
-#include <stdio.h>
-#undef PRINTF
-#define PRINTF(...) printf(__VA_ARGS__)
-#else  /* DEBUG_SENSIRION */
-/**< Replace printf with nothing */
-#define PRINTF(...)
-#endif /* DEBUG_SENSIRION */
+#define LOG_MODULE LOG_MODULE_SENSIRION
+#include "log.h"
 
+/*---------------------------------------------------------------------------*/
+static bool
+sensirion_device_valid(const sensirion_device_t *device)
+{
+  return device != NULL && device->part != NULL && device->part->cmd_set != NULL && device->dev != NULL;
+}
 /*---------------------------------------------------------------------------*/
 uint8_t
-sensirion_set(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen)
+sensirion_set(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
 {
   serial_bus_status_t bus_status;
   uint8_t i;
@@ -49,81 +47,81 @@ sensirion_set(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *da
   uint8_t *sensirion_data;
 
   /* Sanity check data and datalen first */
-  if(cmd > device_config->cmd_num
-     || (device_config->cmd_set[cmd].datalen == 0 && (data != NULL || datalen != 0))
-     || (device_config->cmd_set[cmd].datalen > 0
-         && (data == NULL || datalen * 3 != device_config->cmd_set[cmd].datalen))
-     || !device_config->cmd_bytes || device_config->cmd_bytes > 2) {
-    PRINTF("SENSIRION invalid cmd/data/datalen\n");
+  if(!sensirion_device_valid(device) || cmd >= device->part->cmd_num
+     || (device->part->cmd_set[cmd].datalen == 0 && (data != NULL || datalen != 0))
+     || (device->part->cmd_set[cmd].datalen > 0
+         && (data == NULL || datalen * 3 != device->part->cmd_set[cmd].datalen))
+     || !device->part->cmd_bytes || device->part->cmd_bytes > 2) {
+    LOG_ERR("SENSIRION invalid cmd/data/datalen\n");
     return BUS_INVALID;
   }
-  if(SENSIRION_MAX_SET_PARAM_LENGTH < device_config->cmd_set[cmd].datalen) {
-    PRINTF("SENSIRION invalid param length\n");
+  if(SENSIRION_MAX_SET_PARAM_LENGTH < device->part->cmd_set[cmd].datalen) {
+    LOG_ERR("SENSIRION invalid param length\n");
     return BUS_INVALID;
   }
   
   /* first 1 or 2 bytes are commands the rest are data/parameters */
-  sensirion_data = sensirion_cmd + device_config->cmd_bytes;
+  sensirion_data = sensirion_cmd + device->part->cmd_bytes;
   
-  bus_status = serial_dev_bus_acquire(device_config->dev);
+  bus_status = serial_dev_bus_acquire(device->dev);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION couldn't acquire bus %u\n", bus_status);
+    LOG_WARN("SENSIRION couldn't acquire bus %u\n", bus_status);
     return bus_status;
   }
-  if(device_config->cmd_bytes == 1) {
-    sensirion_cmd[0] = (uint8_t) device_config->cmd_set[cmd].cmd;
+  if(device->part->cmd_bytes == 1) {
+    sensirion_cmd[0] = (uint8_t) device->part->cmd_set[cmd].cmd;
   } else {
-    sensirion_cmd[0] = (uint8_t) (device_config->cmd_set[cmd].cmd >> 8);
-    sensirion_cmd[1] = (uint8_t) device_config->cmd_set[cmd].cmd;
+    sensirion_cmd[0] = (uint8_t) (device->part->cmd_set[cmd].cmd >> 8);
+    sensirion_cmd[1] = (uint8_t) device->part->cmd_set[cmd].cmd;
   }
   /* Make sure the data pointer is not NULL */
   if(data) {
-    for(i = 0; i < device_config->cmd_set[cmd].datalen; i += 3) {
+    for(i = 0; i < device->part->cmd_set[cmd].datalen; i += 3) {
       sensirion_data[i] = (uint8_t) (data[i / 3] >> 8);        /* MSB first */
       sensirion_data[i + 1] = (uint8_t) data[i / 3];           /* LSB */
-      sensirion_data[i + 2] = crc8_calc_buff(device_config->crc_config, sensirion_data + i, 2);  /* calculate CRC for last 2 bytes */
+      sensirion_data[i + 2] = crc8_calc_word(device->part->crc_config, sensirion_data + i);  /* calculate CRC for last 2 bytes */
     }
   }
 
   /* write the command buffer on i2c bus */
-  bus_status = serial_dev_write(device_config->dev, sensirion_cmd, device_config->cmd_set[cmd].datalen + 2);
+  bus_status = serial_dev_write(device->dev, sensirion_cmd, device->part->cmd_set[cmd].datalen + device->part->cmd_bytes);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION failed to write set command %u\n", bus_status);
-    serial_dev_bus_release(device_config->dev);
+    LOG_ERR("SENSIRION failed to write set command %u\n", bus_status);
+    serial_dev_bus_release(device->dev);
     return bus_status;
   }
 
   /* wait for the response time for this command */
-  clock_wait_ms(device_config->cmd_set[cmd].duration);
+  clock_wait_ms(device->part->cmd_set[cmd].duration);
 
-  return serial_dev_bus_release(device_config->dev);
+  return serial_dev_bus_release(device->dev);
 }
 /*---------------------------------------------------------------------------*/
 uint8_t
-sensirion_read(const sensirion_device_t *device_config, uint16_t *data, int datalen)
+sensirion_read(const sensirion_device_t *device, uint16_t *data, int datalen)
 {
   serial_bus_status_t bus_status;
   uint8_t i;
   uint8_t crc;
   uint8_t sensirion_data[SENSIRION_MAX_GET_PARAM_LENGTH];
 
-  if(SENSIRION_MAX_GET_PARAM_LENGTH < datalen * 3) {
-    PRINTF("SENSIRION invalid datalen\n");
+  if(!sensirion_device_valid(device) || SENSIRION_MAX_GET_PARAM_LENGTH < datalen * 3) {
+    LOG_ERR("SENSIRION invalid datalen\n");
     return BUS_INVALID;
   }
 
   /* acquire I2C bus and proceed with I2C commands */
-  bus_status = serial_dev_bus_acquire(device_config->dev);
+  bus_status = serial_dev_bus_acquire(device->dev);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION couldn't acquire bus %u\n", bus_status);
+    LOG_WARN("SENSIRION couldn't acquire bus %u\n", bus_status);
     return bus_status;
   }
 
   /* read response */
-  bus_status = serial_dev_read(device_config->dev, sensirion_data, datalen * 3);
+  bus_status = serial_dev_read(device->dev, sensirion_data, datalen * 3);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION failed to read get response %u\n", bus_status);
-    serial_dev_bus_release(device_config->dev);
+    LOG_ERR("SENSIRION failed to read get response %u\n", bus_status);
+    serial_dev_bus_release(device->dev);
     return bus_status;
   }
 
@@ -131,67 +129,104 @@ sensirion_read(const sensirion_device_t *device_config, uint16_t *data, int data
   if(data != NULL) {
     for(i = 0; i < datalen * 3; i += 3) {
       /* calculate CRC for next 2 bytes */
-      crc = crc8_calc_buff(device_config->crc_config, sensirion_data + i, 2);
+      crc = crc8_calc_word(device->part->crc_config, sensirion_data + i);
       /* compare calculated CRC with received CRC */
       if(sensirion_data[i + 2] == crc) {
         data[i / 3] = sensirion_data[i] << 8;  /* MSB first */
         data[i / 3] |= sensirion_data[i + 1];  /* LSB */
       } else {
-        PRINTF("SENSIRION CRC failed!!!\n");
-        serial_dev_bus_release(device_config->dev);
+        LOG_ERR("SENSIRION CRC failed!!!\n");
+        serial_dev_bus_release(device->dev);
         return BUS_DATA_NACK;
       }
     }
   }
 
-  return serial_dev_bus_release(device_config->dev);
+  return serial_dev_bus_release(device->dev);
 }
 /*---------------------------------------------------------------------------*/
 uint8_t
-sensirion_get(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen)
+sensirion_send_cmd(const sensirion_device_t *device, uint8_t cmd)
 {
   serial_bus_status_t bus_status;
   uint8_t sensirion_cmd[2];
 
-  /* Sanity check data and datalen first */
-  if((device_config->cmd_set[cmd].datalen == 0 && (data != NULL || datalen != 0))
-     || (device_config->cmd_set[cmd].datalen > 0
-         && (data == NULL || datalen * 3 != device_config->cmd_set[cmd].datalen))
-     || !device_config->cmd_bytes || device_config->cmd_bytes > 2) {
-    PRINTF("SENSIRION invalid data/datalen\n");
+  if(!sensirion_device_valid(device) || cmd >= device->part->cmd_num || !device->part->cmd_bytes || device->part->cmd_bytes > 2) {
+    LOG_ERR("SENSIRION invalid cmd\n");
     return BUS_INVALID;
   }
-
-  if(SENSIRION_MAX_GET_PARAM_LENGTH < device_config->cmd_set[cmd].datalen) {
-    PRINTF("SENSIRION invalid param length\n");
-    return BUS_INVALID;
-  }
-
   /* acquire I2C bus and proceed with I2C commands */
-  bus_status = serial_dev_bus_acquire(device_config->dev);
+  bus_status = serial_dev_bus_acquire(device->dev);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION couldn't acquire bus %u\n", bus_status);
+    LOG_WARN("SENSIRION couldn't acquire bus %u\n", bus_status);
     return bus_status;
   }
-  if(device_config->cmd_bytes == 1) {
-    sensirion_cmd[0] = (uint8_t) device_config->cmd_set[cmd].cmd;
+  if(device->part->cmd_bytes == 1) {
+    sensirion_cmd[0] = (uint8_t) device->part->cmd_set[cmd].cmd;
   } else {
-    sensirion_cmd[0] = (uint8_t) (device_config->cmd_set[cmd].cmd >> 8);
-    sensirion_cmd[1] = (uint8_t) device_config->cmd_set[cmd].cmd;
+    sensirion_cmd[0] = (uint8_t) (device->part->cmd_set[cmd].cmd >> 8);
+    sensirion_cmd[1] = (uint8_t) device->part->cmd_set[cmd].cmd;
   }
-  /* write the command to get data */
-  bus_status = serial_dev_write(device_config->dev, sensirion_cmd, device_config->cmd_bytes);
+  bus_status = serial_dev_write(device->dev, sensirion_cmd, device->part->cmd_bytes);
   if(bus_status != BUS_OK) {
-    PRINTF("SENSIRION failed to write get command %u\n", bus_status);
-    serial_dev_bus_release(device_config->dev);
+    LOG_ERR("SENSIRION failed to write get command %u\n", bus_status);
+    serial_dev_bus_release(device->dev);
     return bus_status;
   }
+  /* release the I2C bus, the sensor does not need it while processing the command */
+  return serial_dev_bus_release(device->dev);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+sensirion_get_duration(const sensirion_device_t *device, uint8_t cmd)
+{
+  if(!sensirion_device_valid(device) || cmd >= device->part->cmd_num) {
+    return 0;
+  }
+  return device->part->cmd_set[cmd].duration;
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+sensirion_get(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
+{
+  serial_bus_status_t bus_status;
+
+  /* Sanity check data and datalen first */
+  if(!sensirion_device_valid(device) || cmd >= device->part->cmd_num
+     || (device->part->cmd_set[cmd].datalen == 0 && (data != NULL || datalen != 0))
+     || (device->part->cmd_set[cmd].datalen > 0
+         && (data == NULL || datalen * 3 != device->part->cmd_set[cmd].datalen))
+     || !device->part->cmd_bytes || device->part->cmd_bytes > 2) {
+    LOG_ERR("SENSIRION invalid data/datalen\n");
+    return BUS_INVALID;
+  }
 
+  if(SENSIRION_MAX_GET_PARAM_LENGTH < device->part->cmd_set[cmd].datalen) {
+    LOG_ERR("SENSIRION invalid param length\n");
+    return BUS_INVALID;
+  }
+
+  /* send the command, the I2C bus is not held while the sensor processes it */
+  bus_status = sensirion_send_cmd(device, cmd);
+  if(bus_status != BUS_OK) {
+    return bus_status;
+  }
   /* wait for the response time for this command */
-  clock_wait_ms(device_config->cmd_set[cmd].duration);
-  /* release the I2C bus */
-  serial_dev_bus_release(device_config->dev);
+  clock_wait_ms(device->part->cmd_set[cmd].duration);
   /* read response */
-  return sensirion_read(device_config, data, datalen);
+  return sensirion_read(device, data, datalen);
 }
-/*---------------------------------------------------------------------------*/
\ No newline at end of file
+/*---------------------------------------------------------------------------*/
+uint8_t
+sensirion_execute(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
+{
+  if(!sensirion_device_valid(device) || cmd >= device->part->cmd_num) {
+    LOG_ERR("SENSIRION invalid cmd\n");
+    return BUS_INVALID;
+  }
+  if(device->part->cmd_set[cmd].flags & SENSIRION_CMD_READ) {
+    return sensirion_get(device, cmd, data, datalen);
+  }
+  return sensirion_set(device, cmd, data, datalen);
+}
+/*---------------------------------------------------------------------------*/
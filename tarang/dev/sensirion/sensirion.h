@@ -17,49 +17,89 @@
 #define SENSIRION_PARAM_LENGTH_COLUMN   1   /* array column 1 defines parameter length*/
 #define SENSIRION_DURATION_COLUMN       2   /* array column 2 defines measurement duration in milliseconds */
 
+/* command flags */
+#define SENSIRION_CMD_WRITE             0x01  /* command carries parameters, datalen is the number of bytes written */
+#define SENSIRION_CMD_READ              0x02  /* command returns data, datalen is the number of bytes read */
+
 /*!
  * A Sensiron command
  */
 typedef struct {
   uint16_t cmd;
-  uint8_t datalen;
-  uint8_t duration;
+  uint8_t datalen;      /* parameter/response length in bytes including a CRC byte per word */
+  uint8_t flags;        /* SENSIRION_CMD_WRITE or SENSIRION_CMD_READ, 0 for a plain command */
+  uint16_t duration;    /* processing time in milliseconds */
 } sensirion_cmd_t;
 
 /*!
-* This structure holds pointer to sensirion sensor specific command set, 
-* it's crc configuration and the i2c device structure
+* This structure describes a sensirion part. It holds pointer to the sensor specific
+* command table and it's crc configuration. It is shared by all instances of the part.
 */
 typedef struct {
   const sensirion_cmd_t *cmd_set;
   const crc8_cfg_t *crc_config;
-  serial_dev_t *dev;
   uint8_t cmd_num;
-  const uint8_t cmd_bytes;
+  uint8_t cmd_bytes;
+} sensirion_part_t;
+
+/*!
+* This structure holds one sensor instance, the part description and the i2c device
+* the sensor is connected to.
+*/
+typedef struct {
+  const sensirion_part_t *part;
+  serial_dev_t *dev;
 } sensirion_device_t;
 
 /*!
-* \fn     uint8_t sensirion_set(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen)
+* \fn     uint8_t sensirion_execute(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
+* \brief  function runs given command from the part command table. Depending on the command
+*         flags the parameters are written (sensirion_set) or the response is read (sensirion_get).
+* \param  device pointer to sensor instance.
+* \param  cmd index of the command in the command table.
+* \param  data pointer to parameters or buffer for the response, NULL for plain commands.
+* \param  datalen number of 16 bit words in data.
+* \return function returns i2c bus status. BUS_STATUS_OK upon success.
+*/
+uint8_t sensirion_execute(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen);
+
+/*!
+* \fn     uint8_t sensirion_set(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
 * \brief  function acquires the i2c bus, sends given command with given data as parameters added with crc8 for
 *         each 2 data bytes and wait for amount of duration (in milliseconds)for command to be processed for 
 *         the given sensor. The function releases the i2c bus before returning.
 * \return function returns i2c bus status. BUS_STATUS_OK upon success.
 */
-uint8_t sensirion_set(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen);
+uint8_t sensirion_set(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen);
 
 /*!
-* \fn     uint8_t sensirion_get(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen)
-* \brief  function acquires the i2c bus, sends given command, waits for given duration, read given amount of data,
-*         checks crc, remove crc and updates data. The function releases the i2c bus before returning.
+* \fn     uint8_t sensirion_get(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen)
+* \brief  function sends given command, waits for given duration with the i2c bus released, read given
+*         amount of data, checks crc, remove crc and updates data.
 * \return function returns i2c bus status. BUS_STATUS_OK upon success.
 */
-uint8_t sensirion_get(const sensirion_device_t *device_config, uint8_t cmd, uint16_t *data, int datalen);
+uint8_t sensirion_get(const sensirion_device_t *device, uint8_t cmd, uint16_t *data, int datalen);
+
+/*!
+* \fn     uint8_t sensirion_send_cmd(const sensirion_device_t *device, uint8_t cmd)
+* \brief  function acquires the i2c bus, sends given command without parameters and releases the
+*         i2c bus right away. It does not wait for the command to be processed, the response can be
+*         read with sensirion_read once sensirion_get_duration milliseconds have passed.
+* \return function returns i2c bus status. BUS_STATUS_OK upon success.
+*/
+uint8_t sensirion_send_cmd(const sensirion_device_t *device, uint8_t cmd);
+
+/*!
+* \fn     uint16_t sensirion_get_duration(const sensirion_device_t *device, uint8_t cmd)
+* \brief  function returns the processing time of given command in milliseconds.
+*/
+uint16_t sensirion_get_duration(const sensirion_device_t *device, uint8_t cmd);
 
 /*!
-* \fn     uint8_t sensirion_read(const sensirion_device_t *device_config, uint16_t *data, int datalen)
+* \fn     uint8_t sensirion_read(const sensirion_device_t *device, uint16_t *data, int datalen)
 * \brief  function acquires the i2c bus, reads a given amount of data,
 *         checks crc, remove crc and updates data. The function releases the i2c bus before returning.
 * \return function returns i2c bus status. BUS_STATUS_OK upon success.
 */
-uint8_t sensirion_read(const sensirion_device_t *device_config, uint16_t *data, int datalen);
+uint8_t sensirion_read(const sensirion_device_t *device, uint16_t *data, int datalen);
 #endif /* SENSIRION_H_ */
@@ -0,0 +1,182 @@
+/*!
+ * @file  sht4x-policy.c
+ * @author Varun Marolia
+ * @brief This file implements the SHT4X sampling policy. It picks the measurement
+ *       repeatability and the sampling interval from the recent signal variance so
+ *       that transients are sampled fast and coarse and steady state slow and precise.
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ * 
+ */
+
+#include "sht4x-policy.h"
+
+#define LOG_MODULE LOG_MODULE_SHT4X
+#include "log.h"
+
+const sht4x_policy_cfg_t sht4x_policy_default_cfg = {
+  .interval_ms = {
+    [SHT4X_POLICY_TRANSIENT] = SHT4X_POLICY_TRANSIENT_INTERVAL_MS,
+    [SHT4X_POLICY_NORMAL] = SHT4X_POLICY_NORMAL_INTERVAL_MS,
+    [SHT4X_POLICY_STEADY] = SHT4X_POLICY_STEADY_INTERVAL_MS
+  },
+  .repeatability = {
+    [SHT4X_POLICY_TRANSIENT] = SHT4X_REPEATABILITY_LOW,
+    [SHT4X_POLICY_NORMAL] = SHT4X_REPEATABILITY_MEDIUM,
+    [SHT4X_POLICY_STEADY] = SHT4X_REPEATABILITY_HIGH
+  },
+  .transient_temp_var = SHT4X_POLICY_TRANSIENT_TEMP_VAR,
+  .steady_temp_var = SHT4X_POLICY_STEADY_TEMP_VAR,
+  .transient_rh_var = SHT4X_POLICY_TRANSIENT_RH_VAR,
+  .steady_rh_var = SHT4X_POLICY_STEADY_RH_VAR,
+  .steady_samples = SHT4X_POLICY_STEADY_SAMPLES,
+  .ewma_shift = SHT4X_POLICY_EWMA_SHIFT
+};
+/*---------------------------------------------------------------------------*/
+/* updates the moving mean and variance with a new sample */
+static void
+ewma_update(int32_t sample, int32_t *mean, uint32_t *var, uint8_t shift)
+{
+  int32_t delta = sample - *mean;
+  uint32_t delta_sq;
+  if(delta > SHT4X_POLICY_MAX_DELTA) {
+    delta = SHT4X_POLICY_MAX_DELTA;
+  } else if(delta < -SHT4X_POLICY_MAX_DELTA) {
+    delta = -SHT4X_POLICY_MAX_DELTA;
+  }
+  /* squared unsigned, 60000^2 fits in 32 bits only without the sign */
+  delta_sq = (uint32_t)((delta < 0) ? -delta : delta);
+  delta_sq *= delta_sq;
+  *mean += delta / (1L << shift);
+  if(delta_sq >= *var) {
+    *var += (delta_sq - *var) >> shift;
+  } else {
+    *var -= (*var - delta_sq) >> shift;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+sht4x_policy_set_mode(sht4x_policy_t *policy, sht4x_policy_mode_t mode)
+{
+  if(mode != policy->mode) {
+    LOG_DBG("SHT4X policy mode %u -> %u temp var:%lu rh var:%lu\n", policy->mode, mode,
+            (unsigned long)policy->temp_var, (unsigned long)policy->rh_var);
+    policy->mode = mode;
+    policy->mode_changes++;
+    /* the new interval applies now instead of after the running one, it counts from the result
+       so the conversion time is added once per mode change */
+    timer_set(&policy->sample_timer, policy->cfg->interval_ms[mode]);
+  }
+  sht4x_set_repeatability(policy->sht, policy->cfg->repeatability[mode]);
+}
+/*---------------------------------------------------------------------------*/
+static void
+sht4x_policy_update(sht4x_policy_t *policy)
+{
+  const sht4x_policy_cfg_t *cfg = policy->cfg;
+  int32_t temp_mC;
+  uint16_t rh_percentage_100x;
+  sht4x_get_last_result(policy->sht, &temp_mC, &rh_percentage_100x);
+  policy->mode_samples[policy->mode]++;
+  if(!policy->primed) {
+    policy->temp_mean_mC = temp_mC;
+    policy->rh_mean = rh_percentage_100x;
+    policy->temp_var = 0;
+    policy->rh_var = 0;
+    policy->primed = true;
+    return;
+  }
+  ewma_update(temp_mC, &policy->temp_mean_mC, &policy->temp_var, cfg->ewma_shift);
+  ewma_update(rh_percentage_100x, &policy->rh_mean, &policy->rh_var, cfg->ewma_shift);
+  if(policy->temp_var > cfg->transient_temp_var || policy->rh_var > cfg->transient_rh_var) {
+    policy->quiet_count = 0;
+    sht4x_policy_set_mode(policy, SHT4X_POLICY_TRANSIENT);
+  } else if(policy->temp_var < cfg->steady_temp_var && policy->rh_var < cfg->steady_rh_var) {
+    if(policy->quiet_count < cfg->steady_samples) {
+      policy->quiet_count++;
+    }
+    if(policy->quiet_count >= cfg->steady_samples) {
+      sht4x_policy_set_mode(policy, SHT4X_POLICY_STEADY);
+    } else if(policy->mode == SHT4X_POLICY_TRANSIENT) {
+      sht4x_policy_set_mode(policy, SHT4X_POLICY_NORMAL);
+    }
+  } else {
+    policy->quiet_count = 0;
+    sht4x_policy_set_mode(policy, SHT4X_POLICY_NORMAL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+sht4x_policy_reset(sht4x_policy_t *policy)
+{
+  if(policy == NULL) {
+    return;
+  }
+  policy->primed = false;
+  policy->quiet_count = 0;
+  policy->temp_var = 0;
+  policy->rh_var = 0;
+  sht4x_policy_set_mode(policy, SHT4X_POLICY_NORMAL);
+  timer_set(&policy->sample_timer, 0);    /* next measurement right away */
+}
+/*---------------------------------------------------------------------------*/
+void
+sht4x_policy_init(sht4x_policy_t *policy, sht4x_t *sht, const sht4x_policy_cfg_t *cfg)
+{
+  uint8_t i;
+  if(policy == NULL) {
+    return;
+  }
+  policy->sht = sht;
+  policy->cfg = (cfg != NULL) ? cfg : &sht4x_policy_default_cfg;
+  policy->mode = SHT4X_POLICY_NORMAL;
+  policy->mode_changes = 0;
+  for(i = 0; i < SHT4X_POLICY_MODE_COUNT; i++) {
+    policy->mode_samples[i] = 0;
+  }
+  sht4x_policy_reset(policy);
+}
+/*---------------------------------------------------------------------------*/
+bool
+sht4x_policy_poll(sht4x_policy_t *policy)
+{
+  sht4x_result_t result;
+  if(policy == NULL || policy->sht == NULL) {
+    return false;
+  }
+  result = sht4x_poll_result(policy->sht);
+  if(result == SHT4X_RESULT_READY) {
+    sht4x_policy_update(policy);
+    return true;
+  }
+  if(result == SHT4X_RESULT_IDLE && timer_timedout(&policy->sample_timer)) {
+    /* the interval runs from start to start, so it does not include the conversion time */
+    timer_set(&policy->sample_timer, policy->cfg->interval_ms[policy->mode]);
+    sht4x_start_measurement(policy->sht);
+  }
+  return false;
+}
+/*---------------------------------------------------------------------------*/
+sht4x_policy_mode_t
+sht4x_policy_get_mode(const sht4x_policy_t *policy)
+{
+  return policy->mode;
+}
+/*---------------------------------------------------------------------------*/
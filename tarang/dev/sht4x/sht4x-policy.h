@@ -0,0 +1,100 @@
+/*!
+*\file  sht4x-policy.h
+*\brief This file holds the SHT4X sampling policy. The policy tracks the running variance of
+*       temperature and humidity and picks the measurement repeatability and the sampling
+*       interval from it:
+*         TRANSIENT  signal is changing, sample fast with low repeatability (2 ms conversion)
+*         NORMAL     in between, medium repeatability
+*         STEADY     signal is flat, sample slow with high repeatability (9 ms conversion)
+*       The variance is an exponentially weighted moving average of the squared deviation
+*       from the moving mean, all in integer math.
+*/
+
+#ifndef _SHT4X_POLICY_H_
+#define _SHT4X_POLICY_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include "sht4x.h"
+#include "timer.h"
+
+typedef enum sht4x_policy_mode {
+  SHT4X_POLICY_TRANSIENT = 0,
+  SHT4X_POLICY_NORMAL,
+  SHT4X_POLICY_STEADY,
+  SHT4X_POLICY_MODE_COUNT
+} sht4x_policy_mode_t;
+
+/* default configuration */
+#define SHT4X_POLICY_TRANSIENT_INTERVAL_MS    250
+#define SHT4X_POLICY_NORMAL_INTERVAL_MS       1000
+#define SHT4X_POLICY_STEADY_INTERVAL_MS       5000
+#define SHT4X_POLICY_TRANSIENT_TEMP_VAR       250000UL  /* (0.5 'C)^2 in mC^2 */
+#define SHT4X_POLICY_STEADY_TEMP_VAR          22500UL   /* (0.15 'C)^2 in mC^2 */
+#define SHT4X_POLICY_TRANSIENT_RH_VAR         40000UL   /* (2 %RH)^2 in (%RH x 100)^2 */
+#define SHT4X_POLICY_STEADY_RH_VAR            2500UL    /* (0.5 %RH)^2 in (%RH x 100)^2 */
+#define SHT4X_POLICY_STEADY_SAMPLES           8         /* quiet samples in a row before going to steady */
+#define SHT4X_POLICY_EWMA_SHIFT               3         /* EWMA weight 1/8 */
+#define SHT4X_POLICY_MAX_DELTA                60000L    /* deviations are clamped so that the square fits in uint32_t */
+
+typedef struct sht4x_policy_cfg {
+  uint32_t interval_ms[SHT4X_POLICY_MODE_COUNT];              /* sampling interval per mode */
+  sht4x_repeatability_t repeatability[SHT4X_POLICY_MODE_COUNT]; /* repeatability per mode */
+  uint32_t transient_temp_var;    /* temperature variance above this is a transient, mC^2 */
+  uint32_t steady_temp_var;       /* temperature variance below this is steady, mC^2 */
+  uint32_t transient_rh_var;      /* humidity variance above this is a transient, (%RH x 100)^2 */
+  uint32_t steady_rh_var;         /* humidity variance below this is steady, (%RH x 100)^2 */
+  uint8_t steady_samples;         /* quiet samples in a row before going to steady */
+  uint8_t ewma_shift;             /* EWMA weight is 1 / 2^ewma_shift */
+} sht4x_policy_cfg_t;
+
+typedef struct sht4x_policy {
+  sht4x_t *sht;
+  const sht4x_policy_cfg_t *cfg;
+  sht4x_policy_mode_t mode;                   /* current mode */
+  ttimer_t sample_timer;                      /* time of the next measurement */
+  bool primed;                                /* false until the first sample seeded the mean */
+  int32_t temp_mean_mC;                       /* moving mean of temperature */
+  uint32_t temp_var;                          /* moving variance of temperature, mC^2 */
+  int32_t rh_mean;                            /* moving mean of humidity, %RH x 100 */
+  uint32_t rh_var;                            /* moving variance of humidity, (%RH x 100)^2 */
+  uint8_t quiet_count;                        /* quiet samples in a row */
+  uint32_t mode_samples[SHT4X_POLICY_MODE_COUNT]; /* samples taken in each mode */
+  uint32_t mode_changes;                      /* number of mode changes */
+} sht4x_policy_t;
+
+extern const sht4x_policy_cfg_t sht4x_policy_default_cfg;
+
+/*!
+* \fn     void sht4x_policy_init(sht4x_policy_t *policy, sht4x_t *sht, const sht4x_policy_cfg_t *cfg)
+* \brief  Function initializes the policy. The sensor must be initialized with sht4x_init.
+*         The policy starts in NORMAL mode and the first measurement is started on the next poll.
+* \param  policy pointer to policy structure.
+* \param  sht pointer to sensor driven by the policy.
+* \param  cfg pointer to configuration, NULL for sht4x_policy_default_cfg.
+*/
+void sht4x_policy_init(sht4x_policy_t *policy, sht4x_t *sht, const sht4x_policy_cfg_t *cfg);
+
+/*!
+* \fn     void sht4x_policy_reset(sht4x_policy_t *policy)
+* \brief  Function drops the collected variance and goes back to NORMAL mode, e.g. after the
+*         samples were disturbed by a heater pulse. The next measurement starts on the next poll.
+* \param  policy pointer to policy structure.
+*/
+void sht4x_policy_reset(sht4x_policy_t *policy);
+
+/*!
+* \fn     bool sht4x_policy_poll(sht4x_policy_t *policy)
+* \brief  Function starts a measurement when the interval of the current mode has passed and
+*         collects its result without blocking. Each new sample updates the statistics and
+*         selects the mode for the next measurement. Call this from the application poll loop.
+* \param  policy pointer to policy structure.
+* \return Function returns true when a new sample is available through sht4x_get_last_result.
+*/
+bool sht4x_policy_poll(sht4x_policy_t *policy);
+
+/*!
+* \fn     sht4x_policy_mode_t sht4x_policy_get_mode(const sht4x_policy_t *policy)
+* \brief  Function returns the current mode of the policy.
+*/
+sht4x_policy_mode_t sht4x_policy_get_mode(const sht4x_policy_t *policy);
+#endif /* _SHT4X_POLICY_H_ */
@@ -0,0 +1,154 @@
+/*!
+ * @file  sht4x-recovery.c
+ * @author Varun Marolia
+ * @brief This file implements the SHT4X condensation recovery scheduler. A
+ *       saturated sensor is dried with a heater pulse in the background and the
+ *       samples taken while it cools down are flagged.
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ * 
+ */
+
+#include "sht4x-recovery.h"
+
+#define LOG_MODULE LOG_MODULE_SHT4X
+#include "log.h"
+
+/*---------------------------------------------------------------------------*/
+static void
+sht4x_recovery_store_sample(sht4x_recovery_t *rec)
+{
+  sht4x_get_last_result(rec->sht, &rec->good_temp_mC, &rec->good_rh_100x);
+  rec->good_valid = true;
+}
+/*---------------------------------------------------------------------------*/
+static bool
+sht4x_recovery_start_pulse(sht4x_recovery_t *rec)
+{
+  sht4x_heater_t heater;
+  if(rec->pulses_in_row >= SHT4X_RECOVERY_MAX_PULSES) {
+    return false;   /* still wet after several pulses, likely real saturation. Wait for it to drop */
+  }
+  if(rec->pulse_done && !timer_timedout(&rec->pulse_timer)) {
+    return false;   /* keep the heater duty cycle low */
+  }
+  /* start gentle, use full power if the sensor is still wet after the first pulse */
+  heater = (rec->pulses_in_row == 0) ? SHT4X_HEATER_110MW_1S : SHT4X_HEATER_200MW_1S;
+  if(sht4x_start_heater(rec->sht, heater) != BUS_OK) {
+    return false;
+  }
+  LOG_INFO("SHT4X recovery: heater pulse %u started\n", heater);
+  timer_set(&rec->pulse_timer, SHT4X_RECOVERY_MIN_INTERVAL_MS);
+  rec->pulse_done = true;
+  rec->pulses_in_row++;
+  rec->saturated_count = 0;
+  rec->state = SHT4X_RECOVERY_HEATING;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+void
+sht4x_recovery_init(sht4x_recovery_t *rec, sht4x_t *sht, sht4x_policy_t *policy)
+{
+  if(rec == NULL) {
+    return;
+  }
+  rec->sht = sht;
+  rec->policy = policy;
+  rec->state = SHT4X_RECOVERY_MONITOR;
+  rec->pulse_done = false;
+  rec->saturated_count = 0;
+  rec->pulses_in_row = 0;
+  rec->good_valid = false;
+  rec->flagged_samples = 0;
+}
+/*---------------------------------------------------------------------------*/
+sht4x_recovery_event_t
+sht4x_recovery_poll(sht4x_recovery_t *rec)
+{
+  sht4x_result_t result;
+  if(rec == NULL || rec->sht == NULL || rec->policy == NULL) {
+    return SHT4X_RECOVERY_EVENT_NONE;
+  }
+  switch(rec->state) {
+    case SHT4X_RECOVERY_MONITOR:
+      if(!sht4x_policy_poll(rec->policy)) {
+        return SHT4X_RECOVERY_EVENT_NONE;
+      }
+      sht4x_recovery_store_sample(rec);
+      if(rec->good_rh_100x < SHT4X_RECOVERY_SATURATION_RH) {
+        rec->saturated_count = 0;
+        rec->pulses_in_row = 0;
+      } else if(++rec->saturated_count >= SHT4X_RECOVERY_SATURATION_SAMPLES) {
+        /* the sensor is idle right after a result, start the pulse now */
+        if(sht4x_recovery_start_pulse(rec)) {
+          return SHT4X_RECOVERY_EVENT_HEATER_START;
+        }
+      }
+      return SHT4X_RECOVERY_EVENT_SAMPLE;
+    case SHT4X_RECOVERY_HEATING:
+      result = sht4x_poll_result(rec->sht);
+      if(result == SHT4X_RESULT_PENDING) {
+        return SHT4X_RECOVERY_EVENT_NONE;
+      }
+      /* pulse is over (or failed), let the sensor cool down before trusting it again */
+      timer_set(&rec->state_timer, SHT4X_RECOVERY_BLACKOUT_MS);
+      rec->state = SHT4X_RECOVERY_BLACKOUT;
+      return SHT4X_RECOVERY_EVENT_NONE;
+    case SHT4X_RECOVERY_BLACKOUT:
+      if(timer_timedout(&rec->state_timer) && rec->sht->state == SHT4X_STATE_IDLE) {
+        /* the hot samples disturbed the variance, start the policy statistics over */
+        sht4x_policy_reset(rec->policy);
+        rec->state = SHT4X_RECOVERY_MONITOR;
+        LOG_INFO("SHT4X recovery: blackout over\n");
+        return SHT4X_RECOVERY_EVENT_NONE;
+      }
+      if(sht4x_policy_poll(rec->policy)) {
+        rec->flagged_samples++;
+        return SHT4X_RECOVERY_EVENT_FLAGGED;
+      }
+      return SHT4X_RECOVERY_EVENT_NONE;
+    default:
+      rec->state = SHT4X_RECOVERY_MONITOR;
+      break;
+  }
+  return SHT4X_RECOVERY_EVENT_NONE;
+}
+/*---------------------------------------------------------------------------*/
+bool
+sht4x_recovery_get_value(const sht4x_recovery_t *rec, int32_t *temp_mC, uint16_t *rh_percentage_100x)
+{
+  if(rec == NULL || !rec->good_valid) {
+    return false;
+  }
+  if(temp_mC != NULL) {
+    *temp_mC = rec->good_temp_mC;
+  }
+  if(rh_percentage_100x != NULL) {
+    *rh_percentage_100x = rec->good_rh_100x;
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+sht4x_recovery_in_blackout(const sht4x_recovery_t *rec)
+{
+  return rec != NULL && rec->state != SHT4X_RECOVERY_MONITOR;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,91 @@
+/*!
+*\file  sht4x-recovery.h
+*\brief This file holds the SHT4X condensation recovery scheduler. In a humid duct the sensor
+*       can get wet and read close to 100 %RH for hours. The scheduler watches the samples
+*       taken through the sampling policy, and once the humidity stays saturated it runs a
+*       heater pulse in the background to dry the sensor. The samples taken while the sensor
+*       cools down again are flagged and the last good sample is kept for the control loops.
+*
+*       States:
+*         MONITOR   normal sampling, saturation detection
+*         HEATING   heater pulse running, no sampling
+*         BLACKOUT  sensor cooling down, samples are flagged
+*/
+
+#ifndef _SHT4X_RECOVERY_H_
+#define _SHT4X_RECOVERY_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include "sht4x.h"
+#include "sht4x-policy.h"
+#include "timer.h"
+
+#define SHT4X_RECOVERY_SATURATION_RH        9500    /* %RH x 100 at or above this counts as saturated */
+#define SHT4X_RECOVERY_SATURATION_SAMPLES   5       /* saturated samples in a row before heating */
+#define SHT4X_RECOVERY_BLACKOUT_MS          10000   /* samples are flagged for this long after a pulse */
+#define SHT4X_RECOVERY_MIN_INTERVAL_MS      60000   /* min time between pulse starts, keeps heater duty low */
+#define SHT4X_RECOVERY_MAX_PULSES           5       /* pulses in a row before giving up until humidity drops */
+
+typedef enum sht4x_recovery_state {
+  SHT4X_RECOVERY_MONITOR = 0,
+  SHT4X_RECOVERY_HEATING,
+  SHT4X_RECOVERY_BLACKOUT
+} sht4x_recovery_state_t;
+
+typedef enum sht4x_recovery_event {
+  SHT4X_RECOVERY_EVENT_NONE = 0,      /* nothing new */
+  SHT4X_RECOVERY_EVENT_SAMPLE,        /* new good sample */
+  SHT4X_RECOVERY_EVENT_FLAGGED,       /* new sample taken during blackout, not used as good value */
+  SHT4X_RECOVERY_EVENT_HEATER_START   /* a heater pulse was started */
+} sht4x_recovery_event_t;
+
+typedef struct sht4x_recovery {
+  sht4x_t *sht;
+  sht4x_policy_t *policy;               /* sampling policy, paused while heating */
+  sht4x_recovery_state_t state;
+  ttimer_t state_timer;                 /* blackout timer */
+  ttimer_t pulse_timer;                 /* min interval between pulses */
+  bool pulse_done;                      /* true once a pulse was started, pulse_timer is valid */
+  uint8_t saturated_count;              /* saturated samples in a row */
+  uint8_t pulses_in_row;                /* pulses without the humidity leaving saturation */
+  int32_t good_temp_mC;                 /* last good temperature */
+  uint16_t good_rh_100x;                /* last good humidity, %RH x 100 */
+  bool good_valid;                      /* true once a good sample was taken */
+  uint32_t flagged_samples;             /* samples dropped during blackout */
+} sht4x_recovery_t;
+
+/*!
+* \fn     void sht4x_recovery_init(sht4x_recovery_t *rec, sht4x_t *sht, sht4x_policy_t *policy)
+* \brief  Function initializes the scheduler. The policy must be initialized for the same sensor.
+* \param  rec pointer to recovery structure.
+* \param  sht pointer to sensor.
+* \param  policy pointer to sampling policy of the sensor.
+*/
+void sht4x_recovery_init(sht4x_recovery_t *rec, sht4x_t *sht, sht4x_policy_t *policy);
+
+/*!
+* \fn     sht4x_recovery_event_t sht4x_recovery_poll(sht4x_recovery_t *rec)
+* \brief  Function runs the sampling policy and the recovery state machine without blocking.
+*         Call this from the application poll loop instead of sht4x_policy_poll.
+* \param  rec pointer to recovery structure.
+* \return Function returns what happened in this call, see sht4x_recovery_event_t.
+*/
+sht4x_recovery_event_t sht4x_recovery_poll(sht4x_recovery_t *rec);
+
+/*!
+* \fn     bool sht4x_recovery_get_value(const sht4x_recovery_t *rec, int32_t *temp_mC, uint16_t *rh_percentage_100x)
+* \brief  Function returns the last good sample. During heating and blackout this is the last
+*         sample before the pulse.
+* \param  rec pointer to recovery structure.
+* \param  temp_mC pointer to variable to store temperature in millidegree Celsius.
+* \param  rh_percentage_100x pointer to variable to store relative humidity in percentage scaled by 100.
+* \return Function returns false if there is no good sample yet.
+*/
+bool sht4x_recovery_get_value(const sht4x_recovery_t *rec, int32_t *temp_mC, uint16_t *rh_percentage_100x);
+
+/*!
+* \fn     bool sht4x_recovery_in_blackout(const sht4x_recovery_t *rec)
+* \brief  Function returns true while the sensor is heating or cooling down.
+*/
+bool sht4x_recovery_in_blackout(const sht4x_recovery_t *rec);
+#endif /* _SHT4X_RECOVERY_H_ */
@@ -29,20 +29,15 @@
 #include "timer.h"          /* included for startup and measurement sampling timer */
 #include "sht4x.h"
 
-#define DEBUG_SHT4X  0 /**< This macro enables/disables the debug printf for this file */
-
-#if DEBUG_SHT4X
-#include <stdio.h>
-#undef PRINTF
-#define PRINTF(...) printf(__VA_ARGS__)
-#else   /* DEBUG_SHT4X */
-#define PRINTF(...)                       /**< Replace printf with nothing */
-#endif  /* DEBUG_SHT4X */
+#define LOG_MODULE LOG_MODULE_SHT4X
+#include "log.h"
 
+CRC8_TABLE_DEFINE(sht4x_crc_table, SHT4X_CRC8_POLYNOMIAL);
 static const crc8_cfg_t sht4x_crc_cfg = {
   .polynomial = SHT4X_CRC8_POLYNOMIAL,
   .intial_remainder = SHT4X_CRC8_INITIAL_REMAINDER,
-  .final_xor_value = SHT4X_CRC8_FINAL_XOR_VALUE
+  .final_xor_value = SHT4X_CRC8_FINAL_XOR_VALUE,
+  .table = sht4x_crc_table
 };
 
 typedef enum {
@@ -60,23 +55,23 @@ typedef enum {
 } sht4x_cmd;
 
 static const sensirion_cmd_t sht4x_commands[] = {
-/* cmd, read/write data length, response time in milliseconds */
-  {0xFD, 6, 9},     /* Single shot measurement, High repeatability, Clock stretching Disabled */
-  {0xF6, 6, 5},     /* Single shot measurement, Medium repeatability, Clock stretching Disabled */
-  {0xE0, 6, 2},     /* Single shot measurement, Low repeatability, Clock stretching Disabled */
-  {0x89, 6, 2},     /* read chip serial number */
-  {0x94, 0, 2},     /* Soft reset command. The system must be in idle state (not performing measurement) before issuing. */
-  {0x39, 6, 1},     /* Activate heater 200mW for 1s, including a high precision measurement before deactivation */
-  {0x32, 6, 1},     /* Activate heater 200mW for 0.1s, including a high precision measurement before deactivation */
-  {0x2F, 6, 1},     /* Activate heater 110mW for 1s, including a high precision measurement before deactivation */
-  {0x24, 6, 1},     /* Activate heater 110mW for 0.1s, including a high precision measurement before deactivation */
-  {0x1E, 6, 1},     /* Activate heater 20mW for 1s, including a high precision measurement before deactivation */
-  {0x15, 6, 1},     /* Activate heater 20mW for 0.1s, including a high precision measurement before deactivation */
+/* cmd, read/write data length, flags, response time in milliseconds */
+  {0xFD, 6, SENSIRION_CMD_READ, 9},     /* Single shot measurement, High repeatability, Clock stretching Disabled */
+  {0xF6, 6, SENSIRION_CMD_READ, 5},     /* Single shot measurement, Medium repeatability, Clock stretching Disabled */
+  {0xE0, 6, SENSIRION_CMD_READ, 2},     /* Single shot measurement, Low repeatability, Clock stretching Disabled */
+  {0x89, 6, SENSIRION_CMD_READ, 2},     /* read chip serial number */
+  {0x94, 0, 0, 2},                      /* Soft reset command. The system must be in idle state (not performing measurement) before issuing. */
+  {0x39, 6, SENSIRION_CMD_READ, 1100},  /* Activate heater 200mW for 1s, including a high precision measurement before deactivation */
+  {0x32, 6, SENSIRION_CMD_READ, 110},   /* Activate heater 200mW for 0.1s, including a high precision measurement before deactivation */
+  {0x2F, 6, SENSIRION_CMD_READ, 1100},  /* Activate heater 110mW for 1s, including a high precision measurement before deactivation */
+  {0x24, 6, SENSIRION_CMD_READ, 110},   /* Activate heater 110mW for 0.1s, including a high precision measurement before deactivation */
+  {0x1E, 6, SENSIRION_CMD_READ, 1100},  /* Activate heater 20mW for 1s, including a high precision measurement before deactivation */
+  {0x15, 6, SENSIRION_CMD_READ, 110},   /* Activate heater 20mW for 0.1s, including a high precision measurement before deactivation */
 };
-static sensirion_device_t sht4x_device_config = {
+/* part description shared by all SHT4X instances. The heater durations are the max pulse length from the datasheet */
+static const sensirion_part_t sht4x_part = {
   .cmd_set = sht4x_commands,
   .crc_config = &sht4x_crc_cfg,
-  .dev = NULL,
   .cmd_num = sizeof(sht4x_commands) / sizeof(sensirion_cmd_t),
   .cmd_bytes = 1
 };
@@ -91,60 +86,180 @@ sht4x_init(sht4x_t *sht)
   /* turn ON power - must include 2 ms startup delay */
     SHT4X_POWER_ON();
 #endif  /* SHT4X_POWER_ON() */
-    sht4x_device_config.dev = sht->sht4x_dev;
+    sht->sensirion.part = &sht4x_part;
+    sht->sensirion.dev = sht->sht4x_dev;
+    sht->state = SHT4X_STATE_IDLE;
     /* read status register for probing purposes*/
-    sht4x_status = sensirion_get(&sht4x_device_config, SHT4X_READ_SERIAL_NUMBER, sht4x_serial, 2);
+    sht4x_status = sensirion_execute(&sht->sensirion, SHT4X_READ_SERIAL_NUMBER, sht4x_serial, 2);
     if(sht4x_status != BUS_OK) {
-      PRINTF("SHT4X failed to read serial number!!!\n");
+      LOG_ERR("SHT4X failed to read serial number!!!\n");
     } else {
       sht->serial_number = sht4x_serial[0]; /* MSB */
       sht->serial_number = sht->serial_number << 16;
       sht->serial_number |= sht4x_serial[1]; /* LSB */
-      PRINTF("SHT4X serial number:0x%04X\n", sht->serial_number);
+      LOG_DBG("SHT4X serial number:0x%04X\n", sht->serial_number);
     }
   }
   sht4x_status = BUS_INVALID;
   return sht4x_status;
 }
 /*---------------------------------------------------------------------------*/
-serial_bus_status_t
-sht4x_take_single_measurement(sht4x_t *sht)
+static serial_bus_status_t
+sht4x_read_result(sht4x_t *sht, uint32_t *temp_mk, uint32_t *rh_ppm)
 {
   serial_bus_status_t sht4x_status;
   uint16_t sht4x_data[2];
   int32_t rh_value;
-  if(sht !=NULL && sht->sht4x_dev != NULL) {
-    sht4x_device_config.dev = sht->sht4x_dev;
-    /* It is assumed here that the sensor is not configured in continuous mode */
-    /* Configure measurement type here. Single shot measurement with high repeatability and clock stretching disabled */
-    sht4x_status = sensirion_get(&sht4x_device_config, SHT4X_SINGLE_MEASUREMENT_HIGH_REP_CLKSTRETCH_DISABLE, sht4x_data, 2);
-    if(sht4x_status != BUS_OK) {
-      PRINTF("SHT4X failed to read data!!!\n");
-      return sht4x_status;
-    }
-    /**
-      * convert temperature into millikelvin from raw reading
-      * T[C] = -45 + 175 * (measurement value) / 65535
-      * T[mK] = T[mC] + 273150
-      * T[mK] = 228150 + (267 * (measurement value)) / 100
-    */
-    sht->last_temp_mk = (sht4x_data[0] * 267) / 100 + 228150;
-    /**
-     * convert RH into %
-     *  RH[%] = -6 + 125 * (Measurement value) / 65535
-     * */
-    rh_value = (int32_t)(((sht4x_data[1] * 125 * 10000ULL) / 65535) - 60000); /* 10,000 times scaled to get ppm */
-    if(rh_value < 0) {
-      sht->last_rh_ppm = 0;
-    } else if(rh_value > 1000000UL) {
-      sht->last_rh_ppm = 1000000;
-    } else {
-      sht->last_rh_ppm = (uint32_t)rh_value;
-    }
+  sht4x_status = sensirion_read(&sht->sensirion, sht4x_data, 2);
+  if(sht4x_status != BUS_OK) {
+    return sht4x_status;
+  }
+  /**
+    * convert temperature into millikelvin from raw reading
+    * T[C] = -45 + 175 * (measurement value) / 65535
+    * T[mK] = T[mC] + 273150
+    * T[mK] = 228150 + (267 * (measurement value)) / 100
+  */
+  *temp_mk = (sht4x_data[0] * 267) / 100 + 228150;
+  /**
+   * convert RH into %
+   *  RH[%] = -6 + 125 * (Measurement value) / 65535
+   * */
+  rh_value = (int32_t)(((sht4x_data[1] * 125 * 10000ULL) / 65535) - 60000); /* 10,000 times scaled to get ppm */
+  if(rh_value < 0) {
+    *rh_ppm = 0;
+  } else if(rh_value > 1000000L) {
+    *rh_ppm = 1000000;
+  } else {
+    *rh_ppm = (uint32_t)rh_value;
   }
   return BUS_OK;
 }
 /*---------------------------------------------------------------------------*/
+static serial_bus_status_t
+sht4x_start_cmd(sht4x_t *sht, uint8_t cmd)
+{
+  serial_bus_status_t sht4x_status;
+  if(sht == NULL || sht->sensirion.dev == NULL) {
+    return BUS_INVALID;     /* sht4x_init was not called */
+  }
+  if(sht->state == SHT4X_STATE_MEASURING) {
+    return BUS_LOCKED;
+  }
+  /* It is assumed here that the sensor is not configured in continuous mode */
+  sht4x_status = sensirion_send_cmd(&sht->sensirion, cmd);
+  if(sht4x_status != BUS_OK) {
+    LOG_ERR("SHT4X failed to start measurement!!!\n");
+    return sht4x_status;
+  }
+  /* one extra ms as the start may be anywhere within the current clock tick */
+  timer_set(&sht->conversion_timer, sensirion_get_duration(&sht->sensirion, cmd) + 1);
+  sht->read_retries = SHT4X_READ_RETRIES;
+  sht->measuring_cmd = cmd;
+  sht->read_status = BUS_OK;
+  sht->state = SHT4X_STATE_MEASURING;
+  return BUS_OK;
+}
+/*---------------------------------------------------------------------------*/
+void
+sht4x_set_repeatability(sht4x_t *sht, sht4x_repeatability_t repeatability)
+{
+  if(sht != NULL && repeatability < SHT4X_REPEATABILITY_COUNT) {
+    sht->repeatability = repeatability;
+  }
+}
+/*---------------------------------------------------------------------------*/
+const sht4x_stats_t *
+sht4x_get_stats(sht4x_t *sht)
+{
+  if(sht == NULL) {
+    return NULL;
+  }
+  return &sht->stats;
+}
+/*---------------------------------------------------------------------------*/
+serial_bus_status_t
+sht4x_start_measurement(sht4x_t *sht)
+{
+  if(sht == NULL) {
+    return BUS_INVALID;
+  }
+  /* measurement commands are in the same order as the repeatability */
+  return sht4x_start_cmd(sht, SHT4X_SINGLE_MEASUREMENT_HIGH_REP_CLKSTRETCH_DISABLE + sht->repeatability);
+}
+/*---------------------------------------------------------------------------*/
+serial_bus_status_t
+sht4x_start_heater(sht4x_t *sht, sht4x_heater_t heater)
+{
+  if(heater >= SHT4X_HEATER_COUNT) {
+    return BUS_INVALID;
+  }
+  /* heater commands are in the same order as sht4x_heater_t */
+  return sht4x_start_cmd(sht, SHT4X_HEATER_ENABLE_200MW_1SEC + heater);
+}
+/*---------------------------------------------------------------------------*/
+sht4x_result_t
+sht4x_poll_result(sht4x_t *sht)
+{
+  serial_bus_status_t sht4x_status;
+  uint32_t temp_mk;
+  uint32_t rh_ppm;
+  uint16_t duration;
+  if(sht == NULL || sht->state != SHT4X_STATE_MEASURING) {
+    return SHT4X_RESULT_IDLE;
+  }
+  if(!timer_timedout(&sht->conversion_timer)) {
+    return SHT4X_RESULT_PENDING;
+  }
+  sht4x_status = sht4x_read_result(sht, &temp_mk, &rh_ppm);
+  if(sht4x_status == BUS_ADDRESS_NACK && sht->read_retries) {
+    /* sensor NACKs its address until the conversion is done, try again in a ms */
+    sht->read_retries--;
+    timer_set(&sht->conversion_timer, 1);
+    return SHT4X_RESULT_PENDING;
+  }
+  sht->state = SHT4X_STATE_IDLE;
+  sht->read_status = sht4x_status;
+  if(sht4x_status != BUS_OK) {
+    sht->stats.errors++;
+    LOG_ERR("SHT4X failed to read data!!!\n");
+    return SHT4X_RESULT_ERROR;
+  }
+  duration = sensirion_get_duration(&sht->sensirion, sht->measuring_cmd);
+  if(sht->measuring_cmd >= SHT4X_HEATER_ENABLE_200MW_1SEC) {
+    /* the measurement at the end of a heater pulse is taken on a hot sensor, do not report it */
+    sht->stats.heater_pulses++;
+    sht->stats.heater_ms += duration;
+    return SHT4X_RESULT_HEATER_DONE;
+  }
+  sht->last_temp_mk = temp_mk;
+  sht->last_rh_ppm = rh_ppm;
+  sht->stats.samples[sht->measuring_cmd - SHT4X_SINGLE_MEASUREMENT_HIGH_REP_CLKSTRETCH_DISABLE]++;
+  sht->stats.conversion_ms += duration;
+  return SHT4X_RESULT_READY;
+}
+/*---------------------------------------------------------------------------*/
+serial_bus_status_t
+sht4x_take_single_measurement(sht4x_t *sht)
+{
+  serial_bus_status_t sht4x_status;
+  sht4x_result_t result;
+  sht4x_status = sht4x_start_measurement(sht);
+  if(sht4x_status != BUS_OK) {
+    return sht4x_status;
+  }
+  /* blocking variant, wait for the conversion here */
+  do {
+    clock_wait_ms(1);
+    result = sht4x_poll_result(sht);
+  } while(result == SHT4X_RESULT_PENDING);
+  if(result == SHT4X_RESULT_READY) {
+    return BUS_OK;
+  }
+  /* the measurement was started above, so anything else is a failed result read */
+  return (sht->read_status != BUS_OK) ? sht->read_status : BUS_INVALID;
+}
+/*---------------------------------------------------------------------------*/
 uint32_t
 sht4x_get_serial_id(sht4x_t *sht)
 {
@@ -154,6 +269,20 @@ sht4x_get_serial_id(sht4x_t *sht)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+void
+sht4x_get_last_result(sht4x_t *sht, int32_t *temp_mC, uint16_t *rh_percentage_100x)
+{
+  if(sht == NULL) {
+    return;
+  }
+  if(temp_mC != NULL) {
+    *temp_mC = (int32_t)sht->last_temp_mk - 273150;
+  }
+  if(rh_percentage_100x != NULL) {
+    *rh_percentage_100x = sht->last_rh_ppm / 100; /* convert PPM into %RH  * 100 */
+  }
+}
+/*---------------------------------------------------------------------------*/
 serial_bus_status_t
 shrt4x_get_temp_humidity(sht4x_t *sht, int16_t *temp_mC, uint16_t *rh_percentage_100x)
 {
@@ -161,7 +290,7 @@ shrt4x_get_temp_humidity(sht4x_t *sht, int16_t *temp_mC, uint16_t *rh_percentage
   if(sht != NULL) {
     sht4x_status = sht4x_take_single_measurement(sht); /* take a single measurement */
     if(sht4x_status != BUS_OK) {
-      PRINTF("SHT4X failed to read data!!!\n");
+      LOG_ERR("SHT4X failed to read data!!!\n");
       return sht4x_status;
     }
     if(temp_mC != NULL) {
@@ -19,13 +19,62 @@
 #define SHT4X_H
 #include <stdint.h>
 #include "serial-dev.h"
+#include "timer.h"
 #include "sensirion/sensirion.h"
 
+typedef enum sht4x_state {
+  SHT4X_STATE_IDLE = 0,         /* no measurement in progress */
+  SHT4X_STATE_MEASURING         /* measurement command sent, waiting for the conversion */
+} sht4x_state_t;
+
+typedef enum sht4x_result {
+  SHT4X_RESULT_READY = 0,       /* new measurement is available in last_temp_mk and last_rh_ppm */
+  SHT4X_RESULT_PENDING,         /* conversion still running, poll again later */
+  SHT4X_RESULT_IDLE,            /* no measurement was started */
+  SHT4X_RESULT_ERROR,           /* measurement failed, start a new one */
+  SHT4X_RESULT_HEATER_DONE      /* heater pulse is over, the hot measurement is discarded */
+} sht4x_result_t;
+
+/* repeatability of a single shot measurement. Order matches the measurement commands */
+typedef enum sht4x_repeatability {
+  SHT4X_REPEATABILITY_HIGH = 0,   /* 9 ms conversion, 0.04 'C, 0.08 %RH noise */
+  SHT4X_REPEATABILITY_MEDIUM,     /* 5 ms conversion, 0.07 'C, 0.15 %RH noise */
+  SHT4X_REPEATABILITY_LOW,        /* 2 ms conversion, 0.1 'C, 0.25 %RH noise */
+  SHT4X_REPEATABILITY_COUNT
+} sht4x_repeatability_t;
+
+/* heater pulses. Order matches the heater commands */
+typedef enum sht4x_heater {
+  SHT4X_HEATER_200MW_1S = 0,
+  SHT4X_HEATER_200MW_100MS,
+  SHT4X_HEATER_110MW_1S,
+  SHT4X_HEATER_110MW_100MS,
+  SHT4X_HEATER_20MW_1S,
+  SHT4X_HEATER_20MW_100MS,
+  SHT4X_HEATER_COUNT
+} sht4x_heater_t;
+
+typedef struct sht4x_stats {
+  uint32_t samples[SHT4X_REPEATABILITY_COUNT];  /* successful measurements per repeatability */
+  uint32_t conversion_ms;                       /* total conversion time, the sensor draws its active current meanwhile */
+  uint32_t errors;                              /* failed measurements */
+  uint32_t heater_pulses;                       /* number of heater pulses */
+  uint32_t heater_ms;                           /* total heater on time */
+} sht4x_stats_t;
+
 typedef struct sht4x {
   uint32_t serial_number;
   uint32_t last_temp_mk;
   uint32_t last_rh_ppm;
   serial_dev_t *sht4x_dev;
+  sensirion_device_t sensirion; /* sensirion instance of this sensor, set up by sht4x_init */
+  sht4x_state_t state;          /* measurement state, updated by start and poll functions */
+  ttimer_t conversion_timer;    /* expires once the measurement result can be read */
+  uint8_t read_retries;         /* number of reads left if the sensor is still converting */
+  sht4x_repeatability_t repeatability;  /* repeatability used by the next measurement */
+  uint8_t measuring_cmd;        /* command of the measurement in progress */
+  serial_bus_status_t read_status;  /* bus status of the last result read */
+  sht4x_stats_t stats;
 } sht4x_t;
 
 /*** Following are the macros specific to SHT4x Temperature Humidity sensor ***/
@@ -47,6 +96,7 @@ typedef struct sht4x {
 
 #define SHT4X_SINGLE_MEASUREMENT_MODE       0  /*!< Value when the sensor is in single shot mode */
 #define SHT4X_CONTINUOUS_MEASUREMENT_MODE   1  /*!< Value when the sensor is in continuous mode  */
+#define SHT4X_READ_RETRIES                  3  /*!< Extra reads (1 ms apart) while the sensor NACKs the result read */
 
 /***************************Global function prototypes***************************************/
 /*!
@@ -63,10 +113,69 @@ serial_bus_status_t sht4x_init(sht4x_t *sht);
 *         relative humidity in their respective variables. @note Use this function only when
 *         not in continues measurement mode.
 * \param  sht pointer to structure sht4x.
-* \return Function returns bus status value, 0 (i.e BUS_OK) on success. 
+* \return Function returns bus status value, 0 (i.e BUS_OK) on success. The status of the
+*         failed start or result read otherwise.
 */
 serial_bus_status_t sht4x_take_single_measurement(sht4x_t *sht);
 
+/*!
+* \fn     void sht4x_set_repeatability(sht4x_t *sht, sht4x_repeatability_t repeatability)
+* \brief  Function selects the repeatability of the following measurements. Lower repeatability
+*         has more noise but a shorter conversion time. The default is SHT4X_REPEATABILITY_HIGH.
+* \param  sht pointer to structure sht4x.
+* \param  repeatability new repeatability.
+*/
+void sht4x_set_repeatability(sht4x_t *sht, sht4x_repeatability_t repeatability);
+
+/*!
+* \fn     const sht4x_stats_t *sht4x_get_stats(sht4x_t *sht)
+* \brief  Function returns the measurement statistics of the sensor.
+*/
+const sht4x_stats_t *sht4x_get_stats(sht4x_t *sht);
+
+/*!
+* \fn     serial_bus_status_t sht4x_start_measurement(sht4x_t *sht)
+* \brief  Function sends the single shot measurement command with the selected repeatability and returns
+*         without waiting. The I2C bus is free during the conversion. Call sht4x_poll_result
+*         to fetch the result. @note Use this function only when not in continues measurement mode.
+* \param  sht pointer to structure sht4x.
+* \return Function returns bus status value, 0 (i.e BUS_OK) on success. BUS_LOCKED if a
+*         measurement is already in progress.
+*/
+serial_bus_status_t sht4x_start_measurement(sht4x_t *sht);
+
+/*!
+* \fn     serial_bus_status_t sht4x_start_heater(sht4x_t *sht, sht4x_heater_t heater)
+* \brief  Function starts a heater pulse without waiting. The sensor takes a high repeatability
+*         measurement at the end of the pulse, sht4x_poll_result returns SHT4X_RESULT_HEATER_DONE
+*         for it and the hot reading is not stored. The datasheet limits the heater to a 10% duty cycle.
+* \param  sht pointer to structure sht4x.
+* \param  heater heater power and pulse length.
+* \return Function returns bus status value, 0 (i.e BUS_OK) on success. BUS_LOCKED if a
+*         measurement is in progress.
+*/
+serial_bus_status_t sht4x_start_heater(sht4x_t *sht, sht4x_heater_t heater);
+
+/*!
+* \fn     sht4x_result_t sht4x_poll_result(sht4x_t *sht)
+* \brief  Function checks if the measurement started with sht4x_start_measurement is done.
+*         Once the conversion time has passed the result is read and converted into
+*         millikelvin and relative humidity in their respective variables.
+* \param  sht pointer to structure sht4x.
+* \return Function returns SHT4X_RESULT_READY once, when a new measurement is available.
+*/
+sht4x_result_t sht4x_poll_result(sht4x_t *sht);
+
+/*!
+ * \fn    void sht4x_get_last_result(sht4x_t *sht, int32_t *temp_mC, uint16_t *rh_percentage_100x)
+ * \brief Function returns the last measurement in millidegree Celsius and relative humidity in
+ *        percentage scaled by 100 without talking to the sensor.
+ * \param sht pointer to structure sht4x.
+ * \param temp_mC pointer to variable to store temperature in millidegree Celsius
+ * \param rh_percentage_100x pointer to variable to store relative humidity in percentage scaled by 100
+ */
+void sht4x_get_last_result(sht4x_t *sht, int32_t *temp_mC, uint16_t *rh_percentage_100x);
+
 /*!
  * \fn    uint32_t sht4x_get_serial_id(sht4x_t *sht)
  * \brief Function returns serial ID of the sensor. This function should only be called
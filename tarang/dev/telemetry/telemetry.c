@@ -0,0 +1,311 @@
+/**
+ * @file telemetry.c
+ * @author Varun Marolia
+ * @brief This driver implements a framed binary telemetry stream. Typed samples
+ *        are batched into a frame, protected with a CRC16 trailer, COBS encoded
+ *        and queued on the interrupt driven guart TX buffer, or in a RAM ring that
+ *        telemetry_poll drains into a non blocking sink such as SWO. The caller
+ *        never blocks, a frame that does not fit in the buffer is dropped and shows
+ *        up as a sequence number gap on the receiver.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "telemetry.h"
+#include "crc16.h"
+#include "clock.h"
+#include <string.h>
+#include <stdio.h>
+
+#define LOG_MODULE LOG_MODULE_TELEMETRY
+#include "log.h"
+
+static const crc16_cfg_t telemetry_crc_cfg = {
+  .polynomial = CRC16_CCITT_POLYNOMIAL,
+  .intial_remainder = CRC16_CCITT_INITIAL_REMAINDER,
+  .final_xor_value = CRC16_CCITT_FINAL_XOR_VALUE
+};
+/* Encoded frame buffer. Shared by all the streams, frames are encoded one at a time */
+static uint8_t wire_buff[TELEMETRY_MAX_WIRE_SIZE];
+/* stream used by the binary log back end */
+static telemetry_t *log_stream = NULL;
+/* set while a record is added or a frame is encoded, a log call from within the stream (or an
+   interrupt) is dropped */
+static volatile bool stream_busy = false;
+/*---------------------------------------------------------------------------*/
+static void
+put_u16_le(uint8_t *buff, uint16_t value)
+{
+  buff[0] = (uint8_t)(value & 0xFF);
+  buff[1] = (uint8_t)(value >> 8);
+}
+/*---------------------------------------------------------------------------*/
+static void
+put_u32_le(uint8_t *buff, uint32_t value)
+{
+  buff[0] = (uint8_t)(value & 0xFF);
+  buff[1] = (uint8_t)((value >> 8) & 0xFF);
+  buff[2] = (uint8_t)((value >> 16) & 0xFF);
+  buff[3] = (uint8_t)(value >> 24);
+}
+/*---------------------------------------------------------------------------*/
+static void
+telemetry_start_frame(telemetry_t *tm, uint32_t now_ms)
+{
+  tm->frame[0] = TELEMETRY_VERSION;
+  put_u16_le(&tm->frame[1], tm->seq);
+  put_u32_le(&tm->frame[3], now_ms);
+  tm->frame[7] = 0;   /* record count, updated on flush */
+  tm->frame_length = TELEMETRY_HEADER_SIZE;
+  tm->record_count = 0;
+  tm->frame_start_ms = now_ms;
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_init(telemetry_t *tm, guart_t *uart, uint32_t batch_interval_ms)
+{
+  if(tm == NULL) {
+    return;
+  }
+  tm->uart = uart;
+  tm->sink = NULL;
+  tm->sink_head = 0;
+  tm->sink_tail = 0;
+  tm->batch_interval_ms = batch_interval_ms ? batch_interval_ms : TELEMETRY_DEFAULT_BATCH_MS;
+  tm->seq = 0;
+  tm->frames_sent = 0;
+  tm->frames_dropped = 0;
+  tm->record_count = 0;
+  tm->frame_length = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_set_sink(telemetry_t *tm, uint16_t (*sink)(const uint8_t *data, uint16_t len))
+{
+  if(tm != NULL) {
+    tm->sink = sink;
+    tm->sink_head = 0;
+    tm->sink_tail = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* copies a whole wire frame into the sink ring, or nothing */
+static bool
+telemetry_sink_queue(telemetry_t *tm, const uint8_t *data, uint16_t len)
+{
+  uint16_t used = (tm->sink_head + TELEMETRY_SINK_BUFFER_SIZE - tm->sink_tail) % TELEMETRY_SINK_BUFFER_SIZE;
+  uint16_t i;
+  if(len > TELEMETRY_SINK_BUFFER_SIZE - 1 - used) {
+    return false;
+  }
+  for(i = 0; i < len; i++) {
+    tm->sink_buff[tm->sink_head] = data[i];
+    tm->sink_head = (tm->sink_head + 1) % TELEMETRY_SINK_BUFFER_SIZE;
+  }
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+/* passes the queued bytes to the sink while it takes them, waits at most TELEMETRY_SINK_DRAIN_US */
+static void
+telemetry_sink_drain(telemetry_t *tm)
+{
+  uint32_t start_us = (uint32_t)clock_get_time_us();
+  uint16_t chunk;
+  uint16_t written;
+  while(tm->sink_tail != tm->sink_head) {
+    chunk = (tm->sink_head > tm->sink_tail) ? (tm->sink_head - tm->sink_tail)
+                                            : (TELEMETRY_SINK_BUFFER_SIZE - tm->sink_tail);
+    written = tm->sink(&tm->sink_buff[tm->sink_tail], chunk);
+    tm->sink_tail = (tm->sink_tail + written) % TELEMETRY_SINK_BUFFER_SIZE;
+    if(written < chunk && ((uint32_t)clock_get_time_us() - start_us) >= TELEMETRY_SINK_DRAIN_US) {
+      break;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+telemetry_log_backend(uint8_t module, uint8_t level, const char *fmt, va_list args)
+{
+  uint8_t data[TELEMETRY_LOG_MAX_TEXT + 2];   /* level + text + vsnprintf terminator */
+  int length;
+  if(log_stream == NULL || stream_busy) {
+    return;
+  }
+  data[0] = level;
+  length = vsnprintf((char *)&data[1], sizeof(data) - 1, fmt, args);
+  if(length < 0) {
+    return;
+  }
+  if(length > TELEMETRY_LOG_MAX_TEXT) {
+    length = TELEMETRY_LOG_MAX_TEXT;
+  }
+  if(length && data[length] == '\n') {
+    length--;   /* records are already separated, drop the line end */
+  }
+  telemetry_add_record(log_stream, TELEMETRY_TYPE_LOG, module, data, (uint8_t)(length + 1));
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_set_log_stream(telemetry_t *tm)
+{
+  log_stream = tm;
+  log_set_backend(tm != NULL ? telemetry_log_backend : NULL);
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_flush(telemetry_t *tm)
+{
+  uint16_t crc;
+  uint16_t encoded_length;
+  bool queued, busy;
+  if(tm == NULL || tm->record_count == 0) {
+    return true;
+  }
+  /* wire_buff and the frame are shared with the log back end, also when called directly */
+  busy = stream_busy;
+  stream_busy = true;
+  tm->frame[7] = tm->record_count;
+  crc = crc16_calc_buff(&telemetry_crc_cfg, tm->frame, tm->frame_length);
+  put_u16_le(&tm->frame[tm->frame_length], crc);
+  /* leading delimiter terminates any partial data (e.g. printf text) on the line */
+  wire_buff[0] = COBS_FRAME_DELIMITER;
+  encoded_length = cobs_encode(tm->frame, tm->frame_length + TELEMETRY_CRC_SIZE,
+                               &wire_buff[1], sizeof(wire_buff) - 2);
+  wire_buff[encoded_length + 1] = COBS_FRAME_DELIMITER;
+  if(encoded_length == 0) {
+    queued = false;
+  } else if(tm->sink != NULL) {
+    queued = telemetry_sink_queue(tm, wire_buff, encoded_length + 2);
+  } else {
+    queued = (guart_queue_data(tm->uart, wire_buff, encoded_length + 2) != 0);
+  }
+  tm->seq++;
+  tm->record_count = 0;
+  tm->frame_length = 0;
+  stream_busy = busy;
+  if(queued) {
+    tm->frames_sent++;
+  } else {
+    tm->frames_dropped++;
+    /* logged after the frame is closed as the message may go to this stream */
+    LOG_WARN("TELEMETRY: frame %u dropped\n", (uint16_t)(tm->seq - 1));
+  }
+  return queued;
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_record(telemetry_t *tm, uint8_t type, uint8_t channel, const uint8_t *data, uint8_t length)
+{
+  uint32_t now_ms;
+  uint32_t dt_ms;
+  if(tm == NULL || (data == NULL && length) || length > TELEMETRY_MAX_RECORD_DATA_SIZE) {
+    return false;
+  }
+  stream_busy = true;
+  now_ms = (uint32_t)clock_get_time_ms();
+  if(tm->record_count) {
+    dt_ms = now_ms - tm->frame_start_ms;
+    /* close the frame if the record does not fit or the time offset does not fit in 16 bits */
+    if(tm->frame_length + TELEMETRY_RECORD_HEADER_SIZE + length + TELEMETRY_CRC_SIZE > TELEMETRY_MAX_FRAME_SIZE
+       || dt_ms > 0xFFFF || tm->record_count == 0xFF) {
+      telemetry_flush(tm);
+    }
+  }
+  if(tm->record_count == 0) {
+    telemetry_start_frame(tm, now_ms);
+  }
+  dt_ms = now_ms - tm->frame_start_ms;
+  tm->frame[tm->frame_length++] = type;
+  tm->frame[tm->frame_length++] = channel;
+  put_u16_le(&tm->frame[tm->frame_length], (uint16_t)dt_ms);
+  tm->frame_length += 2;
+  tm->frame[tm->frame_length++] = length;
+  if(length) {
+    memcpy(&tm->frame[tm->frame_length], data, length);
+    tm->frame_length += length;
+  }
+  tm->record_count++;
+  stream_busy = false;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_sht4x(telemetry_t *tm, uint8_t channel, int32_t temp_mC, uint16_t rh_percentage_100x)
+{
+  uint8_t data[6];
+  put_u32_le(&data[0], (uint32_t)temp_mC);
+  put_u16_le(&data[4], rh_percentage_100x);
+  return telemetry_add_record(tm, TELEMETRY_TYPE_SHT4X, channel, data, sizeof(data));
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_ntc(telemetry_t *tm, uint8_t channel, int32_t temp_mC)
+{
+  uint8_t data[4];
+  put_u32_le(data, (uint32_t)temp_mC);
+  return telemetry_add_record(tm, TELEMETRY_TYPE_NTC, channel, data, sizeof(data));
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_fan(telemetry_t *tm, uint8_t channel, uint16_t rpm, uint8_t dir, uint16_t duty_cycle_100x)
+{
+  uint8_t data[5];
+  put_u16_le(&data[0], rpm);
+  data[2] = dir;
+  put_u16_le(&data[3], duty_cycle_100x);
+  return telemetry_add_record(tm, TELEMETRY_TYPE_FAN, channel, data, sizeof(data));
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_heater(telemetry_t *tm, uint8_t channel, uint16_t duty_cycle_100x)
+{
+  uint8_t data[2];
+  put_u16_le(data, duty_cycle_100x);
+  return telemetry_add_record(tm, TELEMETRY_TYPE_HEATER, channel, data, sizeof(data));
+}
+/*---------------------------------------------------------------------------*/
+bool
+telemetry_add_stats(telemetry_t *tm)
+{
+  uint8_t data[8];
+  if(tm == NULL) {
+    return false;
+  }
+  put_u32_le(&data[0], tm->frames_sent);
+  put_u32_le(&data[4], tm->frames_dropped);
+  return telemetry_add_record(tm, TELEMETRY_TYPE_STATS, 0, data, sizeof(data));
+}
+/*---------------------------------------------------------------------------*/
+void
+telemetry_poll(telemetry_t *tm)
+{
+  if(tm == NULL) {
+    return;
+  }
+  if(tm->record_count != 0 && (uint32_t)clock_get_time_ms() - tm->frame_start_ms >= tm->batch_interval_ms) {
+    telemetry_flush(tm);
+  }
+  if(tm->sink != NULL) {
+    telemetry_sink_drain(tm);
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,138 @@
+/*!
+*\file  telemetry.h
+*\brief This file holds the frame format and function prototypes of the binary telemetry
+*       stream. Samples are packed as typed records into a batch, the batch is protected
+*       with a CRC16 trailer and COBS encoded so that 0x00 can be used as frame delimiter.
+*
+*       Raw frame (before COBS encoding, all multi byte fields are little endian):
+*         | version:1 | seq:2 | timestamp_ms:4 | record_count:1 | records... | crc16:2 |
+*       Record:
+*         | type:1 | channel:1 | dt_ms:2 | length:1 | data:length |
+*       dt_ms is the sample time relative to the frame timestamp. The CRC16-CCITT
+*       (poly 0x1021, init 0xFFFF) covers everything from version up to the last record.
+*       On the wire every frame is sent as | 0x00 | COBS(raw frame) | 0x00 | so that a
+*       receiver can re-synchronize after any text output on the same uart.
+*/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include "guart.h"
+#include "cobs.h"
+
+#define TELEMETRY_VERSION                 1
+#define TELEMETRY_HEADER_SIZE             8     /* version + seq + timestamp + record count */
+#define TELEMETRY_RECORD_HEADER_SIZE      5     /* type + channel + dt_ms + length */
+#define TELEMETRY_CRC_SIZE                2
+#ifndef TELEMETRY_CONF_MAX_FRAME_SIZE
+#define TELEMETRY_MAX_FRAME_SIZE          240   /* raw frame size including header and crc. Keeps COBS overhead to 1 byte */
+#else
+#define TELEMETRY_MAX_FRAME_SIZE          TELEMETRY_CONF_MAX_FRAME_SIZE
+#endif /* TELEMETRY_CONF_MAX_FRAME_SIZE */
+#define TELEMETRY_MAX_RECORD_DATA_SIZE    (TELEMETRY_MAX_FRAME_SIZE - TELEMETRY_HEADER_SIZE - TELEMETRY_RECORD_HEADER_SIZE - TELEMETRY_CRC_SIZE)
+/* delimiter + encoded frame + delimiter */
+#define TELEMETRY_MAX_WIRE_SIZE           (COBS_ENCODED_MAX_LENGTH(TELEMETRY_MAX_FRAME_SIZE) + 2)
+#define TELEMETRY_DEFAULT_BATCH_MS        100   /* flush the batch at least every 100 ms */
+#ifndef TELEMETRY_CONF_SINK_BUFFER_SIZE
+#define TELEMETRY_SINK_BUFFER_SIZE        (2 * TELEMETRY_MAX_WIRE_SIZE)  /* RAM ring of encoded frames waiting for the sink */
+#else
+#define TELEMETRY_SINK_BUFFER_SIZE        TELEMETRY_CONF_SINK_BUFFER_SIZE
+#endif /* TELEMETRY_CONF_SINK_BUFFER_SIZE */
+#define TELEMETRY_SINK_DRAIN_US           200   /* max time telemetry_poll waits for a busy sink */
+#define TELEMETRY_LOG_MAX_TEXT            64    /* log messages are truncated to this length */
+
+typedef enum telemetry_type {
+  TELEMETRY_TYPE_SHT4X = 1,     /* int32 temperature mC, uint16 RH % x 100 */
+  TELEMETRY_TYPE_NTC = 2,       /* int32 temperature mC */
+  TELEMETRY_TYPE_FAN = 3,       /* uint16 set rpm, uint8 direction, uint16 pwm duty cycle x 100 */
+  TELEMETRY_TYPE_HEATER = 4,    /* uint16 pwm duty cycle x 100 */
+  TELEMETRY_TYPE_STATS = 5,     /* uint32 frames sent, uint32 frames dropped */
+  TELEMETRY_TYPE_LOG = 6,       /* channel is the log module, uint8 level, message text without terminator */
+  TELEMETRY_TYPE_RAW = 0x80     /* application specific data */
+} telemetry_type_t;
+
+typedef struct telemetry {
+  guart_t *uart;                                /* uart the frames are queued on */
+  uint16_t (* sink)(const uint8_t *data, uint16_t len);  /* optional non blocking sink used instead of the uart, e.g. SWO. Returns bytes written */
+  uint8_t sink_buff[TELEMETRY_SINK_BUFFER_SIZE];  /* encoded frames not yet taken by the sink, circular */
+  uint16_t sink_head;                           /* next write position in sink_buff */
+  uint16_t sink_tail;                           /* next byte for the sink */
+  uint32_t batch_interval_ms;                   /* max age of the first record in a batch before flush */
+  uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];      /* raw frame under construction */
+  uint16_t frame_length;                        /* number of bytes used in frame */
+  uint8_t record_count;                         /* number of records in current frame */
+  uint16_t seq;                                 /* sequence number of the next frame */
+  uint32_t frame_start_ms;                      /* timestamp of the current frame */
+  uint32_t frames_sent;                         /* number of frames queued on the uart */
+  uint32_t frames_dropped;                      /* number of frames dropped as the uart TX buffer or the sink buffer was full */
+} telemetry_t;
+
+/*!
+* \fn     void telemetry_init(telemetry_t *tm, guart_t *uart, uint32_t batch_interval_ms)
+* \brief  Function initializes the telemetry stream. The uart must be initialized with
+*         guart_init, frames are queued on its interrupt driven TX buffer.
+* \param  tm pointer to telemetry structure.
+* \param  uart pointer to generic uart used for the stream.
+* \param  batch_interval_ms max time a record waits in a batch, 0 for TELEMETRY_DEFAULT_BATCH_MS.
+*/
+void telemetry_init(telemetry_t *tm, guart_t *uart, uint32_t batch_interval_ms);
+
+/*!
+* \fn     void telemetry_set_sink(telemetry_t *tm, uint16_t (*sink)(const uint8_t *data, uint16_t len))
+* \brief  Function routes the frames to given sink instead of the uart. A frame is queued
+*         whole in sink_buff and telemetry_poll passes it on as fast as the sink takes it,
+*         a frame that does not fit in sink_buff is dropped. Pass NULL to go back to the uart.
+* \param  tm pointer to telemetry structure.
+* \param  sink non blocking write function.
+*/
+void telemetry_set_sink(telemetry_t *tm, uint16_t (*sink)(const uint8_t *data, uint16_t len));
+
+/*!
+* \fn     void telemetry_set_log_stream(telemetry_t *tm)
+* \brief  Function selects the telemetry binary log back end and sends the log messages
+*         as TELEMETRY_TYPE_LOG records on given stream. Pass NULL to go back to the text
+*         back end. The stream is not interrupt safe, messages logged from an interrupt
+*         while a record is being added are dropped.
+* \param  tm pointer to telemetry structure.
+*/
+void telemetry_set_log_stream(telemetry_t *tm);
+
+/*!
+* \fn     bool telemetry_add_record(telemetry_t *tm, uint8_t type, uint8_t channel, const uint8_t *data, uint8_t length)
+* \brief  Function appends a record to the current batch. The batch is flushed first if
+*         the record does not fit into it. The function never blocks.
+* \param  tm pointer to telemetry structure.
+* \param  type record type, see telemetry_type_t.
+* \param  channel instance number of the source, e.g. NTC index.
+* \param  data pointer to record data (little endian).
+* \param  length number of data bytes, max TELEMETRY_MAX_RECORD_DATA_SIZE.
+* \return Function returns true if the record was added to the batch.
+*/
+bool telemetry_add_record(telemetry_t *tm, uint8_t type, uint8_t channel, const uint8_t *data, uint8_t length);
+
+/* typed helpers, the data is packed in little endian */
+bool telemetry_add_sht4x(telemetry_t *tm, uint8_t channel, int32_t temp_mC, uint16_t rh_percentage_100x);
+bool telemetry_add_ntc(telemetry_t *tm, uint8_t channel, int32_t temp_mC);
+bool telemetry_add_fan(telemetry_t *tm, uint8_t channel, uint16_t rpm, uint8_t dir, uint16_t duty_cycle_100x);
+bool telemetry_add_heater(telemetry_t *tm, uint8_t channel, uint16_t duty_cycle_100x);
+bool telemetry_add_stats(telemetry_t *tm);
+
+/*!
+* \fn     bool telemetry_flush(telemetry_t *tm)
+* \brief  Function closes the current batch, adds the CRC, COBS encodes and queues it
+*         on the uart. The sequence number is incremented even if the frame is dropped
+*         so that the receiver can count the lost frames.
+* \param  tm pointer to telemetry structure.
+* \return Function returns true if the frame was queued or there was nothing to send.
+*/
+bool telemetry_flush(telemetry_t *tm);
+
+/*!
+* \fn     void telemetry_poll(telemetry_t *tm)
+* \brief  Function flushes the current batch once it is older than the batch interval and
+*         passes queued frames to the sink. Call this from the application poll loop.
+* \param  tm pointer to telemetry structure.
+*/
+void telemetry_poll(telemetry_t *tm);
+#endif /* _TELEMETRY_H_ */
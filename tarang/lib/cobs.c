@@ -0,0 +1,99 @@
+/**
+ * @file  cobs.c
+ * @author Varun Marolia
+ * @brief This file implements Consistent Overhead Byte Stuffing (COBS) encoder
+ *        and decoder. COBS removes all 0x00 bytes from a data buffer with an
+ *        overhead of at most one byte in 254 so that 0x00 can be used as an
+ *        unambiguous frame delimiter on a byte stream such as UART.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "cobs.h"
+#include <stddef.h>
+
+/*---------------------------------------------------------------------------*/
+uint16_t
+cobs_encode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size)
+{
+  uint16_t i;
+  uint16_t code_index = 0;    /* index of the current group code byte in dst */
+  uint16_t out = 1;           /* next free index in dst */
+  uint8_t code = 1;           /* current group length + 1 */
+
+  if(src == NULL || dst == NULL || dst_size < COBS_ENCODED_MAX_LENGTH(src_len)) {
+    return 0;
+  }
+  for(i = 0; i < src_len; i++) {
+    if(src[i] == 0) {
+      /* close the group, the zero is implied by the code byte */
+      dst[code_index] = code;
+      code_index = out++;
+      code = 1;
+    } else {
+      dst[out++] = src[i];
+      code++;
+      if(code == 0xFF) {
+        /* maximum group length reached, start a new group without an implied zero */
+        dst[code_index] = code;
+        code_index = out++;
+        code = 1;
+      }
+    }
+  }
+  dst[code_index] = code;
+  return out;
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+cobs_decode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size)
+{
+  uint16_t i = 0;
+  uint16_t out = 0;
+  uint8_t code;
+  uint8_t j;
+
+  if(src == NULL || dst == NULL) {
+    return 0;
+  }
+  while(i < src_len) {
+    code = src[i++];
+    if(code == COBS_FRAME_DELIMITER) {
+      return 0;     /* a delimiter can not be part of the encoded data */
+    }
+    for(j = 1; j < code; j++) {
+      if(i >= src_len || out >= dst_size || src[i] == COBS_FRAME_DELIMITER) {
+        return 0;
+      }
+      dst[out++] = src[i++];
+    }
+    /* every group except the maximum length group and the last one is followed by a zero */
+    if(code != 0xFF && i < src_len) {
+      if(out >= dst_size) {
+        return 0;
+      }
+      dst[out++] = 0;
+    }
+  }
+  return out;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,36 @@
+#ifndef COBS_H_
+#define COBS_H_
+
+#include <stdint.h>
+
+#define COBS_FRAME_DELIMITER      0x00
+
+/* worst case encoded length for given raw length (without the frame delimiter) */
+#define COBS_ENCODED_MAX_LENGTH(len)    ((len) + ((len) / 254) + 1)
+
+/*!
+* \fn     uint16_t cobs_encode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size)
+* \brief  Function encodes given buffer using Consistent Overhead Byte Stuffing. The encoded
+*         buffer does not contain any 0x00 byte so 0x00 can be used as a frame delimiter.
+*         The frame delimiter is not added by this function.
+* \param  src Pointer to the raw data buffer.
+* \param  src_len Number of raw data bytes.
+* \param  dst Pointer to the output buffer. Must not overlap with src.
+* \param  dst_size Size of the output buffer, see COBS_ENCODED_MAX_LENGTH.
+* \return Function returns number of encoded bytes, 0 if the output buffer is too small.
+*/
+uint16_t cobs_encode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size);
+
+/*!
+* \fn     uint16_t cobs_decode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size)
+* \brief  Function decodes a COBS encoded buffer (without the frame delimiter).
+* \param  src Pointer to the encoded data buffer.
+* \param  src_len Number of encoded bytes.
+* \param  dst Pointer to the output buffer. Can be same as src for in place decoding.
+* \param  dst_size Size of the output buffer.
+* \return Function returns number of decoded bytes, 0 if the input is malformed or
+*         the output buffer is too small.
+*/
+uint16_t cobs_decode(const uint8_t *src, uint16_t src_len, uint8_t *dst, uint16_t dst_size);
+
+#endif /* COBS_H_ */
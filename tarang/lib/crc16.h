@@ -0,0 +1,28 @@
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_CCITT_POLYNOMIAL          0x1021u   /* x^16 + x^12 + x^5 + 1 */
+#define CRC16_CCITT_INITIAL_REMAINDER   0xFFFFu
+#define CRC16_CCITT_FINAL_XOR_VALUE     0x0000u
+
+typedef struct crc16_config
+{
+uint16_t polynomial;
+uint16_t intial_remainder;
+uint16_t final_xor_value;
+} crc16_cfg_t;
+
+/*!
+* \fn     uint16_t crc16_calc_buff(const crc16_cfg_t *cfg, const uint8_t *buff, uint16_t buff_length)
+* \brief  Function calculates 16 bit crc value (MSB first, non reflected) for given buffer.
+* \param  cfg Pointer to CRC16 config structure holding values like
+*         polynomial to use intial remainder to use and final xor value.
+* \param  buff Pointer to the data buffer.
+* \param  buff_length Number of data bytes in buffer.
+* \return Function returns 16 bit CRC value for given data buffer of given size.
+*/
+uint16_t crc16_calc_buff(const crc16_cfg_t *cfg, const uint8_t *buff, uint16_t buff_length);
+
+#endif /* CRC16_H_ */
@@ -26,26 +26,53 @@
  */
 
 #include "crc8.h"
+#include <stddef.h>
 
+/*---------------------------------------------------------------------------*/
+static inline uint8_t
+crc8_calc_byte(const crc8_cfg_t *cfg, uint8_t crc)
+{
+  uint8_t bit;
+  for(bit = 8; bit > 0; --bit) {
+    if(crc & 0x80) {
+      crc = (crc << 1) ^ cfg->polynomial;
+    } else {
+      crc = (crc << 1);
+    }
+  }
+  return crc;
+}
 /*---------------------------------------------------------------------------*/
 uint8_t
-crc8_calc_buff(const crc8_cfg_t *cfg, uint8_t *buff, uint8_t buff_length)
+crc8_calc_buff(const crc8_cfg_t *cfg, const uint8_t *buff, uint8_t buff_length)
 {
   uint8_t crc = cfg->intial_remainder;
   uint8_t i = 0;
-  uint8_t bit;
   if(buff_length && buff) {
-    for(i = 0; i < buff_length; i++) {
-      crc ^= buff[i];
-      for(bit = 8; bit > 0; --bit) {
-        if(crc & 0x80) {
-          crc = (crc << 1) ^ cfg->polynomial;
-        } else {
-          crc = (crc << 1);
-        }
+    if(cfg->table != NULL) {
+      for(i = 0; i < buff_length; i++) {
+        crc = cfg->table[crc ^ buff[i]];
+      }
+    } else {
+      for(i = 0; i < buff_length; i++) {
+        crc = crc8_calc_byte(cfg, crc ^ buff[i]);
       }
     }
   }
 return (crc ^ cfg->final_xor_value);
 }
 /*---------------------------------------------------------------------------*/
+uint8_t
+crc8_calc_word(const crc8_cfg_t *cfg, const uint8_t *buff)
+{
+  uint8_t crc;
+  if(cfg->table != NULL) {
+    crc = cfg->table[cfg->intial_remainder ^ buff[0]];
+    crc = cfg->table[crc ^ buff[1]];
+  } else {
+    crc = crc8_calc_byte(cfg, cfg->intial_remainder ^ buff[0]);
+    crc = crc8_calc_byte(cfg, crc ^ buff[1]);
+  }
+  return (crc ^ cfg->final_xor_value);
+}
+/*---------------------------------------------------------------------------*/
@@ -11,17 +11,71 @@ typedef struct crc8_config
 uint8_t polynomial;
 uint8_t intial_remainder;
 uint8_t final_xor_value;
+const uint8_t *table;     /* optional 256 entry table for the polynomial, NULL to calculate bit by bit */
 } crc8_cfg_t;
 
+/*
+ * Compile time table generation. The CRC is linear, so the table entry of a byte is the xor of
+ * the entries of its set bits. The 8 single bit entries are computed once as enum constants and
+ * every table entry is an xor of those, the table is a constant initializer and lives in flash.
+ *
+ * Usage:
+ *   CRC8_TABLE_DEFINE(sht4x_crc_table, 0x31);
+ *   static const crc8_cfg_t cfg = { 0x31, 0xff, 0x00, sht4x_crc_table };
+ */
+#define CRC8_STEP(crc, poly)        ((uint8_t)(((crc) & 0x80) ? (((crc) << 1) ^ (poly)) : ((crc) << 1)))
+#define CRC8_BIT(name, byte, bit)   (((byte) & (1 << (bit))) ? name##_bit##bit : 0)
+#define CRC8_ENTRY(name, byte)      (uint8_t)(CRC8_BIT(name, byte, 0) ^ CRC8_BIT(name, byte, 1) ^ \
+                                              CRC8_BIT(name, byte, 2) ^ CRC8_BIT(name, byte, 3) ^ \
+                                              CRC8_BIT(name, byte, 4) ^ CRC8_BIT(name, byte, 5) ^ \
+                                              CRC8_BIT(name, byte, 6) ^ CRC8_BIT(name, byte, 7))
+#define CRC8_ROW(name, row)                                                                       \
+  CRC8_ENTRY(name, (row) + 0x0), CRC8_ENTRY(name, (row) + 0x1), CRC8_ENTRY(name, (row) + 0x2),    \
+  CRC8_ENTRY(name, (row) + 0x3), CRC8_ENTRY(name, (row) + 0x4), CRC8_ENTRY(name, (row) + 0x5),    \
+  CRC8_ENTRY(name, (row) + 0x6), CRC8_ENTRY(name, (row) + 0x7), CRC8_ENTRY(name, (row) + 0x8),    \
+  CRC8_ENTRY(name, (row) + 0x9), CRC8_ENTRY(name, (row) + 0xA), CRC8_ENTRY(name, (row) + 0xB),    \
+  CRC8_ENTRY(name, (row) + 0xC), CRC8_ENTRY(name, (row) + 0xD), CRC8_ENTRY(name, (row) + 0xE),    \
+  CRC8_ENTRY(name, (row) + 0xF)
+
+/* defines a static const 256 byte table called name for the given polynomial */
+#define CRC8_TABLE_DEFINE(name, poly)                                                             \
+  enum {                                                                                          \
+    name##_bit0 = CRC8_STEP(0x80, poly),                                                          \
+    name##_bit1 = CRC8_STEP(name##_bit0, poly),                                                   \
+    name##_bit2 = CRC8_STEP(name##_bit1, poly),                                                   \
+    name##_bit3 = CRC8_STEP(name##_bit2, poly),                                                   \
+    name##_bit4 = CRC8_STEP(name##_bit3, poly),                                                   \
+    name##_bit5 = CRC8_STEP(name##_bit4, poly),                                                   \
+    name##_bit6 = CRC8_STEP(name##_bit5, poly),                                                   \
+    name##_bit7 = CRC8_STEP(name##_bit6, poly)                                                    \
+  };                                                                                              \
+  static const uint8_t name[256] = {                                                              \
+    CRC8_ROW(name, 0x00), CRC8_ROW(name, 0x10), CRC8_ROW(name, 0x20), CRC8_ROW(name, 0x30),       \
+    CRC8_ROW(name, 0x40), CRC8_ROW(name, 0x50), CRC8_ROW(name, 0x60), CRC8_ROW(name, 0x70),       \
+    CRC8_ROW(name, 0x80), CRC8_ROW(name, 0x90), CRC8_ROW(name, 0xA0), CRC8_ROW(name, 0xB0),       \
+    CRC8_ROW(name, 0xC0), CRC8_ROW(name, 0xD0), CRC8_ROW(name, 0xE0), CRC8_ROW(name, 0xF0)        \
+  }
+
 /*!
-* \fn     uint8_t crc8_calc_buff(const crc8_cfg_t cfg, uint8_t *buff, uint8_t buff_size)
-* \brief  Function calculates 8 bit crc values for given byte.
+* \fn     uint8_t crc8_calc_buff(const crc8_cfg_t *cfg, const uint8_t *buff, uint8_t buff_length)
+* \brief  Function calculates 8 bit crc values for given byte. Uses the lookup table of the
+*         config when it has one, otherwise calculates bit by bit.
 * \param  crc8_cfg Pointer to CRC8 config strcture holding values like
 *         polynomial to use intial remainder to use and final xor value.
 * \param  buff Pointer to the data buffer.
 * \param  buff_size Number of data bytes in buffer. This can not be more than 255.
 * \return Function returns 8 bit CRC value for given data buffer of given size.
 */
-uint8_t crc8_calc_buff(const crc8_cfg_t *cfg, uint8_t *buff, uint8_t buff_length);
+uint8_t crc8_calc_buff(const crc8_cfg_t *cfg, const uint8_t *buff, uint8_t buff_length);
+
+/*!
+* \fn     uint8_t crc8_calc_word(const crc8_cfg_t *cfg, const uint8_t *buff)
+* \brief  Function calculates 8 bit crc value of a 2 byte word, as sent by Sensirion sensors
+*         before each CRC byte. The loop is unrolled, with a table this is 2 lookups.
+* \param  cfg Pointer to CRC8 config structure.
+* \param  buff Pointer to the 2 data bytes, MSB first.
+* \return Function returns 8 bit CRC value of the word.
+*/
+uint8_t crc8_calc_word(const crc8_cfg_t *cfg, const uint8_t *buff);
 
 #endif
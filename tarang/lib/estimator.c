@@ -0,0 +1,151 @@
+/**
+ * @file  estimator.c
+ * @author Varun Marolia
+ * @brief This file implements the fixed point alpha-beta state estimator
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "estimator.h"
+#include <stddef.h>
+
+/*---------------------------------------------------------------------------*/
+/* rate of the known inputs, units/s with ESTIMATOR_FRAC_BITS fraction */
+static int32_t
+estimator_input_rate(const estimator_t *est)
+{
+  int64_t rate = 0;
+  uint8_t i;
+  for(i = 0; i < ESTIMATOR_MAX_INPUTS; i++) {
+    rate += (int64_t)est->cfg->input_gain[i] * est->input[i];
+  }
+  return (int32_t)((rate * (1 << ESTIMATOR_FRAC_BITS)) / ESTIMATOR_INPUT_FULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+estimator_init(estimator_t *est, const estimator_cfg_t *cfg)
+{
+  uint8_t i;
+  if(est == NULL) {
+    return;
+  }
+  est->cfg = cfg;
+  est->primed = false;
+  est->value = 0;
+  est->rate = 0;
+  for(i = 0; i < ESTIMATOR_MAX_INPUTS; i++) {
+    est->input[i] = 0;
+  }
+  est->gated = 0;
+  est->updates = 0;
+  est->rejects = 0;
+}
+/*---------------------------------------------------------------------------*/
+void
+estimator_set_input(estimator_t *est, uint8_t input, int32_t value)
+{
+  if(est == NULL || input >= ESTIMATOR_MAX_INPUTS) {
+    return;
+  }
+  if(value > ESTIMATOR_INPUT_FULL) {
+    value = ESTIMATOR_INPUT_FULL;
+  } else if(value < -ESTIMATOR_INPUT_FULL) {
+    value = -ESTIMATOR_INPUT_FULL;
+  }
+  est->input[input] = value;
+}
+/*---------------------------------------------------------------------------*/
+void
+estimator_update(estimator_t *est, uint32_t time_ms, int32_t measurement)
+{
+  int64_t residual;
+  int64_t predicted;
+  uint32_t dt_ms;
+  if(est == NULL || est->cfg == NULL) {
+    return;
+  }
+  if(!est->primed) {
+    est->value = measurement * (1 << ESTIMATOR_FRAC_BITS);
+    est->rate = 0;
+    est->last_ms = time_ms;
+    est->primed = true;
+    est->updates++;
+    return;
+  }
+  dt_ms = time_ms - est->last_ms;
+  if(dt_ms == 0) {
+    return;
+  }
+  /* predict */
+  predicted = est->value + ((int64_t)(est->rate + estimator_input_rate(est)) * dt_ms) / 1000;
+  residual = (int64_t)measurement * (1 << ESTIMATOR_FRAC_BITS) - predicted;
+  if(est->cfg->gate && (residual > (int64_t)est->cfg->gate << ESTIMATOR_FRAC_BITS
+                        || residual < -((int64_t)est->cfg->gate << ESTIMATOR_FRAC_BITS))) {
+    /* a spike is skipped, a lasting step means the model is off and the filter restarts */
+    est->rejects++;
+    if(++est->gated >= ESTIMATOR_GATE_COUNT) {
+      est->primed = false;
+      est->gated = 0;
+      estimator_update(est, time_ms, measurement);
+    }
+    return;
+  }
+  est->gated = 0;
+  /* correct */
+  est->value = (int32_t)(predicted + (residual * est->cfg->alpha_q16) / ESTIMATOR_GAIN_ONE);
+  est->rate += (int32_t)((residual * est->cfg->beta_q16 * 1000) / ((int64_t)ESTIMATOR_GAIN_ONE * dt_ms));
+  est->last_ms = time_ms;
+  est->updates++;
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+estimator_get_value(const estimator_t *est)
+{
+  return est->value / (1 << ESTIMATOR_FRAC_BITS);
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+estimator_get_rate(const estimator_t *est)
+{
+  return (est->rate + estimator_input_rate(est)) / (1 << ESTIMATOR_FRAC_BITS);
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+estimator_predict(const estimator_t *est, uint32_t ahead_ms)
+{
+  int64_t value = est->value + ((int64_t)(est->rate + estimator_input_rate(est)) * ahead_ms) / 1000;
+  return (int32_t)(value / (1 << ESTIMATOR_FRAC_BITS));
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+estimator_time_to_reach_ms(const estimator_t *est, int32_t threshold)
+{
+  int64_t rate = est->rate + estimator_input_rate(est);
+  int64_t distance = (int64_t)threshold * (1 << ESTIMATOR_FRAC_BITS) - est->value;
+  int64_t time_ms;
+  if(rate == 0 || (distance > 0 && rate < 0) || (distance < 0 && rate > 0)) {
+    return (distance == 0) ? 0 : ESTIMATOR_NEVER;
+  }
+  time_ms = (distance * 1000) / rate;
+  return (time_ms >= ESTIMATOR_NEVER) ? ESTIMATOR_NEVER - 1 : (uint32_t)time_ms;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,101 @@
+#ifndef ESTIMATOR_H_
+#define ESTIMATOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed point alpha-beta estimator with known inputs. This is the steady state form of a two
+ * state Kalman filter (value and rate of change) that needs no matrix math and no FPU. Each
+ * channel tracks a value (e.g. temperature in mC) and its rate of change per second. Known
+ * inputs like a heater duty cycle or a fan speed are fed forward into the prediction with a
+ * gain per input, so a step of an input does not show up as a measurement error. The rate state
+ * then only tracks the unknown part of the change.
+ *
+ *   predict: x = x + (v + sum(gain_i * u_i)) * dt
+ *   update:  r = z - x, x = x + alpha * r, v = v + beta * r / dt
+ *
+ * alpha and beta follow from the ratio of process to measurement noise. A lower alpha trusts the
+ * model more and filters more, beta ~ alpha^2 / (2 - alpha) gives a critically damped response.
+ */
+
+#define ESTIMATOR_FRAC_BITS       8             /* state fraction bits below 1 unit */
+#define ESTIMATOR_GAIN_ONE        65536         /* alpha and beta are Q16, 1.0 = 65536 */
+#define ESTIMATOR_INPUT_FULL      10000         /* full scale input, e.g. duty cycle x 100 */
+#define ESTIMATOR_MAX_INPUTS      2
+#define ESTIMATOR_NEVER           UINT32_MAX    /* threshold is not reached at the current trend */
+#define ESTIMATOR_GATE_COUNT      5             /* gated measurements in a row before a restart */
+
+typedef struct estimator_cfg {
+  uint32_t alpha_q16;                           /* value gain, Q16 */
+  uint32_t beta_q16;                            /* rate gain, Q16 */
+  int32_t input_gain[ESTIMATOR_MAX_INPUTS];     /* rate per second at full scale input, units/s */
+  uint32_t gate;                                /* measurements further than this from the prediction are
+                                                   skipped, units, 0 for no gate */
+} estimator_cfg_t;
+
+typedef struct estimator {
+  const estimator_cfg_t *cfg;
+  bool primed;                                  /* false until the first measurement */
+  uint32_t last_ms;                             /* time of the last update */
+  int32_t value;                                /* estimated value, ESTIMATOR_FRAC_BITS fraction */
+  int32_t rate;                                 /* estimated rate of the unknown part, units/s, ESTIMATOR_FRAC_BITS fraction */
+  int32_t input[ESTIMATOR_MAX_INPUTS];          /* inputs since the last update */
+  uint8_t gated;                                /* gated measurements in a row */
+  uint32_t updates;
+  uint32_t rejects;
+} estimator_t;
+
+/*!
+* \fn     void estimator_init(estimator_t *est, const estimator_cfg_t *cfg)
+* \brief  Function initializes an estimator channel. The first measurement sets the value.
+*/
+void estimator_init(estimator_t *est, const estimator_cfg_t *cfg);
+
+/*!
+* \fn     void estimator_set_input(estimator_t *est, uint8_t input, int32_t value)
+* \brief  Function sets a known input. Set the input when it changes, it is used for the
+*         prediction up to the next update.
+* \param  input input index, below ESTIMATOR_MAX_INPUTS.
+* \param  value input value, -ESTIMATOR_INPUT_FULL to ESTIMATOR_INPUT_FULL.
+*/
+void estimator_set_input(estimator_t *est, uint8_t input, int32_t value);
+
+/*!
+* \fn     void estimator_update(estimator_t *est, uint32_t time_ms, int32_t measurement)
+* \brief  Function predicts the state up to time_ms and corrects it with the measurement.
+* \param  time_ms measurement time, must not go backwards.
+* \param  measurement measured value, in units.
+*/
+void estimator_update(estimator_t *est, uint32_t time_ms, int32_t measurement);
+
+/*!
+* \fn     int32_t estimator_get_value(const estimator_t *est)
+* \brief  Function returns the filtered value at the last update, in units. 0 before the first
+*         measurement.
+*/
+int32_t estimator_get_value(const estimator_t *est);
+
+/*!
+* \fn     int32_t estimator_get_rate(const estimator_t *est)
+* \brief  Function returns the total rate of change per second including the inputs, in units/s.
+*/
+int32_t estimator_get_rate(const estimator_t *est);
+
+/*!
+* \fn     int32_t estimator_predict(const estimator_t *est, uint32_t ahead_ms)
+* \brief  Function returns the value expected ahead_ms after the last update with the current
+*         rate and inputs.
+*/
+int32_t estimator_predict(const estimator_t *est, uint32_t ahead_ms);
+
+/*!
+* \fn     uint32_t estimator_time_to_reach_ms(const estimator_t *est, int32_t threshold)
+* \brief  Function returns the time from the last update until the value crosses threshold at
+*         the current rate.
+* \return Function returns the time in milliseconds or ESTIMATOR_NEVER if the value moves away
+*         from the threshold or is flat.
+*/
+uint32_t estimator_time_to_reach_ms(const estimator_t *est, int32_t threshold);
+
+#endif /* ESTIMATOR_H_ */
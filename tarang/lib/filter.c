@@ -0,0 +1,158 @@
+/**
+ * @file  filter.c
+ * @author Varun Marolia
+ * @brief This file implements the fixed point filter chain
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "filter.h"
+#include <stddef.h>
+
+/*---------------------------------------------------------------------------*/
+/* median of the filled part of the window, insertion sort of a copy */
+static int32_t
+filter_median(const filter_t *filter)
+{
+  int32_t sorted[FILTER_MEDIAN_MAX];
+  int32_t v;
+  uint8_t i, j;
+  for(i = 0; i < filter->window_fill; i++) {
+    v = filter->window[i];
+    for(j = i; j > 0 && sorted[j - 1] > v; j--) {
+      sorted[j] = sorted[j - 1];
+    }
+    sorted[j] = v;
+  }
+  return sorted[filter->window_fill / 2];
+}
+/*---------------------------------------------------------------------------*/
+void
+filter_init(filter_t *filter, const filter_cfg_t *cfg)
+{
+  if(filter == NULL) {
+    return;
+  }
+  filter->cfg = cfg;
+  filter->samples = 0;
+  filter->outliers = 0;
+  filter->limited = 0;
+  filter_reset(filter);
+}
+/*---------------------------------------------------------------------------*/
+void
+filter_reset(filter_t *filter)
+{
+  uint8_t i;
+  if(filter == NULL) {
+    return;
+  }
+  filter->window_index = 0;
+  filter->window_fill = 0;
+  for(i = 0; i < FILTER_MAX_STAGES; i++) {
+    filter->state[i] = 0;
+    filter->rejects[i] = 0;
+  }
+  filter->primed = 0;
+  filter->value = 0;
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+filter_update(filter_t *filter, int32_t sample)
+{
+  const filter_stage_t *stage;
+  int64_t delta;
+  int32_t x = sample;
+  uint8_t i, size;
+
+  if(filter == NULL) {
+    return sample;
+  }
+  filter->samples++;
+  for(i = 0; filter->cfg != NULL && i < FILTER_MAX_STAGES; i++) {
+    stage = &filter->cfg->stage[i];
+    if(stage->type == FILTER_NONE) {
+      break;
+    }
+    if(stage->type == FILTER_MEDIAN) {
+      size = (stage->param > FILTER_MEDIAN_MAX) ? FILTER_MEDIAN_MAX : (uint8_t)stage->param;
+      if(size > 1) {
+        filter->window[filter->window_index] = x;
+        filter->window_index = (filter->window_index + 1) % size;
+        if(filter->window_fill < size) {
+          filter->window_fill++;
+        }
+        x = filter_median(filter);
+      }
+      continue;
+    }
+    if(!(filter->primed & (1 << i))) {
+      /* the first sample seeds the stage */
+      filter->primed |= (1 << i);
+      filter->state[i] = (stage->type == FILTER_EMA) ? (x * (1 << FILTER_EMA_FRAC_BITS)) : x;
+      continue;
+    }
+    switch(stage->type) {
+      case FILTER_EMA:
+        delta = ((int64_t)x * (1 << FILTER_EMA_FRAC_BITS)) - filter->state[i];
+        filter->state[i] += (int32_t)((delta * stage->param) / FILTER_ALPHA_ONE);
+        /* round to nearest */
+        x = (filter->state[i] + (1 << (FILTER_EMA_FRAC_BITS - 1))) >> FILTER_EMA_FRAC_BITS;
+      break;
+      case FILTER_OUTLIER:
+        delta = (int64_t)x - filter->state[i];
+        if(delta > stage->param || delta < -stage->param) {
+          if(stage->hold == 0 || ++filter->rejects[i] < stage->hold) {
+            filter->outliers++;
+            x = filter->state[i];
+            break;
+          }
+        }
+        /* in range, or the new level held long enough */
+        filter->rejects[i] = 0;
+        filter->state[i] = x;
+      break;
+      case FILTER_RATE_LIMIT:
+        delta = (int64_t)x - filter->state[i];
+        if(delta > stage->param) {
+          x = filter->state[i] + stage->param;
+          filter->limited++;
+        } else if(delta < -stage->param) {
+          x = filter->state[i] - stage->param;
+          filter->limited++;
+        }
+        filter->state[i] = x;
+      break;
+      default:
+      break;
+    }
+  }
+  filter->value = x;
+  return x;
+}
+/*---------------------------------------------------------------------------*/
+int32_t
+filter_get_value(const filter_t *filter)
+{
+  return (filter != NULL) ? filter->value : 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,91 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed point filter chain for sampled signals, e.g. ADC channels. A chain is a static list of
+ * up to FILTER_MAX_STAGES stages that run in order on every sample:
+ *
+ *   MEDIAN      median of the last N samples, removes single spikes (N odd, max FILTER_MEDIAN_MAX)
+ *   EMA         exponential moving average y = y + alpha * (x - y), alpha Q16
+ *   OUTLIER     a sample further than max_delta from the last accepted one is replaced by it.
+ *               After hold samples in a row the new level is accepted, so a real step passes late
+ *   RATE_LIMIT  the output moves at most max_delta per sample
+ *
+ * The configuration is const and can be shared, the state lives in a small struct per channel.
+ * The chain holds one median window, so use one MEDIAN stage per chain.
+ */
+
+#define FILTER_MAX_STAGES         4
+#define FILTER_MEDIAN_MAX         7             /* largest median window */
+#define FILTER_ALPHA_ONE          65536         /* EMA alpha is Q16, 1.0 = 65536 */
+#define FILTER_EMA_FRAC_BITS      8             /* EMA state fraction bits */
+
+typedef enum filter_type {
+  FILTER_NONE = 0,
+  FILTER_MEDIAN,
+  FILTER_EMA,
+  FILTER_OUTLIER,
+  FILTER_RATE_LIMIT
+} filter_type_t;
+
+typedef struct filter_stage {
+  filter_type_t type;
+  int32_t param;                                /* MEDIAN: window size, EMA: alpha Q16,
+                                                   OUTLIER and RATE_LIMIT: max_delta in units */
+  uint8_t hold;                                 /* OUTLIER: rejects in a row before a new level is
+                                                   accepted, 0 to never accept */
+} filter_stage_t;
+
+typedef struct filter_cfg {
+  filter_stage_t stage[FILTER_MAX_STAGES];      /* stages in processing order, the list ends at
+                                                   FILTER_NONE */
+} filter_cfg_t;
+
+typedef struct filter {
+  const filter_cfg_t *cfg;
+  int32_t window[FILTER_MEDIAN_MAX];            /* median window, circular */
+  uint8_t window_index;                         /* next window position */
+  uint8_t window_fill;                          /* samples in the window */
+  int32_t state[FILTER_MAX_STAGES];             /* EMA: accumulator, OUTLIER: last accepted,
+                                                   RATE_LIMIT: last output */
+  uint8_t rejects[FILTER_MAX_STAGES];           /* OUTLIER: rejects in a row */
+  uint8_t primed;                               /* bit per stage, set once the stage has a state */
+  int32_t value;                                /* last output */
+  uint32_t samples;
+  uint32_t outliers;                            /* samples replaced by an OUTLIER stage */
+  uint32_t limited;                             /* samples clamped by a RATE_LIMIT stage */
+} filter_t;
+
+/*!
+* \fn     void filter_init(filter_t *filter, const filter_cfg_t *cfg)
+* \brief  Function initializes a filter channel. The first sample passes every stage unchanged.
+* \param  filter pointer to the channel state.
+* \param  cfg pointer to the chain, NULL passes the samples through.
+*/
+void filter_init(filter_t *filter, const filter_cfg_t *cfg);
+
+/*!
+* \fn     void filter_reset(filter_t *filter)
+* \brief  Function drops the state, e.g. after a sensor was reconnected. The counters are kept.
+*/
+void filter_reset(filter_t *filter);
+
+/*!
+* \fn     int32_t filter_update(filter_t *filter, int32_t sample)
+* \brief  Function runs a sample through the chain.
+* \param  filter pointer to the channel state.
+* \param  sample new sample, in units.
+* \return Function returns the filtered value, in units.
+*/
+int32_t filter_update(filter_t *filter, int32_t sample);
+
+/*!
+* \fn     int32_t filter_get_value(const filter_t *filter)
+* \brief  Function returns the last filtered value, 0 before the first sample.
+*/
+int32_t filter_get_value(const filter_t *filter);
+
+#endif /* FILTER_H_ */
@@ -0,0 +1,116 @@
+/**
+ * @file  interp.c
+ * @author Varun Marolia
+ * @brief This file implements integer table lookups with linear interpolation.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "interp.h"
+#include <stddef.h>
+/*---------------------------------------------------------------------------*/
+bool
+interp_search_descending(const uint32_t *table, uint16_t entries, uint32_t x, int32_t y_first, int32_t y_step, int32_t *y)
+{
+  uint16_t lo, hi, mid;
+  uint32_t num, den, frac_q16;
+
+  if(table == NULL || entries < 2 || x > table[0] || x < table[entries - 1]) {
+    return false;
+  }
+  /* find lo so that table[lo] >= x > table[lo + 1] */
+  lo = 0;
+  hi = entries - 1;
+  while((hi - lo) > 1) {
+    mid = (lo + hi) >> 1;
+    if(table[mid] >= x) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  num = table[lo] - x;
+  den = table[lo] - table[hi];
+  /* scale down so that the fraction fits in 32 bits, 16 bits of resolution are plenty */
+  while(den > 0xFFFF) {
+    num >>= 1;
+    den >>= 1;
+  }
+  frac_q16 = (num << 16) / den;
+  *y = y_first + (int32_t)lo * y_step + (int32_t)(((int64_t)y_step * frac_q16 + 0x8000) >> 16);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+interp_uniform(const int16_t *table, uint16_t entries, uint8_t shift, uint32_t x, int32_t *y)
+{
+  uint32_t i = x >> shift;
+  int32_t frac = (int32_t)(x & ((1UL << shift) - 1));
+  int32_t y0, y1;
+
+  if(table == NULL || i >= entries) {
+    return false;
+  }
+  y0 = table[i];
+  if(y0 == INTERP_INVALID) {
+    return false;
+  }
+  if(frac == 0) {
+    *y = y0;
+    return true;
+  }
+  if((i + 1) >= entries || table[i + 1] == INTERP_INVALID) {
+    return false;
+  }
+  y1 = table[i + 1];
+  *y = y0 + ((((y1 - y0) * frac) + (1L << (shift - 1))) >> shift);
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+interp_breakpoints(const uint16_t *x_table, const int16_t *y_table, uint16_t entries, uint32_t x, int32_t *y)
+{
+  uint16_t lo, hi, mid;
+  int32_t num, den;
+
+  if(x_table == NULL || y_table == NULL || entries < 2 || x < x_table[0] || x > x_table[entries - 1]) {
+    return false;
+  }
+  /* find lo so that x_table[lo] <= x <= x_table[lo + 1] */
+  lo = 0;
+  hi = entries - 1;
+  while((hi - lo) > 1) {
+    mid = (lo + hi) >> 1;
+    if(x_table[mid] <= x) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  num = ((int32_t)y_table[hi] - y_table[lo]) * (int32_t)(x - x_table[lo]);
+  den = (int32_t)x_table[hi] - x_table[lo];
+  /* round to nearest, the division truncates towards zero */
+  num += (num < 0) ? -(den >> 1) : (den >> 1);
+  *y = y_table[lo] + num / den;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,67 @@
+#ifndef INTERP_H_
+#define INTERP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Integer table lookup with linear interpolation. No FPU and no 64 bit division is used.
+ *
+ * Search tables hold the input value at evenly spaced outputs, e.g. the resistance of a
+ * thermistor at every degree. The input is searched in the table with a binary search and the
+ * output is interpolated between the two entries around it. The fraction between the entries is
+ * computed with 16 bits of resolution.
+ *
+ *   output = y_first + i * y_step + y_step * (table[i] - x) / (table[i] - table[i + 1])
+ *
+ * Uniform tables hold the output at every 2^shift inputs, e.g. the temperature at every 16th
+ * ADC code. The entry is found by a shift, there is no search.
+ *
+ *   output = table[x >> shift] + (table[(x >> shift) + 1] - table[x >> shift]) * (x & mask) / 2^shift
+ *
+ * Breakpoint tables hold the output at ascending, unevenly spaced inputs, e.g. dense where a
+ * curve bends and sparse where it is straight. The input is searched with a binary search.
+ *
+ *   output = y_table[i] + (y_table[i + 1] - y_table[i]) * (x - x_table[i]) / (x_table[i + 1] - x_table[i])
+ */
+
+#define INTERP_INVALID            INT16_MIN     /* uniform table entry without a valid output */
+
+/*!
+* \fn     bool interp_search_descending(const uint32_t *table, uint16_t entries, uint32_t x, int32_t y_first, int32_t y_step, int32_t *y)
+* \brief  Function looks up x in a strictly descending table and interpolates the output.
+* \param  table pointer to the table, table[i] is the input at output y_first + i * y_step.
+* \param  entries number of entries in the table, at least 2.
+* \param  x input value.
+* \param  y_first output at table[0].
+* \param  y_step output step between two entries.
+* \param  y pointer to variable to store the output.
+* \return Function returns false if x is outside the table.
+*/
+bool interp_search_descending(const uint32_t *table, uint16_t entries, uint32_t x, int32_t y_first, int32_t y_step, int32_t *y);
+
+/*!
+* \fn     bool interp_uniform(const int16_t *table, uint16_t entries, uint8_t shift, uint32_t x, int32_t *y)
+* \brief  Function interpolates the output of x in a uniform table.
+* \param  table pointer to the table, table[i] is the output at input i << shift.
+* \param  entries number of entries in the table.
+* \param  shift input step between two entries is 2^shift.
+* \param  x input value.
+* \param  y pointer to variable to store the output, in table units.
+* \return Function returns false if x is outside the table or next to an INTERP_INVALID entry.
+*/
+bool interp_uniform(const int16_t *table, uint16_t entries, uint8_t shift, uint32_t x, int32_t *y);
+
+/*!
+* \fn     bool interp_breakpoints(const uint16_t *x_table, const int16_t *y_table, uint16_t entries, uint32_t x, int32_t *y)
+* \brief  Function interpolates the output of x between the two breakpoints around it. The
+*         product of the output step and the input step of a segment must fit in 31 bits.
+* \param  x_table pointer to the inputs, strictly ascending.
+* \param  y_table pointer to the outputs, y_table[i] is the output at input x_table[i].
+* \param  entries number of entries in both tables, at least 2.
+* \param  x input value.
+* \param  y pointer to variable to store the output, in table units.
+* \return Function returns false if x is outside the table.
+*/
+bool interp_breakpoints(const uint16_t *x_table, const int16_t *y_table, uint16_t entries, uint32_t x, int32_t *y);
+#endif /* INTERP_H_ */
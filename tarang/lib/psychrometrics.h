@@ -0,0 +1,93 @@
+#ifndef PSYCHROMETRICS_H_
+#define PSYCHROMETRICS_H_
+
+#include <stdint.h>
+
+/*
+ * Fixed point psychrometrics without libm. Inputs are temperature in milli degree Celsius and
+ * relative humidity in percentage x 100 (e.g. from sht4x_get_last_result). The saturation vapour
+ * pressure comes from 1 'C lookup tables of the Magnus formula (Sonntag 1990 coefficients)
+ * with quadratic interpolation, the dew and frost points are the inverse lookups. Relative humidity
+ * is always with respect to liquid water, as reported by the SHT4x.
+ *
+ * Error against the floating point Magnus formula from -40 to 85 'C, the SHT4x humidity range
+ * (checked with tools/psychrometrics_bench.c):
+ *   saturation vapour pressure   < 0.01 % relative
+ *   dew point / frost point      < 0.005 'C (for RH >= 1 %RH)
+ *   absolute humidity            < 0.1 % relative + 0.5 mg/m^3 rounding
+ *   enthalpy                     < 0.001 % relative + 10 J/kg
+ * The Magnus formula itself is within 0.1 'C / 0.3 % of the reference equations in this range.
+ */
+
+#define PSYCHRO_ERROR                   -300000   /* input outside the table range */
+#define PSYCHRO_TEMP_MIN_MC             -40000    /* table range */
+#define PSYCHRO_TEMP_MAX_MC             125000
+#define PSYCHRO_ICE_TEMP_MAX_MC         0         /* ice table ends at 0 'C */
+#define PSYCHRO_STANDARD_PRESSURE_PA    101325
+
+/*!
+* \fn     uint32_t psychro_saturation_pressure_mPa(int32_t temp_mC)
+* \brief  Function returns the saturation vapour pressure over liquid water.
+* \param  temp_mC temperature in milli degree Celsius, clamped to the table range.
+* \return Function returns the pressure in milli Pascal.
+*/
+uint32_t psychro_saturation_pressure_mPa(int32_t temp_mC);
+
+/*!
+* \fn     uint32_t psychro_vapour_pressure_mPa(int32_t temp_mC, uint16_t rh_percentage_100x)
+* \brief  Function returns the partial pressure of water vapour.
+* \param  temp_mC temperature in milli degree Celsius.
+* \param  rh_percentage_100x relative humidity in percentage scaled by 100.
+* \return Function returns the pressure in milli Pascal.
+*/
+uint32_t psychro_vapour_pressure_mPa(int32_t temp_mC, uint16_t rh_percentage_100x);
+
+/*!
+* \fn     int32_t psychro_dew_point_mC(int32_t temp_mC, uint16_t rh_percentage_100x)
+* \brief  Function returns the dew point, the temperature where the air gets saturated over
+*         liquid water.
+* \param  temp_mC temperature in milli degree Celsius.
+* \param  rh_percentage_100x relative humidity in percentage scaled by 100.
+* \return Function returns the dew point in milli degree Celsius or PSYCHRO_ERROR if it is
+*         below the table range (very dry air) or the inputs are invalid.
+*/
+int32_t psychro_dew_point_mC(int32_t temp_mC, uint16_t rh_percentage_100x);
+
+/*!
+* \fn     int32_t psychro_frost_point_mC(int32_t temp_mC, uint16_t rh_percentage_100x)
+* \brief  Function returns the frost point, the temperature where the air gets saturated over
+*         ice. A surface colder than this collects frost.
+* \param  temp_mC temperature in milli degree Celsius.
+* \param  rh_percentage_100x relative humidity in percentage scaled by 100.
+* \return Function returns the frost point in milli degree Celsius. Above 0 'C there is no
+*         frost and the dew point is returned. PSYCHRO_ERROR as for psychro_dew_point_mC.
+*/
+int32_t psychro_frost_point_mC(int32_t temp_mC, uint16_t rh_percentage_100x);
+
+/*!
+* \fn     uint32_t psychro_absolute_humidity_mg_m3(int32_t temp_mC, uint16_t rh_percentage_100x)
+* \brief  Function returns the absolute humidity, the mass of water vapour per volume of air.
+* \return Function returns the absolute humidity in milligram per cubic meter.
+*/
+uint32_t psychro_absolute_humidity_mg_m3(int32_t temp_mC, uint16_t rh_percentage_100x);
+
+/*!
+* \fn     uint32_t psychro_mixing_ratio_mg_kg(int32_t temp_mC, uint16_t rh_percentage_100x, uint32_t pressure_Pa)
+* \brief  Function returns the mixing ratio, the mass of water vapour per mass of dry air.
+* \param  pressure_Pa total air pressure, PSYCHRO_STANDARD_PRESSURE_PA if unknown.
+* \return Function returns the mixing ratio in milligram per kilogram of dry air.
+*/
+uint32_t psychro_mixing_ratio_mg_kg(int32_t temp_mC, uint16_t rh_percentage_100x, uint32_t pressure_Pa);
+
+/*!
+* \fn     int32_t psychro_enthalpy_J_kg(int32_t temp_mC, uint16_t rh_percentage_100x, uint32_t pressure_Pa)
+* \brief  Function returns the specific enthalpy of moist air, referenced to dry air at 0 'C.
+*         The difference between two air streams times the mass flow is the heat they carry,
+*         e.g. for the heat recovery efficiency.
+* \param  pressure_Pa total air pressure, PSYCHRO_STANDARD_PRESSURE_PA if unknown.
+* \return Function returns the enthalpy in Joule per kilogram of dry air, PSYCHRO_ERROR if the
+*         vapour pressure reaches the air pressure.
+*/
+int32_t psychro_enthalpy_J_kg(int32_t temp_mC, uint16_t rh_percentage_100x, uint32_t pressure_Pa);
+
+#endif /* PSYCHROMETRICS_H_ */
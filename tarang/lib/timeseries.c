@@ -0,0 +1,222 @@
+/**
+ * @file  timeseries.c
+ * @author Varun Marolia
+ * @brief This file implements the fixed memory multi resolution time-series store
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "timeseries.h"
+#include <stddef.h>
+
+/*---------------------------------------------------------------------------*/
+static void
+timeseries_tier_reset(timeseries_tier_t *tier, timeseries_bucket_t *buckets, uint16_t size, uint32_t period_ms)
+{
+  tier->buckets = buckets;
+  tier->size = (buckets != NULL) ? size : 0;
+  tier->head = 0;
+  tier->count = 0;
+  tier->period_ms = period_ms;
+  tier->acc_open = false;
+}
+/*---------------------------------------------------------------------------*/
+static void
+timeseries_tier_close(timeseries_tier_t *tier, timeseries_bucket_t *closed, int64_t *closed_sum)
+{
+  *closed_sum = tier->acc_sum;
+  closed->time_ms = tier->acc_time_ms;
+  closed->min = tier->acc_min;
+  closed->max = tier->acc_max;
+  closed->mean = (int32_t)(tier->acc_sum / (int64_t)tier->acc_count);
+  closed->count = (tier->acc_count > UINT16_MAX) ? UINT16_MAX : (uint16_t)tier->acc_count;
+  if(tier->size) {
+    tier->buckets[tier->head] = *closed;
+    tier->head = (tier->head + 1) % tier->size;
+    if(tier->count < tier->size) {
+      tier->count++;
+    }
+  }
+  tier->acc_open = false;
+}
+/*---------------------------------------------------------------------------*/
+/* merges a sample or a closed finer bucket into the bucket being filled. Returns true and the
+ * closed bucket with its sum when the new data starts the next period */
+static bool
+timeseries_tier_add(timeseries_tier_t *tier, uint32_t time_ms, int32_t min, int32_t max,
+                    int64_t sum, uint32_t count, timeseries_bucket_t *closed, int64_t *closed_sum)
+{
+  bool was_closed = false;
+  if(tier->acc_open && (uint32_t)(time_ms - tier->acc_time_ms) >= tier->period_ms) {
+    timeseries_tier_close(tier, closed, closed_sum);
+    was_closed = true;
+  }
+  if(!tier->acc_open) {
+    tier->acc_open = true;
+    tier->acc_time_ms = time_ms - (time_ms % tier->period_ms);
+    tier->acc_min = min;
+    tier->acc_max = max;
+    tier->acc_sum = sum;
+    tier->acc_count = count;
+  } else {
+    if(min < tier->acc_min) {
+      tier->acc_min = min;
+    }
+    if(max > tier->acc_max) {
+      tier->acc_max = max;
+    }
+    tier->acc_sum += sum;
+    tier->acc_count += count;
+  }
+  return was_closed;
+}
+/*---------------------------------------------------------------------------*/
+void
+timeseries_init(timeseries_t *ts, timeseries_sample_t *raw, uint16_t raw_size,
+                timeseries_bucket_t *minute, uint16_t minute_size,
+                timeseries_bucket_t *quarter, uint16_t quarter_size)
+{
+  if(ts == NULL) {
+    return;
+  }
+  ts->raw = raw;
+  ts->raw_size = (raw != NULL) ? raw_size : 0;
+  ts->raw_head = 0;
+  ts->raw_count = 0;
+  timeseries_tier_reset(&ts->tier[0], minute, minute_size, TIMESERIES_MINUTE_MS);
+  timeseries_tier_reset(&ts->tier[1], quarter, quarter_size, TIMESERIES_QUARTER_MS);
+}
+/*---------------------------------------------------------------------------*/
+void
+timeseries_append(timeseries_t *ts, uint32_t time_ms, int32_t value)
+{
+  timeseries_bucket_t closed;
+  int64_t closed_sum;
+  if(ts == NULL) {
+    return;
+  }
+  if(ts->raw_size) {
+    ts->raw[ts->raw_head].time_ms = time_ms;
+    ts->raw[ts->raw_head].value = value;
+    ts->raw_head = (ts->raw_head + 1) % ts->raw_size;
+    if(ts->raw_count < ts->raw_size) {
+      ts->raw_count++;
+    }
+  }
+  /* a closed minute is carried on to the quarter tier with its sum, so the mean stays exact */
+  if(timeseries_tier_add(&ts->tier[0], time_ms, value, value, value, 1, &closed, &closed_sum)) {
+    timeseries_tier_add(&ts->tier[1], closed.time_ms, closed.min, closed.max,
+                        closed_sum, closed.count, &closed, &closed_sum);
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+timeseries_count(const timeseries_t *ts, timeseries_tier_id_t tier)
+{
+  if(ts == NULL || tier >= TIMESERIES_TIER_COUNT) {
+    return 0;
+  }
+  if(tier == TIMESERIES_TIER_RAW) {
+    return ts->raw_count;
+  }
+  return ts->tier[tier - 1].count;
+}
+/*---------------------------------------------------------------------------*/
+bool
+timeseries_get(const timeseries_t *ts, timeseries_tier_id_t tier, uint16_t index, timeseries_bucket_t *bucket)
+{
+  const timeseries_tier_t *t;
+  uint16_t pos;
+  if(bucket == NULL || index >= timeseries_count(ts, tier)) {
+    return false;
+  }
+  if(tier == TIMESERIES_TIER_RAW) {
+    pos = (ts->raw_head + ts->raw_size - 1 - index) % ts->raw_size;
+    bucket->time_ms = ts->raw[pos].time_ms;
+    bucket->min = ts->raw[pos].value;
+    bucket->max = ts->raw[pos].value;
+    bucket->mean = ts->raw[pos].value;
+    bucket->count = 1;
+    return true;
+  }
+  t = &ts->tier[tier - 1];
+  pos = (t->head + t->size - 1 - index) % t->size;
+  *bucket = t->buckets[pos];
+  return true;
+}
+/*---------------------------------------------------------------------------*/
+bool
+timeseries_query(const timeseries_t *ts, timeseries_tier_id_t tier, uint32_t from_ms, uint32_t to_ms,
+                 timeseries_bucket_t *result)
+{
+  const timeseries_tier_t *t = NULL;
+  timeseries_bucket_t entry;
+  uint32_t span = to_ms - from_ms;
+  uint32_t count = 0;
+  int64_t sum = 0;
+  uint16_t i, n;
+
+  if(ts == NULL || result == NULL || tier >= TIMESERIES_TIER_COUNT) {
+    return false;
+  }
+  if(tier != TIMESERIES_TIER_RAW) {
+    t = &ts->tier[tier - 1];
+    if(t->acc_open && (uint32_t)(to_ms - t->acc_time_ms) <= span) {
+      result->time_ms = t->acc_time_ms;
+      result->min = t->acc_min;
+      result->max = t->acc_max;
+      sum = t->acc_sum;
+      count = t->acc_count;
+    }
+  }
+  n = timeseries_count(ts, tier);
+  for(i = 0; i < n; i++) {
+    timeseries_get(ts, tier, i, &entry);
+    if((uint32_t)(to_ms - entry.time_ms) > span) {
+      if((int32_t)(to_ms - entry.time_ms) < 0) {
+        continue;     /* newer than the range end */
+      }
+      break;          /* older than the range start, the rest is older too */
+    }
+    if(count == 0) {
+      result->min = entry.min;
+      result->max = entry.max;
+    } else {
+      if(entry.min < result->min) {
+        result->min = entry.min;
+      }
+      if(entry.max > result->max) {
+        result->max = entry.max;
+      }
+    }
+    result->time_ms = entry.time_ms;
+    sum += (int64_t)entry.mean * entry.count;
+    count += entry.count;
+  }
+  if(count == 0) {
+    return false;
+  }
+  result->mean = (int32_t)(sum / (int64_t)count);
+  result->count = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t)count;
+  return true;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,121 @@
+#ifndef TIMESERIES_H_
+#define TIMESERIES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed memory time-series store. Samples are fixed point int32_t values (e.g. mC or %RH x 100)
+ * with a 32 bit millisecond timestamp. The raw ring keeps the last samples as they are, two
+ * tiers keep min/max/mean buckets per minute and per 15 minutes. A closed minute bucket is
+ * merged into the running 15 minute bucket, so an append is O(1) whatever the tier sizes are.
+ * The buffers are given by the caller. Timestamps are compared with wrap safe differences, so
+ * the covered history must stay below 49 days.
+ */
+
+typedef enum timeseries_tier_id {
+  TIMESERIES_TIER_RAW = 0,
+  TIMESERIES_TIER_MINUTE,
+  TIMESERIES_TIER_QUARTER,
+  TIMESERIES_TIER_COUNT
+} timeseries_tier_id_t;
+
+#define TIMESERIES_MINUTE_MS      60000UL
+#define TIMESERIES_QUARTER_MS     (15 * TIMESERIES_MINUTE_MS)
+
+typedef struct timeseries_sample {
+  uint32_t time_ms;
+  int32_t value;
+} timeseries_sample_t;
+
+typedef struct timeseries_bucket {
+  uint32_t time_ms;           /* bucket start, aligned to the tier period */
+  int32_t min;
+  int32_t max;
+  int32_t mean;
+  uint16_t count;             /* raw samples in the bucket */
+} timeseries_bucket_t;
+
+typedef struct timeseries_tier {
+  timeseries_bucket_t *buckets;
+  uint16_t size;
+  uint16_t head;              /* next write index */
+  uint16_t count;
+  uint32_t period_ms;
+  /* bucket being filled */
+  bool acc_open;
+  uint32_t acc_time_ms;
+  int32_t acc_min;
+  int32_t acc_max;
+  int64_t acc_sum;
+  uint32_t acc_count;
+} timeseries_tier_t;
+
+typedef struct timeseries {
+  timeseries_sample_t *raw;
+  uint16_t raw_size;
+  uint16_t raw_head;          /* next write index */
+  uint16_t raw_count;
+  timeseries_tier_t tier[TIMESERIES_TIER_COUNT - 1];  /* minute and quarter tiers */
+} timeseries_t;
+
+/*!
+* \fn     void timeseries_init(timeseries_t *ts, timeseries_sample_t *raw, uint16_t raw_size,
+*                              timeseries_bucket_t *minute, uint16_t minute_size,
+*                              timeseries_bucket_t *quarter, uint16_t quarter_size)
+* \brief  Function initializes an empty series on the given buffers.
+* \param  ts Pointer to the series.
+* \param  raw Pointer to the raw sample ring, raw_size entries.
+* \param  minute Pointer to the per minute bucket ring, minute_size entries.
+* \param  quarter Pointer to the per 15 minute bucket ring, quarter_size entries.
+*/
+void timeseries_init(timeseries_t *ts, timeseries_sample_t *raw, uint16_t raw_size,
+                     timeseries_bucket_t *minute, uint16_t minute_size,
+                     timeseries_bucket_t *quarter, uint16_t quarter_size);
+
+/*!
+* \fn     void timeseries_append(timeseries_t *ts, uint32_t time_ms, int32_t value)
+* \brief  Function appends a sample. Timestamps must not go backwards. The oldest entries of a
+*         full ring are overwritten.
+* \param  ts Pointer to the series.
+* \param  time_ms Sample time, e.g. clock_get_time_ms().
+* \param  value Fixed point sample value.
+*/
+void timeseries_append(timeseries_t *ts, uint32_t time_ms, int32_t value);
+
+/*!
+* \fn     uint16_t timeseries_count(const timeseries_t *ts, timeseries_tier_id_t tier)
+* \brief  Function returns the number of stored entries of a tier. The bucket being filled is not
+*         counted.
+*/
+uint16_t timeseries_count(const timeseries_t *ts, timeseries_tier_id_t tier);
+
+/*!
+* \fn     bool timeseries_get(const timeseries_t *ts, timeseries_tier_id_t tier, uint16_t index, timeseries_bucket_t *bucket)
+* \brief  Function returns a stored entry in O(1). Raw samples are returned as a bucket with
+*         min, max and mean equal to the value.
+* \param  ts Pointer to the series.
+* \param  tier Tier to read.
+* \param  index Entry index, 0 is the newest.
+* \param  bucket Pointer to the output bucket.
+* \return Function returns false if the index is out of range.
+*/
+bool timeseries_get(const timeseries_t *ts, timeseries_tier_id_t tier, uint16_t index, timeseries_bucket_t *bucket);
+
+/*!
+* \fn     bool timeseries_query(const timeseries_t *ts, timeseries_tier_id_t tier, uint32_t from_ms, uint32_t to_ms, timeseries_bucket_t *result)
+* \brief  Function aggregates min, max and mean of the entries of a tier with a start time in
+*         [from_ms, to_ms]. The ring is walked from the newest entry and stops at the first entry
+*         older than from_ms, so only the entries in range are visited. The bucket being filled
+*         is included, so a query up to now sees the latest samples on every tier.
+* \param  ts Pointer to the series.
+* \param  tier Tier to query, a coarser tier covers a longer history with fewer entries.
+* \param  from_ms Range start.
+* \param  to_ms Range end.
+* \param  result Pointer to the output, time_ms is set to the oldest entry in range.
+* \return Function returns false if there is no entry in range.
+*/
+bool timeseries_query(const timeseries_t *ts, timeseries_tier_id_t tier, uint32_t from_ms, uint32_t to_ms,
+                      timeseries_bucket_t *result);
+
+#endif /* TIMESERIES_H_ */
@@ -13,7 +13,10 @@ typedef uint64_t clock_time_t;        /* 64 bit 1 msecond tick counter. will tak
 void clock_init(void);                      /* Initialize sysTick clock hardware to produce 1 msecond tick */
 clock_time_t clock_get_ticks(void);         /* return system ticks since boot */
 clock_time_t clock_get_time_ms(void);       /* return time in mseconds since boot*/
+clock_time_t clock_get_time_us(void);       /* return time in useconds since boot, also valid with interrupts disabled */
 clock_time_t clock_get_seconds(void);       /* returns seconds past since last boot */
 void clock_wait_ms(clock_time_t time_ms);   /* busy wait for given amount of miliseconds */
 void clock_wait_us(uint32_t time_us);       /* buys wait for fiven amount fo microseconds */
+uint32_t clock_get_cycles(void);            /* CPU cycle counter, wraps around. Use differences only */
+uint32_t clock_cycles_to_us(uint32_t cycles); /* converts a cycle count into microseconds */
 #endif /* _CLOCK_H_ */
@@ -0,0 +1,95 @@
+/**
+ * @file log.c
+ * @author Varun Marolia
+ * @brief This file implements the leveled logging core. It keeps the runtime
+ *        level of every module and forwards the enabled messages to the
+ *        selected back end.
+ *
+ * @copyright Copyright (c) 2025 Varun Marolia
+ *   MIT License
+ *   Permission is hereby granted, free of charge, to any person obtaining a copy
+ *   of this software and associated documentation files (the "Software"), to deal
+ *   in the Software without restriction, including without limitation the rights
+ *   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *   copies of the Software, and to permit persons to whom the Software is
+ *   furnished to do so, subject to the following conditions:**
+ *
+ *   The above copyright notice and this permission notice shall be included in all
+ *   copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *   SOFTWARE.
+ *
+ */
+
+#include "log.h"
+#include <stdio.h>
+#include <stddef.h>
+
+uint8_t log_levels[LOG_MODULE_COUNT] = {
+  [0 ... (LOG_MODULE_COUNT - 1)] = LOG_LEVEL_DEFAULT
+};
+static log_backend_t log_backend = log_backend_text;
+/* set while a message is passed to the back end. A message logged by the output path itself,
+   e.g. by the uart driver stdout runs on, or by an interrupt in between is dropped */
+static volatile bool log_busy = false;
+static const char log_level_tags[] = { '-', 'E', 'W', 'I', 'D' };
+/*---------------------------------------------------------------------------*/
+void
+log_backend_text(uint8_t module, uint8_t level, const char *fmt, va_list args)
+{
+  (void)module;
+  if(level < sizeof(log_level_tags)) {
+    printf("[%c] ", log_level_tags[level]);
+  }
+  vprintf(fmt, args);
+}
+/*---------------------------------------------------------------------------*/
+void
+log_output(uint8_t module, uint8_t level, const char *fmt, ...)
+{
+  va_list args;
+  log_backend_t backend = log_backend;
+  if(backend == NULL || level > LOG_LEVEL_MAX || log_busy) {
+    return;
+  }
+  log_busy = true;
+  va_start(args, fmt);
+  backend(module, level, fmt, args);
+  va_end(args);
+  log_busy = false;
+}
+/*---------------------------------------------------------------------------*/
+void
+log_set_level(uint8_t module, uint8_t level)
+{
+  uint8_t i;
+  if(module < LOG_MODULE_COUNT) {
+    log_levels[module] = level;
+  } else if(module == LOG_MODULE_COUNT) {
+    for(i = 0; i < LOG_MODULE_COUNT; i++) {
+      log_levels[i] = level;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+log_get_level(uint8_t module)
+{
+  if(module >= LOG_MODULE_COUNT) {
+    return LOG_LEVEL_NONE;
+  }
+  return log_levels[module];
+}
+/*---------------------------------------------------------------------------*/
+void
+log_set_backend(log_backend_t backend)
+{
+  log_backend = (backend != NULL) ? backend : log_backend_text;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,131 @@
+/*!
+*\file  log.h
+*\brief This file holds the leveled logging interface. Every log call belongs to a module
+*       and a level. Calls above LOG_LEVEL_MAX are removed by the preprocessor, calls of a
+*       module whose runtime level is lower than the call level return before any of the
+*       arguments are evaluated. The messages are handed to the selected back end, the
+*       default one prints the text on stdout.
+*
+*       Usage in a source file:
+*         #define LOG_MODULE LOG_MODULE_NTC
+*         #include "log.h"
+*         LOG_DBG("NTC: resistance:%lu\n", resistance);
+*/
+
+#ifndef _LOG_H_
+#define _LOG_H_
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+/* log levels, lower value is more important */
+#define LOG_LEVEL_NONE            0
+#define LOG_LEVEL_ERR             1
+#define LOG_LEVEL_WARN            2
+#define LOG_LEVEL_INFO            3
+#define LOG_LEVEL_DBG             4
+
+/* compile time ceiling. Calls above this level are not compiled in */
+#ifndef LOG_CONF_LEVEL_MAX
+#define LOG_LEVEL_MAX             LOG_LEVEL_INFO
+#else
+#define LOG_LEVEL_MAX             LOG_CONF_LEVEL_MAX
+#endif /* LOG_CONF_LEVEL_MAX */
+
+/* runtime level of every module after boot */
+#ifndef LOG_CONF_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT         LOG_LEVEL_WARN
+#else
+#define LOG_LEVEL_DEFAULT         LOG_CONF_LEVEL_DEFAULT
+#endif /* LOG_CONF_LEVEL_DEFAULT */
+
+typedef enum log_module {
+  LOG_MODULE_MAIN = 0,
+  LOG_MODULE_SERIAL_ARCH,
+  LOG_MODULE_DMA_ARCH,
+  LOG_MODULE_ADC_ARCH,
+  LOG_MODULE_PWM_ARCH,
+  LOG_MODULE_WATCHDOG,
+  LOG_MODULE_SERIAL_DEV,
+  LOG_MODULE_GUART,
+  LOG_MODULE_TELEMETRY,
+  LOG_MODULE_SENSIRION,
+  LOG_MODULE_SHT4X,
+  LOG_MODULE_NTC,
+  LOG_MODULE_FAN_BLOWER,
+  LOG_MODULE_APP,
+  LOG_MODULE_COUNT
+} log_module_t;
+
+/* back end output function. Called with the format string and its arguments */
+typedef void (* log_backend_t)(uint8_t module, uint8_t level, const char *fmt, va_list args);
+
+extern uint8_t log_levels[LOG_MODULE_COUNT];
+
+/*!
+* \fn     void log_output(uint8_t module, uint8_t level, const char *fmt, ...)
+* \brief  Function passes a message to the current back end. Use the LOG_x macros instead
+*         of calling this directly, they do the level checks. A message logged while the back
+*         end is busy, i.e. from the output path or an interrupt, is dropped.
+* \param  module log module, see log_module_t.
+* \param  level log level of the message.
+* \param  fmt printf style format string.
+*/
+void log_output(uint8_t module, uint8_t level, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/*!
+* \fn     void log_set_level(uint8_t module, uint8_t level)
+* \brief  Function sets the runtime level of a module. Messages above this level are skipped.
+* \param  module log module, see log_module_t. LOG_MODULE_COUNT sets all the modules.
+* \param  level new level, LOG_LEVEL_NONE to silence the module.
+*/
+void log_set_level(uint8_t module, uint8_t level);
+
+/*!
+* \fn     uint8_t log_get_level(uint8_t module)
+* \brief  Function returns the runtime level of a module.
+*/
+uint8_t log_get_level(uint8_t module);
+
+/*!
+* \fn     void log_set_backend(log_backend_t backend)
+* \brief  Function selects the output back end. Pass NULL for the default text back end.
+* \param  backend back end output function.
+*/
+void log_set_backend(log_backend_t backend);
+
+/*!
+* \fn     void log_backend_text(uint8_t module, uint8_t level, const char *fmt, va_list args)
+* \brief  Default back end, prints the level tag and the message on stdout.
+*/
+void log_backend_text(uint8_t module, uint8_t level, const char *fmt, va_list args);
+
+/* the runtime check comes first so that the arguments are only evaluated for enabled modules */
+#define LOG_MODULE_LEVEL(module, level, ...)                          \
+  do {                                                                \
+    if(log_levels[(module)] >= (level)) {                             \
+      log_output((module), (level), __VA_ARGS__);                     \
+    }                                                                 \
+  } while(0)
+
+#if LOG_LEVEL_MAX >= LOG_LEVEL_ERR
+#define LOG_ERR(...)              LOG_MODULE_LEVEL(LOG_MODULE, LOG_LEVEL_ERR, __VA_ARGS__)
+#else
+#define LOG_ERR(...)
+#endif
+#if LOG_LEVEL_MAX >= LOG_LEVEL_WARN
+#define LOG_WARN(...)             LOG_MODULE_LEVEL(LOG_MODULE, LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...)
+#endif
+#if LOG_LEVEL_MAX >= LOG_LEVEL_INFO
+#define LOG_INFO(...)             LOG_MODULE_LEVEL(LOG_MODULE, LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...)
+#endif
+#if LOG_LEVEL_MAX >= LOG_LEVEL_DBG
+#define LOG_DBG(...)              LOG_MODULE_LEVEL(LOG_MODULE, LOG_LEVEL_DBG, __VA_ARGS__)
+#else
+#define LOG_DBG(...)
+#endif
+#endif /* _LOG_H_ */
@@ -0,0 +1,164 @@
+/*
+ * ADC filter host test. Runs the filter chains of tarang/lib/filter.c over a
+ * trace of ADC samples and prints per chain:
+ *   - RMS and max error against the true value (synthetic trace only)
+ *   - spikes that pass, i.e. outputs more than SPIKE_CODES off the truth
+ *   - samples until the output settles after a real step
+ *   - std deviation of the sample to sample change, the noise control code sees
+ * A trace recorded on the board can be given as a text file with one sample per
+ * line, or CSV where the last column is the sample (e.g. time_ms,code).
+ * Without a file the HRV NTC channel is simulated at the acquisition rate, one
+ * sample per ACQUISITION_PERIOD_MS as acquisition_read_adc() feeds the board
+ * chain: raw codes of a slow temperature swing with ADC noise, heater switching
+ * spikes and a real step when the fan reverses. Settling is given in seconds.
+ *
+ * build: gcc -O2 -I../tarang/lib -o adc_filter_bench adc_filter_bench.c ../tarang/lib/filter.c -lm
+ * usage: adc_filter_bench [trace.csv]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "filter.h"
+
+#define SAMPLE_PERIOD_MS        1000            /* ACQUISITION_PERIOD_MS of apps/vayu/acquisition.h */
+#define SIM_SAMPLES             (2 * 60 * 60 * 1000 / SAMPLE_PERIOD_MS)  /* 2 hours */
+#define MAX_SAMPLES             200000
+#define NOISE_CODES             4.0             /* uniform +- */
+#define SPIKE_CODES             60              /* error that counts as a passed spike */
+#define SPIKE_PERCENT           2               /* samples that catch a heater PWM edge */
+#define STEP_AT                 (SIM_SAMPLES / 2)
+#define STEP_CODES              250             /* fan reversal, about 5.5 'C */
+#define STEP_WINDOW             (10000 / SAMPLE_PERIOD_MS)  /* samples after the step left out of max and spikes */
+#define SETTLE_CODES            10
+#define SETTLE_MAX_S            5               /* the board chain must follow the step within this time */
+#define MAX_LINE                256
+
+typedef struct chain {
+    const char *name;
+    filter_cfg_t cfg;
+} chain_t;
+
+static const chain_t chains[] = {
+    { "raw",                  { .stage = { { FILTER_NONE, 0, 0 } } } },
+    { "median 3",             { .stage = { { FILTER_MEDIAN, 3, 0 } } } },
+    { "median 5",             { .stage = { { FILTER_MEDIAN, 5, 0 } } } },
+    { "ema 1/4",              { .stage = { { FILTER_EMA, FILTER_ALPHA_ONE / 4, 0 } } } },
+    { "ema 1/16",             { .stage = { { FILTER_EMA, FILTER_ALPHA_ONE / 16, 0 } } } },
+    { "outlier 100/5",        { .stage = { { FILTER_OUTLIER, 100, 5 } } } },
+    { "outlier 100/3",        { .stage = { { FILTER_OUTLIER, 100, 3 } } } },
+    { "rate 20",              { .stage = { { FILTER_RATE_LIMIT, 20, 0 } } } },
+    /* the chain tuned for 10 Hz samples, far too slow once per acquisition cycle */
+    { "median 5+outlier+ema", { .stage = { { FILTER_MEDIAN, 5, 0 }, { FILTER_OUTLIER, 100, 5 },
+                                           { FILTER_EMA, FILTER_ALPHA_ONE / 4, 0 } } } },
+    /* vayu HRV NTC chain, see board.c */
+    { "outlier+ema 3/4",      { .stage = { { FILTER_OUTLIER, 100, 3 },
+                                           { FILTER_EMA, FILTER_ALPHA_ONE * 3 / 4, 0 } } } },
+};
+
+static double uniform(void)
+{
+    return (double)rand() / RAND_MAX * 2.0 - 1.0;
+}
+
+static int simulate(int32_t *sample, double *truth)
+{
+    int i;
+    srand(1);
+    for (i = 0; i < SIM_SAMPLES; i++) {
+        /* 10 minute swing around mid scale, step at the fan reversal */
+        truth[i] = 2048.0 + 150.0 * sin(i * 2.0 * M_PI / (600000.0 / SAMPLE_PERIOD_MS))
+                   + ((i >= STEP_AT) ? STEP_CODES : 0);
+        sample[i] = (int32_t)lround(truth[i] + NOISE_CODES * uniform());
+        /* heater PWM edges: a burst lasts less than 300 ms, so it hits single samples, now and
+           then two in a row */
+        if (rand() % 100 < SPIKE_PERCENT) {
+            sample[i] += (rand() % 2) ? 400 : -300;
+        }
+    }
+    return SIM_SAMPLES;
+}
+
+static int load(const char *name, int32_t *sample, double *truth, int max)
+{
+    FILE *file = fopen(name, "r");
+    char line[MAX_LINE];
+    char *field;
+    int n = 0;
+    if (!file) {
+        perror(name);
+        exit(EXIT_FAILURE);
+    }
+    while (n < max && fgets(line, sizeof(line), file)) {
+        field = strrchr(line, ',');
+        field = field ? field + 1 : line;
+        if (sscanf(field, "%d", &sample[n]) == 1) {
+            truth[n] = NAN;
+            n++;
+        }
+    }
+    fclose(file);
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    static int32_t sample[MAX_SAMPLES];
+    static double truth[MAX_SAMPLES];
+    filter_t filter;
+    int n, i;
+    size_t c;
+    int failed = 0;
+
+    n = (argc > 1) ? load(argv[1], sample, truth, MAX_SAMPLES) : simulate(sample, truth);
+    if (n < 2) {
+        fprintf(stderr, "trace too short\n");
+        return EXIT_FAILURE;
+    }
+    printf("%d samples%s\n", n, (argc > 1) ? "" : ", simulated HRV NTC, one per acquisition cycle");
+    printf("%-22s %8s %8s %7s %7s %9s %9s %9s\n", "chain", "rms", "max", "spikes", "settle",
+           "d-noise", "outliers", "limited");
+    for (c = 0; c < sizeof(chains) / sizeof(chains[0]); c++) {
+        double sq = 0, max_err = 0, d_sum = 0, d_sq = 0, err;
+        int spikes = 0, settle = -1;
+        int32_t y, last = 0;
+        filter_init(&filter, &chains[c].cfg);
+        for (i = 0; i < n; i++) {
+            y = filter_update(&filter, sample[i]);
+            if (i > 0) {
+                d_sum += y - last;
+                d_sq += (double)(y - last) * (y - last);
+            }
+            last = y;
+            if (isnan(truth[i])) {
+                continue;
+            }
+            err = y - truth[i];
+            sq += err * err;
+            if (fabs(err) > max_err && (i < STEP_AT || i > STEP_AT + STEP_WINDOW)) {
+                max_err = fabs(err);
+            }
+            if (fabs(err) > SPIKE_CODES && (i < STEP_AT || i > STEP_AT + STEP_WINDOW)) {
+                spikes++;
+            }
+            if (i >= STEP_AT && settle < 0 && fabs(err) <= SETTLE_CODES) {
+                settle = i - STEP_AT;
+            }
+        }
+        printf("%-22s %8.2f %8.1f %7d %7.1f %9.2f %9lu %9lu\n", chains[c].name,
+               isnan(truth[0]) ? NAN : sqrt(sq / n), isnan(truth[0]) ? NAN : max_err, spikes,
+               (settle < 0) ? NAN : settle * (SAMPLE_PERIOD_MS / 1000.0),
+               sqrt(d_sq / (n - 1) - (d_sum / (n - 1)) * (d_sum / (n - 1))),
+               (unsigned long)filter.outliers, (unsigned long)filter.limited);
+        /* the board chain must remove the spikes and still follow the real step */
+        if (!isnan(truth[0]) && c == (sizeof(chains) / sizeof(chains[0])) - 1 && (spikes > 0 || settle < 0 || settle * SAMPLE_PERIOD_MS > SETTLE_MAX_S * 1000)) {
+            failed = 1;
+        }
+    }
+    if (failed) {
+        fprintf(stderr, "board chain passes spikes or does not follow the step\n");
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * CRC8 host benchmark. Compares the bitwise and the table driven CRC8 of
+ * tarang/lib/crc8.c on the Sensirion pattern (2 data bytes + CRC byte) and on
+ * a longer buffer. Before timing it checks that both variants agree for every
+ * 16 bit word and for the data sheet example (0xBEEF -> 0x92).
+ *
+ * build: gcc -O2 -I../tarang/lib -o crc8_bench crc8_bench.c ../tarang/lib/crc8.c
+ * usage: crc8_bench [iterations]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "crc8.h"
+
+#define SENSIRION_POLYNOMIAL        0x31
+#define SENSIRION_INITIAL_REMAINDER 0xFF
+#define SENSIRION_FINAL_XOR_VALUE   0x00
+#define DEFAULT_ITERATIONS          2000000UL
+#define BUFFER_SIZE                 255
+
+CRC8_TABLE_DEFINE(bench_table, SENSIRION_POLYNOMIAL);
+
+static const crc8_cfg_t bitwise_cfg = {
+    SENSIRION_POLYNOMIAL, SENSIRION_INITIAL_REMAINDER, SENSIRION_FINAL_XOR_VALUE, NULL
+};
+static const crc8_cfg_t table_cfg = {
+    SENSIRION_POLYNOMIAL, SENSIRION_INITIAL_REMAINDER, SENSIRION_FINAL_XOR_VALUE, bench_table
+};
+
+/* keeps the compiler from dropping the loops */
+static volatile uint8_t sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int check(void)
+{
+    uint8_t word[2] = {0xBE, 0xEF};
+    uint32_t value;
+    if (crc8_calc_word(&bitwise_cfg, word) != 0x92 || crc8_calc_word(&table_cfg, word) != 0x92) {
+        fprintf(stderr, "data sheet example failed\n");
+        return 0;
+    }
+    for (value = 0; value <= 0xFFFF; value++) {
+        word[0] = (uint8_t)(value >> 8);
+        word[1] = (uint8_t)value;
+        if (crc8_calc_word(&table_cfg, word) != crc8_calc_buff(&bitwise_cfg, word, 2) ||
+            crc8_calc_buff(&table_cfg, word, 2) != crc8_calc_buff(&bitwise_cfg, word, 2)) {
+            fprintf(stderr, "mismatch at 0x%04x\n", (unsigned)value);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void bench_words(const char *name, const crc8_cfg_t *cfg, unsigned long iterations)
+{
+    uint8_t word[2];
+    uint8_t acc = 0;
+    unsigned long i;
+    double start, elapsed;
+    start = now_s();
+    for (i = 0; i < iterations; i++) {
+        word[0] = (uint8_t)(i >> 8);
+        word[1] = (uint8_t)i;
+        acc ^= crc8_calc_word(cfg, word);
+    }
+    elapsed = now_s() - start;
+    sink = acc;
+    printf("%-8s word  %8.2f ns/word  %8.1f MB/s\n", name, elapsed * 1e9 / iterations,
+           2.0 * iterations / elapsed / 1e6);
+}
+
+static void bench_buffer(const char *name, const crc8_cfg_t *cfg, unsigned long iterations)
+{
+    uint8_t buff[BUFFER_SIZE];
+    uint8_t acc = 0;
+    unsigned long i, rounds = iterations / BUFFER_SIZE * 2 + 1;
+    double start, elapsed;
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        buff[i] = (uint8_t)(i * 7);
+    }
+    start = now_s();
+    for (i = 0; i < rounds; i++) {
+        buff[0] = (uint8_t)i;
+        acc ^= crc8_calc_buff(cfg, buff, BUFFER_SIZE);
+    }
+    elapsed = now_s() - start;
+    sink = acc;
+    printf("%-8s buff  %8.2f ns/byte  %8.1f MB/s\n", name, elapsed * 1e9 / (rounds * BUFFER_SIZE),
+           (double)rounds * BUFFER_SIZE / elapsed / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 0);
+        if (iterations == 0) {
+            fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!check()) {
+        return EXIT_FAILURE;
+    }
+    printf("table and bitwise CRC8 agree for all 65536 words\n");
+    bench_words("bitwise", &bitwise_cfg, iterations);
+    bench_words("table", &table_cfg, iterations);
+    bench_buffer("bitwise", &bitwise_cfg, iterations);
+    bench_buffer("table", &table_cfg, iterations);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Estimator host test. Runs the alpha-beta estimator of tarang/lib/estimator.c
+ * over a temperature trace and compares it with the raw samples:
+ *   - RMS error against the true value (synthetic trace only)
+ *   - number of crossings of a threshold with hysteresis-free on/off logic,
+ *     i.e. the chatter the control code would see
+ *   - lead time of the predicted crossing over the raw crossing
+ * A trace recorded from the vayu telemetry can be given as CSV with the
+ * columns time_ms,temp_mC,heater_100x,fan (fan -10000..10000, + is exhaust).
+ * Without a file a heat accumulator model with sensor noise and spikes is run.
+ *
+ * build: gcc -O2 -I../tarang/lib -o estimator_bench estimator_bench.c ../tarang/lib/estimator.c -lm
+ * usage: estimator_bench [trace.csv] [threshold_mC]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include "estimator.h"
+
+#define DEFAULT_THRESHOLD_MC    5000        /* TEMPERATURE_DEFROSTING in vayu */
+#define SAMPLE_PERIOD_MS        1000
+#define SIM_SAMPLES             (6 * 3600)  /* 6 hours at 1 Hz */
+#define NOISE_MC                250.0       /* NTC + ADC noise, uniform +- */
+#define MAX_LINE                256
+
+typedef struct trace_sample {
+    uint32_t time_ms;
+    int32_t temp_mC;
+    int32_t heater;
+    int32_t fan;
+    double truth;                           /* NAN for recorded traces */
+} trace_sample_t;
+
+/* same gains as the vayu heat accumulator estimator */
+static const estimator_cfg_t cfg = {
+    .alpha_q16 = 6554,                      /* 0.1 */
+    .beta_q16 = 345,                        /* ~ alpha^2 / (2 - alpha) */
+    .input_gain = { 40, 10 },               /* heater, fan: mC/s at full scale */
+    .gate = 5000
+};
+
+static double uniform(void)
+{
+    return (double)rand() / RAND_MAX * 2.0 - 1.0;
+}
+
+/* heat accumulator: first order towards the air it sees plus the heater */
+static int simulate(trace_sample_t *trace)
+{
+    double t = 12000.0, outside = -5000.0, room = 10000.0;
+    int i;
+    srand(1);
+    for (i = 0; i < SIM_SAMPLES; i++) {
+        int32_t fan = ((i / 70) % 2) ? 10000 : -10000;     /* 70 s direction toggle */
+        int32_t heater = (t < 3000.0) ? 10000 : ((t > 8000.0) ? 0 : trace[i > 0 ? i - 1 : 0].heater);
+        double air = fan > 0 ? room : outside;
+        outside = -5000.0 + 3000.0 * sin(i / 3600.0);
+        t += (air - t) / 900.0 + heater / 10000.0 * 40.0;
+        trace[i].time_ms = (uint32_t)i * SAMPLE_PERIOD_MS;
+        trace[i].truth = t;
+        trace[i].temp_mC = (int32_t)(t + NOISE_MC * uniform());
+        if (rand() % 500 == 0) {
+            trace[i].temp_mC += 20000;      /* ADC spike */
+        }
+        trace[i].heater = heater;
+        trace[i].fan = fan;
+    }
+    return SIM_SAMPLES;
+}
+
+static int load(const char *name, trace_sample_t *trace, int max)
+{
+    FILE *file = fopen(name, "r");
+    char line[MAX_LINE];
+    int n = 0;
+    unsigned long time_ms;
+    long temp, heater, fan;
+    if (!file) {
+        perror(name);
+        exit(EXIT_FAILURE);
+    }
+    while (n < max && fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%lu,%ld,%ld,%ld", &time_ms, &temp, &heater, &fan) == 4) {
+            trace[n].time_ms = (uint32_t)time_ms;
+            trace[n].temp_mC = (int32_t)temp;
+            trace[n].heater = (int32_t)heater;
+            trace[n].fan = (int32_t)fan;
+            trace[n].truth = NAN;
+            n++;
+        }
+    }
+    fclose(file);
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    static trace_sample_t trace[SIM_SAMPLES];
+    estimator_t est;
+    int32_t threshold = DEFAULT_THRESHOLD_MC;
+    int n, i;
+    int raw_below = -1, est_below = -1, true_below = -1;
+    int raw_crossings = 0, est_crossings = 0, true_crossings = 0;
+    double raw_sq = 0, est_sq = 0;
+    long lead_sum = 0, leads = 0;
+    uint32_t predicted_at = 0;
+
+    n = (argc > 1) ? load(argv[1], trace, SIM_SAMPLES) : simulate(trace);
+    if (argc > 2) {
+        threshold = atoi(argv[2]);
+    }
+    if (n < 2) {
+        fprintf(stderr, "trace too short\n");
+        return EXIT_FAILURE;
+    }
+    estimator_init(&est, &cfg);
+    for (i = 0; i < n; i++) {
+        int32_t value;
+        uint32_t eta;
+        estimator_set_input(&est, 0, trace[i].heater);
+        estimator_set_input(&est, 1, trace[i].fan);
+        estimator_update(&est, trace[i].time_ms, trace[i].temp_mC);
+        value = estimator_get_value(&est);
+        if (!isnan(trace[i].truth)) {
+            raw_sq += (trace[i].temp_mC - trace[i].truth) * (trace[i].temp_mC - trace[i].truth);
+            est_sq += (value - trace[i].truth) * (value - trace[i].truth);
+        }
+        /* falling crossing predicted within 60 s */
+        eta = estimator_time_to_reach_ms(&est, threshold);
+        if (value > threshold && eta < 60000 && predicted_at == 0) {
+            predicted_at = trace[i].time_ms;
+        }
+        if (raw_below != (trace[i].temp_mC < threshold)) {
+            if (raw_below == 0 && predicted_at) {
+                lead_sum += (long)(trace[i].time_ms - predicted_at);
+                leads++;
+            }
+            raw_crossings += raw_below >= 0;
+            raw_below = trace[i].temp_mC < threshold;
+            if (raw_below) {
+                predicted_at = 0;
+            }
+        }
+        if (!isnan(trace[i].truth) && true_below != (trace[i].truth < threshold)) {
+            true_crossings += true_below >= 0;
+            true_below = trace[i].truth < threshold;
+        }
+        if (est_below != (value < threshold)) {
+            est_crossings += est_below >= 0;
+            est_below = value < threshold;
+        }
+    }
+    printf("%d samples, threshold %d mC\n", n, threshold);
+    if (raw_sq > 0) {
+        printf("rms error      raw %7.1f mC  estimator %7.1f mC\n", sqrt(raw_sq / n), sqrt(est_sq / n));
+    }
+    printf("crossings      raw %7d     estimator %7d", raw_crossings, est_crossings);
+    if (true_crossings) {
+        printf("     true %d", true_crossings);
+    }
+    printf("\n");
+    if (leads) {
+        printf("prediction lead before raw falling crossing: %.1f s average over %ld\n",
+               lead_sum / 1000.0 / leads, leads);
+    }
+    printf("updates %lu rejected %lu\n", (unsigned long)est.updates, (unsigned long)est.rejects);
+    if (raw_sq > 0 && (est_sq >= raw_sq || est_crossings > raw_crossings)) {
+        fprintf(stderr, "estimator is not better than the raw samples\n");
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * Host stand-in for tarang/dev/common/adc-dev.h. Only what the conversion code of
+ * tarang/dev/ntc/ntc.c needs, so that the benches in tools/ run the shipped code.
+ * The read functions are defined by the bench.
+ */
+#ifndef _ADC_DEV_H_
+#define _ADC_DEV_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_RESOLTION_BITS            12                                /* EFR32 ADC, 12 bit */
+#define ADC_RESOLUTION                (0x00001 << ADC_RESOLTION_BITS)
+
+typedef enum adc_status {
+  ADC_OK = 0,
+  ADC_BUSY = 1,
+  ADC_INVALID = 2
+} adc_status_t;
+
+typedef struct adc_dev adc_dev_t;
+
+adc_status_t adc_dev_read_microvolts(adc_dev_t *dev, uint32_t *microvolts);
+adc_status_t adc_dev_read_single(adc_dev_t *dev, uint32_t *adc_value);
+
+#endif  /* _ADC_DEV_H_ */
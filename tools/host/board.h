@@ -0,0 +1,4 @@
+/* Host stand-in for the board header, the benches have no board */
+#ifndef _BOARD_H_
+#define _BOARD_H_
+#endif  /* _BOARD_H_ */
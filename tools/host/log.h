@@ -0,0 +1,10 @@
+/* Host stand-in for tarang/sys/log.h, the benches print their own results */
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#define LOG_ERR(...)
+#define LOG_WARN(...)
+#define LOG_INFO(...)
+#define LOG_DBG(...)
+
+#endif  /* _LOG_H_ */
@@ -0,0 +1,279 @@
+/*
+ * NTC chart host test. Builds the RT chart of a beta NTC the same way as
+ * ntc_data_generator.c and runs the conversions of tarang/dev/ntc/ntc.c itself,
+ * built for the host against the stand-in headers in tools/host, against the
+ * double precision beta equation:
+ *   - max and mean error over the range in 0.01 C steps of the true temperature
+ *   - max error over every microvolt reading in 100 uV steps
+ *   - the same for the ADC code table (interp_uniform) against the beta
+ *     equation at every ADC code, the ADC reference is the divider supply
+ *   - the same for the breakpoint table of apps/vayu/ntc_board_data.h
+ *     (interp_breakpoints), with the default NTC only
+ *   - supply drift: the divider supply moves +-100 mV. Absolute readings
+ *     against the 2.5 V reference with a fixed supply_mV against the
+ *     ratiometric mode, ADC code against VDD in 32 bit integer math
+ *   - time per conversion of all paths
+ * The defaults are the vayu board NTC (100k, beta 4250, 200k pulled down, 3 V).
+ *
+ * build: gcc -O2 -Ihost -I../tarang/dev/ntc -I../tarang/lib -I../apps/vayu -o ntc_chart_bench ntc_chart_bench.c
+ *        ../tarang/dev/ntc/ntc.c ../tarang/lib/interp.c -lm
+ * usage: ntc_chart_bench [step] [beta] [min] [max] [supply_mV]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "interp.h"
+#include "ntc.h"
+#include "ntc_board_data.h"
+
+#define R0_OHM              100000.0
+#define T0_CELSIUS          25.0
+#define KNOWN_OHM           200000UL
+#define MAX_ENTRIES         1024
+#define TIMING_LOOPS        2000000UL
+#define ADC_BITS            12
+#define CODE_SHIFT          2
+#define CODE_ENTRIES        ((1 << (ADC_BITS - CODE_SHIFT)) + 1)
+
+static uint32_t chart[MAX_ENTRIES];
+static uint16_t entries;
+static int16_t code_table[CODE_ENTRIES];
+static int min_temp = -20, max_temp = 125, step = 1;
+static double beta = 4250.0;
+static uint32_t supply_uv = 3000000UL;
+
+static double resistance_at(double temp_C)
+{
+    return R0_OHM * exp(beta * ((1.0 / (temp_C + 273.15)) - (1.0 / (T0_CELSIUS + 273.15))));
+}
+
+/* the bench converts readings, ntc.c reads through these only in ntc_read_temp_mc_using_x */
+adc_status_t adc_dev_read_microvolts(adc_dev_t *dev, uint32_t *microvolts)
+{
+    (void)dev;
+    (void)microvolts;
+    return ADC_INVALID;
+}
+
+adc_status_t adc_dev_read_single(adc_dev_t *dev, uint32_t *adc_value)
+{
+    (void)dev;
+    (void)adc_value;
+    return ADC_INVALID;
+}
+
+/* NTCs of the bench, set up in main once the range is known */
+static ntc_thermistor_t *chart_ntc, *code_ntc, *point_ntc;
+
+/* pulled down divider against a fixed supply, RT chart lookup of ntc.c */
+static int32_t chart_temp_mc(uint32_t microvolts)
+{
+    return ntc_temp_mc_from_microvolts(chart_ntc, microvolts);
+}
+
+/* same as ntc_beta_temp_mc_from_microvolts, without the millivolt truncation */
+static int32_t beta_temp_mc(uint32_t microvolts)
+{
+    double resistance = KNOWN_OHM * ((double)microvolts / (supply_uv - microvolts));
+    double temperature = 1.0 / ((1.0 / (T0_CELSIUS + 273.15)) + (1.0 / beta) * log(resistance / R0_OHM));
+    return (int32_t)((temperature - 273.15) * 1000);
+}
+
+static int32_t code_temp_mc(uint32_t code)
+{
+    return ntc_temp_mc_from_adc_code(code_ntc, code);
+}
+
+static int32_t point_temp_mc(uint32_t code)
+{
+    return ntc_temp_mc_from_adc_code(point_ntc, code);
+}
+
+/* 32 bit divider ratio and chart lookup of ntc_temp_mc_from_ratio */
+static int32_t ratio_temp_mc(uint32_t value, uint32_t full_scale)
+{
+    return ntc_temp_mc_from_ratio(chart_ntc, value, full_scale);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    double max_err = 0, sum_err = 0, err, temp, t0;
+    double max_uv_err = 0;
+    unsigned long count = 0, i;
+    uint32_t uv, lo_uv, hi_uv;
+    int32_t t, sink = 0;
+    int failed = 0;
+
+    if (argc > 1) step = atoi(argv[1]);
+    if (argc > 2) beta = atof(argv[2]);
+    if (argc > 3) min_temp = atoi(argv[3]);
+    if (argc > 4) max_temp = atoi(argv[4]);
+    if (argc > 5) supply_uv = (uint32_t)atoi(argv[5]) * 1000;
+    if (step < 1 || (max_temp - min_temp) % step || (max_temp - min_temp) / step + 1 > MAX_ENTRIES) {
+        fprintf(stderr, "bad range or step\n");
+        return EXIT_FAILURE;
+    }
+    entries = (max_temp - min_temp) / step + 1;
+    for (i = 0; i < entries; i++) {
+        chart[i] = (uint32_t)(resistance_at(min_temp + (int)i * step) + 0.5);
+    }
+    ntc_thermistor_t ntc_chart = {
+        .beta_value_25 = (uint16_t)beta, .R0_ohm = (uint32_t)R0_OHM, .T0_C = (int16_t)T0_CELSIUS,
+        .known_resistance_ohm = KNOWN_OHM, .ntc_config = NTC_PULLED_DOWN_CONFIG,
+        .max_negative_temp_C = (int16_t)min_temp, .max_positive_temp_C = (uint16_t)max_temp,
+        .supply_mV = (uint16_t)(supply_uv / 1000), .RT_chart = chart, .temp_step = (uint8_t)step
+    };
+    ntc_thermistor_t ntc_code = {
+        .max_negative_temp_C = (int16_t)min_temp, .max_positive_temp_C = (uint16_t)max_temp,
+        .code_table = code_table, .code_shift = CODE_SHIFT
+    };
+    ntc_thermistor_t ntc_point = {
+        .max_negative_temp_C = (int16_t)min_temp, .max_positive_temp_C = (uint16_t)max_temp,
+        .code_table = ntc_board_code_table, .code_points = ntc_board_code_points,
+        .code_entries = NTC_BOARD_CODE_ENTRIES
+    };
+    chart_ntc = &ntc_chart;
+    code_ntc = &ntc_code;
+    point_ntc = &ntc_point;
+    printf("chart: %d..%d C step %d, %u entries, %u bytes\n", min_temp, max_temp, step, entries, entries * 4);
+
+    /* accuracy over the temperature range, the divider is exact here */
+    for (temp = min_temp; temp <= max_temp; temp += 0.01) {
+        double r = resistance_at(temp);
+        double v = (double)supply_uv * r / (r + KNOWN_OHM);
+        t = chart_temp_mc((uint32_t)(v + 0.5));
+        if (t == -300000) {
+            continue;
+        }
+        err = fabs(t / 1000.0 - temp);
+        if (err > max_err) max_err = err;
+        sum_err += err;
+        count++;
+    }
+    printf("temperature sweep: %lu points, max error %.4f C, mean error %.4f C\n", count, max_err, sum_err / count);
+
+    /* chart against beta equation for every reading in range */
+    lo_uv = (uint32_t)((double)supply_uv * chart[entries - 1] / (double)(chart[entries - 1] + KNOWN_OHM)) + 1;
+    hi_uv = (uint32_t)((double)supply_uv * chart[0] / (double)(chart[0] + KNOWN_OHM)) - 1;
+    for (uv = lo_uv; uv <= hi_uv; uv += 100) {
+        err = fabs((chart_temp_mc(uv) - beta_temp_mc(uv)) / 1000.0);
+        if (err > max_uv_err) max_uv_err = err;
+    }
+    printf("reading sweep: %u..%u uV, max error against beta %.4f C\n", lo_uv, hi_uv, max_uv_err);
+    if (chart_temp_mc(lo_uv - 200) != -300000 || chart_temp_mc(hi_uv + 200) != -300000) {
+        printf("FAIL: out of range reading not rejected\n");
+        failed = 1;
+    }
+
+    /* code table, the exact temperature of every code in range */
+    for (i = 0; i < CODE_ENTRIES; i++) {
+        uv = (uint32_t)(((uint64_t)i << CODE_SHIFT) * supply_uv >> ADC_BITS);
+        temp = (uv == 0 || uv >= supply_uv) ? NAN : beta_temp_mc(uv) / 1000.0;
+        code_table[i] = (isnan(temp) || fabs(temp) > 327.0) ? INTERP_INVALID : (int16_t)lround(temp * 100);
+    }
+    max_err = 0;
+    for (i = 1; i < (1UL << ADC_BITS); i++) {
+        uv = (uint32_t)(((uint64_t)i * supply_uv) >> ADC_BITS);
+        if (uv < lo_uv || uv > hi_uv) {
+            continue;
+        }
+        t = code_temp_mc(i);
+        err = (t == -300000) ? 1e3 : fabs((t - beta_temp_mc(uv)) / 1000.0);
+        if (err > max_err) max_err = err;
+    }
+    printf("code table: shift %d, %d bytes, max error against beta %.4f C\n", CODE_SHIFT, CODE_ENTRIES * 2, max_err);
+    if (max_err > 0.1) {
+        printf("FAIL: code table error above 0.1 C\n");
+        failed = 1;
+    }
+
+    /* breakpoint table of the board, generated for the default NTC */
+    if (beta == 4250.0 && supply_uv == 3000000UL && min_temp == NTC_BOARD_MIN_TEMP_C && max_temp == NTC_BOARD_MAX_TEMP_C) {
+        max_err = 0;
+        for (i = ntc_board_code_points[0]; i <= ntc_board_code_points[NTC_BOARD_CODE_ENTRIES - 1]; i++) {
+            uv = (uint32_t)(((uint64_t)i * supply_uv) >> ADC_BITS);
+            t = point_temp_mc(i);
+            err = (t == -300000) ? 1e3 : fabs((t - beta_temp_mc(uv)) / 1000.0);
+            if (err > max_err) max_err = err;
+        }
+        printf("code breakpoints: %d entries, %d bytes, max error against beta %.4f C\n", NTC_BOARD_CODE_ENTRIES,
+               NTC_BOARD_CODE_ENTRIES * 4, max_err);
+        if (max_err > 0.1) {
+            printf("FAIL: breakpoint table error above 0.1 C\n");
+            failed = 1;
+        }
+        t0 = now_ns();
+        for (i = 0; i < TIMING_LOOPS; i++) {
+            sink += point_temp_mc(ntc_board_code_points[0] + (uint32_t)((i * 7919) % 3400));
+        }
+        printf("points: %.1f ns/conversion\n", (now_ns() - t0) / TIMING_LOOPS);
+    }
+
+    /* supply drift, codes of the true temperature at a divider supply of 2.9 to 3.1 V */
+    {
+        double abs_err = 0, ratio_err = 0, vdd, r, ratio;
+        uint32_t code;
+        for (vdd = supply_uv - 100000.0; vdd <= supply_uv + 100000.0; vdd += 50000.0) {
+            for (temp = min_temp + 1; temp <= max_temp - 1; temp += 0.1) {
+                r = resistance_at(temp);
+                ratio = r / (r + KNOWN_OHM);
+                /* absolute: 2.5 V reference, converted with the fixed supply */
+                code = (uint32_t)lround(ratio * vdd / 2500000.0 * (1 << ADC_BITS));
+                if (code < (1UL << ADC_BITS)) {
+                    t = chart_temp_mc((uint32_t)(((uint64_t)code * 2500000UL) >> ADC_BITS));
+                    err = (t == -300000) ? 0 : fabs(t / 1000.0 - temp);
+                    if (err > abs_err) abs_err = err;
+                }
+                /* ratiometric: VDD reference, the code is the divider ratio. Checked against the
+                   exact temperature of the code, the 12 bit quantization is the same at any supply */
+                code = (uint32_t)lround(ratio * (1 << ADC_BITS));
+                t = ratio_temp_mc(code, 1UL << ADC_BITS);
+                err = (t == -300000) ? 1e3 : fabs((t - beta_temp_mc((uint32_t)(((uint64_t)code * supply_uv) >> ADC_BITS))) / 1000.0);
+                if (err > ratio_err) ratio_err = err;
+            }
+        }
+        printf("supply drift +-100 mV: absolute max error %.3f C, ratiometric max error %.3f C\n", abs_err, ratio_err);
+        if (ratio_err > 0.05) {
+            printf("FAIL: ratiometric error above 0.05 C\n");
+            failed = 1;
+        }
+    }
+
+    /* timing, readings spread over the range */
+    t0 = now_ns();
+    for (i = 0; i < TIMING_LOOPS; i++) {
+        sink += chart_temp_mc(lo_uv + (uint32_t)((i * 7919) % (hi_uv - lo_uv)));
+    }
+    printf("chart: %.1f ns/conversion\n", (now_ns() - t0) / TIMING_LOOPS);
+    t0 = now_ns();
+    for (i = 0; i < TIMING_LOOPS; i++) {
+        sink += beta_temp_mc(lo_uv + (uint32_t)((i * 7919) % (hi_uv - lo_uv)));
+    }
+    printf("beta:  %.1f ns/conversion\n", (now_ns() - t0) / TIMING_LOOPS);
+    t0 = now_ns();
+    for (i = 0; i < TIMING_LOOPS; i++) {
+        sink += ratio_temp_mc(56 + (uint32_t)((i * 7919) % 3400), 1UL << ADC_BITS);
+    }
+    printf("ratio: %.1f ns/conversion\n", (now_ns() - t0) / TIMING_LOOPS);
+    t0 = now_ns();
+    for (i = 0; i < TIMING_LOOPS; i++) {
+        sink += code_temp_mc(56 + (uint32_t)((i * 7919) % 3400));
+    }
+    printf("code:  %.1f ns/conversion (sink %d)\n", (now_ns() - t0) / TIMING_LOOPS, (int)(sink & 1));
+
+    if (max_uv_err > 0.05 * step * step) {
+        printf("FAIL: chart error above %.2f C\n", 0.05 * step * step);
+        failed = 1;
+    }
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed ? EXIT_FAILURE : 0;
+}
@@ -1,22 +1,236 @@
+/*
+ * NTC table compiler. Writes C arrays for a NTC in a voltage divider, to be
+ * set in a ntc_thermistor_t (tarang/dev/ntc/ntc.h). The NTC is given by its
+ * beta value or by the three Steinhart-Hart coefficients A,B,C of
+ * 1/T = A + B ln(R) + C ln(R)^3, R0 and T0 are only used with beta.
+ *   <name>_rt_chart    resistance from min to max temperature, RT_chart and
+ *                      temp_step. Every row notes the divider voltage and
+ *                      ADC code as a comment.
+ *   <name>_code_table  temperature in 0.01 C from ADC code, covering the whole
+ *                      chain from ADC code to temperature. Two layouts:
+ *     adaptive         <name>_code_points holds the ADC code of every entry,
+ *                      code_points and code_entries. Breakpoints are placed
+ *                      greedily, every segment is made as long as the integer
+ *                      interpolation of interp_breakpoints stays within
+ *                      max_error at every code in range. Dense where the
+ *                      curve bends, sparse where it is straight.
+ *     uniform          an entry at every 2^shift ADC codes, code_table and
+ *                      code_shift. The largest shift that keeps the
+ *                      interpolation within max_error is used.
+ * The flash size and the worst interpolation error of every table are printed,
+ * the uniform table is printed for comparison in adaptive layout. The tables
+ * can be regenerated from a Makefile, see the ntc-tables target of apps/vayu.
+ *
+ * build: gcc -O2 -o ntc_data_generator ntc_data_generator.c -lm
+ * usage: ntc_data_generator R0 T0 Beta|A,B,C orientation known_resistance VCC ADC_ref min max adc_resolution [step] [name] [max_error] [adaptive|uniform]
+ *        orientation 0 for pulled down, 1 for pulled up. Writes <name>_data.h, ntc_data.h by default.
+ */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include <math.h>
 
 #define DEFAULT_MIN_TEMPERATURE -40
 #define DEFAULT_MAX_TEMPERATURE 150
-#define TEMPERATURE_STEP 10
+#define DEFAULT_TEMPERATURE_STEP 1
+#define DEFAULT_NAME "ntc"
+#define DEFAULT_MAX_ERROR 0.05
+#define CODE_TABLE_INVALID -32768
+#define CODE_TABLE_MIN_SHIFT 1
+#define CODE_TABLE_MAX_SHIFT 8
+#define SEGMENT_MAX_PRODUCT 0x7FFFFFFFL /* interp_breakpoints multiplies output step and input step in 32 bits */
 
-void generate_ntc_data(double R0, double T0, double Beta, int orientation, double known_resistance, double VCC, double ADC_ref_voltage, int min_temp, int max_temp, int adc_resolution);
+void generate_ntc_data(int min_temp, int max_temp, int adc_resolution, int step, const char *name, double max_error, int adaptive);
+
+static double R0, T0, Beta, known_resistance, VCC, ADC_ref_voltage;
+static double sh_a, sh_b, sh_c;
+static int orientation, steinhart;
+
+static double temperature_at(double resistance)
+{
+    double ln_r = log(resistance);
+    if (steinhart) {
+        return 1.0 / (sh_a + sh_b * ln_r + sh_c * ln_r * ln_r * ln_r) - 273.15;
+    }
+    return 1.0 / ((1.0 / (T0 + 273.15)) + log(resistance / R0) / Beta) - 273.15;
+}
+
+static double resistance_at(double temp)
+{
+    if (steinhart) {
+        /* real root of the cubic C x^3 + B x + (A - 1/T) = 0 in x = ln(R) */
+        double y = (sh_a - 1.0 / (temp + 273.15)) / sh_c;
+        double x = sqrt(pow(sh_b / (3.0 * sh_c), 3) + y * y / 4.0);
+        return exp(cbrt(x - y / 2.0) - cbrt(x + y / 2.0));
+    }
+    return R0 * exp(Beta * ((1.0 / (temp + 273.15)) - (1.0 / (T0 + 273.15))));
+}
+
+/* Beta or A,B,C */
+static int parse_model(const char *arg)
+{
+    steinhart = (strchr(arg, ',') != NULL);
+    if (steinhart) {
+        return sscanf(arg, "%lf,%lf,%lf", &sh_a, &sh_b, &sh_c) == 3 && sh_c > 0;
+    }
+    Beta = atof(arg);
+    return Beta > 0;
+}
+
+/* exact temperature at an ADC code, the code is converted to volts the same way as adc_arch_read_microvolts */
+static double temperature_at_code(int code, int adc_resolution)
+{
+    double voltage = code * ADC_ref_voltage / (1 << adc_resolution);
+    if (voltage <= 0 || voltage >= VCC) {
+        return NAN;
+    }
+    if (orientation == 0) { // Pulled down
+        return temperature_at(known_resistance * voltage / (VCC - voltage));
+    }
+    return temperature_at(known_resistance * (VCC - voltage) / voltage);
+}
+
+/* same integer math as interp_uniform */
+static int code_table_lookup(const int *table, int entries, int shift, int code, int *temp_cC)
+{
+    int i = code >> shift, frac = code & ((1 << shift) - 1);
+    if (i >= entries || table[i] == CODE_TABLE_INVALID) {
+        return 0;
+    }
+    if (frac == 0) {
+        *temp_cC = table[i];
+        return 1;
+    }
+    if (i + 1 >= entries || table[i + 1] == CODE_TABLE_INVALID) {
+        return 0;
+    }
+    *temp_cC = table[i] + ((((table[i + 1] - table[i]) * frac) + (1 << (shift - 1))) >> shift);
+    return 1;
+}
+
+/* fills the code table and returns the max error over the codes in range, -1 if a code in range is lost */
+static double build_code_table(int *table, int shift, int adc_resolution, int min_temp, int max_temp)
+{
+    int entries = ((1 << adc_resolution) >> shift) + 1;
+    int code, temp_cC;
+    double temp, err, max_err = 0;
+
+    for (int i = 0; i < entries; i++) {
+        temp = temperature_at_code(i << shift, adc_resolution);
+        table[i] = (isnan(temp) || temp < -327.0 || temp > 327.0) ? CODE_TABLE_INVALID : (int)lround(temp * 100);
+    }
+    for (code = 0; code < (1 << adc_resolution); code++) {
+        temp = temperature_at_code(code, adc_resolution);
+        if (isnan(temp) || temp < min_temp || temp > max_temp) {
+            continue;
+        }
+        if (!code_table_lookup(table, entries, shift, code, &temp_cC)) {
+            return -1;
+        }
+        err = fabs(temp_cC / 100.0 - temp);
+        if (err > max_err) {
+            max_err = err;
+        }
+    }
+    return max_err;
+}
+
+/* same integer math as interp_breakpoints */
+static int breakpoint_lookup(int x0, int y0, int x1, int y1, int x)
+{
+    long num = (long)(y1 - y0) * (x - x0);
+    num += (num < 0) ? -((x1 - x0) >> 1) : ((x1 - x0) >> 1);
+    return y0 + (int)(num / (x1 - x0));
+}
+
+/* max error of the segment between the codes x0 and x1 over every code in between */
+static double segment_error(const double *temp, int x0, int x1)
+{
+    int y0 = (int)lround(temp[x0] * 100), y1 = (int)lround(temp[x1] * 100);
+    double err, max_err = 0;
+    for (int code = x0; code <= x1; code++) {
+        err = fabs(breakpoint_lookup(x0, y0, x1, y1, code) / 100.0 - temp[code]);
+        if (err > max_err) {
+            max_err = err;
+        }
+    }
+    return max_err;
+}
+
+/* places the fewest breakpoints over the codes in range greedily, returns the number of entries
+   or -1 if no code is in range. The max error is returned in *error */
+static int build_breakpoints(int *points, int *temps, int adc_resolution, int min_temp, int max_temp, double max_error,
+                             double *error)
+{
+    int codes = 1 << adc_resolution;
+    int first = -1, last = -1, entries = 0, x0, x1, best;
+    double *temp = malloc(sizeof(double) * codes);
+    double err, best_err;
+
+    if (!temp) {
+        perror("Failed to allocate temperatures");
+        exit(EXIT_FAILURE);
+    }
+    /* the temperature is monotonic in the code, the codes in range are one run */
+    for (int code = 0; code < codes; code++) {
+        temp[code] = temperature_at_code(code, adc_resolution);
+        if (!isnan(temp[code]) && temp[code] >= min_temp && temp[code] <= max_temp) {
+            if (first < 0) {
+                first = code;
+            }
+            last = code;
+        }
+    }
+    *error = 0;
+    if (first < 0) {
+        free(temp);
+        return -1;
+    }
+    x0 = first;
+    points[entries++] = x0;
+    while (x0 < last) {
+        /* the error grows with the segment length, stop once it is clearly above the limit */
+        best = x0 + 1;
+        best_err = segment_error(temp, x0, best);
+        for (x1 = x0 + 2; x1 <= last; x1++) {
+            if (labs(lround(temp[x1] * 100) - lround(temp[x0] * 100)) * (long)(x1 - x0) > SEGMENT_MAX_PRODUCT) {
+                break;
+            }
+            err = segment_error(temp, x0, x1);
+            if (err <= max_error) {
+                best = x1;
+                best_err = err;
+            } else if (err > 2 * max_error) {
+                break;
+            }
+        }
+        if (best_err > *error) {
+            *error = best_err;
+        }
+        x0 = best;
+        points[entries++] = x0;
+    }
+    for (int i = 0; i < entries; i++) {
+        temps[i] = (int)lround(temp[points[i]] * 100);
+    }
+    free(temp);
+    return entries;
+}
 
 int main(int argc, char *argv[])
 {
-    double R0, T0, Beta, known_resistance, VCC, ADC_ref_voltage;
-    int orientation, min_temp, max_temp, adc_resolution;
+    int min_temp, max_temp, adc_resolution;
+    int step = DEFAULT_TEMPERATURE_STEP;
+    char name[64] = DEFAULT_NAME;
+    double max_error = DEFAULT_MAX_ERROR;
+    char model[128];
+    char layout[16] = "adaptive";
 
-    if (argc == 11) {
+    if (argc >= 11) {
         R0 = atof(argv[1]);
         T0 = atof(argv[2]);
-        Beta = atof(argv[3]);
+        snprintf(model, sizeof(model), "%s", argv[3]);
         orientation = atoi(argv[4]);
         known_resistance = atof(argv[5]);
         VCC = atof(argv[6]);
@@ -24,13 +238,25 @@ int main(int argc, char *argv[])
         min_temp = atoi(argv[8]);
         max_temp = atoi(argv[9]);
         adc_resolution = atoi(argv[10]);
+        if (argc > 11) {
+            step = atoi(argv[11]);
+        }
+        if (argc > 12) {
+            snprintf(name, sizeof(name), "%s", argv[12]);
+        }
+        if (argc > 13) {
+            max_error = atof(argv[13]);
+        }
+        if (argc > 14) {
+            snprintf(layout, sizeof(layout), "%s", argv[14]);
+        }
     } else {
         printf("Enter R0 (room temperature resistance in ohms): ");
         scanf("%lf", &R0);
         printf("Enter T0 (room temperature in Celsius): ");
         scanf("%lf", &T0);
-        printf("Enter Beta value: ");
-        scanf("%lf", &Beta);
+        printf("Enter Beta value, or A,B,C Steinhart-Hart coefficients: ");
+        scanf("%127s", model);
         printf("Enter orientation (0 for pulled down, 1 for pulled up): ");
         scanf("%d", &orientation);
         printf("Enter known resistance value in ohms: ");
@@ -39,22 +265,94 @@ int main(int argc, char *argv[])
         scanf("%lf", &VCC);
         printf("Enter ADC reference voltage in volts: ");
         scanf("%lf", &ADC_ref_voltage);
-        printf("Enter minimum temperature in Celsius: ");
+        printf("Enter minimum temperature in Celsius (%d): ", DEFAULT_MIN_TEMPERATURE);
         scanf("%d", &min_temp);
-        printf("Enter maximum temperature in Celsius: ");
+        printf("Enter maximum temperature in Celsius (%d): ", DEFAULT_MAX_TEMPERATURE);
         scanf("%d", &max_temp);
         printf("Enter ADC resolution (number of bits): ");
         scanf("%d", &adc_resolution);
+        printf("Enter temperature step in Celsius: ");
+        scanf("%d", &step);
+        printf("Enter chart name: ");
+        scanf("%63s", name);
+        printf("Enter max code table error in Celsius: ");
+        scanf("%lf", &max_error);
+        printf("Enter code table layout (adaptive or uniform): ");
+        scanf("%15s", layout);
+    }
+    if (!parse_model(model)) {
+        fprintf(stderr, "give a positive beta value or the Steinhart-Hart coefficients as A,B,C\n");
+        return EXIT_FAILURE;
+    }
+    if (strcmp(layout, "adaptive") != 0 && strcmp(layout, "uniform") != 0) {
+        fprintf(stderr, "layout must be adaptive or uniform\n");
+        return EXIT_FAILURE;
+    }
+    if (max_error < 0.005) {
+        fprintf(stderr, "max error must be at least 0.005 C, the tables hold 0.01 C\n");
+        return EXIT_FAILURE;
+    }
+    if (step < 1 || step > 255 || max_temp <= min_temp || ((max_temp - min_temp) % step) != 0) {
+        fprintf(stderr, "step must be 1..255 and divide max - min\n");
+        return EXIT_FAILURE;
+    }
+    if (adc_resolution < CODE_TABLE_MAX_SHIFT || adc_resolution > 16) {
+        fprintf(stderr, "ADC resolution must be %d..16 bits\n", CODE_TABLE_MAX_SHIFT);
+        return EXIT_FAILURE;
     }
 
-    generate_ntc_data(R0, T0, Beta, orientation, known_resistance, VCC, ADC_ref_voltage, min_temp, max_temp, adc_resolution);
+    generate_ntc_data(min_temp, max_temp, adc_resolution, step, name, max_error, layout[0] == 'a');
 
     return 0;
 }
 
-void generate_ntc_data(double R0, double T0, double Beta, int orientation, double known_resistance, double VCC, double ADC_ref_voltage, int min_temp, int max_temp, int adc_resolution)
+void generate_ntc_data(int min_temp, int max_temp, int adc_resolution, int step, const char *name, double max_error, int adaptive)
 {
-    FILE *file = fopen("ntc_data.h", "w");
+    char file_name[80];
+    char guard[80];
+    size_t i;
+    int entries = (max_temp - min_temp) / step + 1;
+    int code_entries, shift, point_entries;
+    int *code_table, *points, *point_temps;
+    double chart_error = 0, code_error = -1, point_error;
+
+    snprintf(file_name, sizeof(file_name), "%s_data.h", name);
+    for (i = 0; name[i] && i < sizeof(guard) - 3; i++) {
+        guard[i] = isalnum((unsigned char)name[i]) ? toupper((unsigned char)name[i]) : '_';
+    }
+    guard[i] = '\0';
+
+    /* largest code table step that meets the error */
+    code_table = malloc(sizeof(int) * (((1 << adc_resolution) >> CODE_TABLE_MIN_SHIFT) + 1));
+    points = malloc(sizeof(int) * (1 << adc_resolution));
+    point_temps = malloc(sizeof(int) * (1 << adc_resolution));
+    if (!code_table || !points || !point_temps) {
+        perror("Failed to allocate code table");
+        exit(EXIT_FAILURE);
+    }
+    for (shift = CODE_TABLE_MAX_SHIFT; shift >= CODE_TABLE_MIN_SHIFT; shift--) {
+        code_error = build_code_table(code_table, shift, adc_resolution, min_temp, max_temp);
+        if (code_error >= 0 && code_error <= max_error) {
+            break;
+        }
+    }
+    if (shift < CODE_TABLE_MIN_SHIFT) {
+        shift = CODE_TABLE_MIN_SHIFT;
+        code_error = build_code_table(code_table, shift, adc_resolution, min_temp, max_temp);
+        if (!adaptive) {
+            fprintf(stderr, "warning: code table error %.4f C above %.4f C\n", code_error, max_error);
+        }
+    }
+    code_entries = ((1 << adc_resolution) >> shift) + 1;
+
+    /* fewest breakpoints that meet the error */
+    point_entries = build_breakpoints(points, point_temps, adc_resolution, min_temp, max_temp, max_error, &point_error);
+    if (adaptive && point_entries < 2) {
+        fprintf(stderr, "less than two ADC codes are in range\n");
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *file = fopen(file_name, "w");
     if (!file) {
         perror("Failed to open file");
         exit(EXIT_FAILURE);
@@ -62,15 +360,30 @@ void generate_ntc_data(double R0, double T0, double Beta, int orientation, doubl
 
     int adc_max_value = (1 << adc_resolution) - 1;
 
-    fprintf(file, "#ifndef NTC_DATA_H\n");
-    fprintf(file, "#define NTC_DATA_H\n\n");
-    fprintf(file, "// NTC Data Table\n");
-    fprintf(file, "// Temperature (C), Resistance (Ohms), Microvolts, ADC Value\n");
+    fprintf(file, "/* generated by tools/ntc_data_generator.c, do not edit */\n");
+    fprintf(file, "#ifndef %s_DATA_H_\n", guard);
+    fprintf(file, "#define %s_DATA_H_\n\n", guard);
+    fprintf(file, "#include <stdint.h>\n\n");
+    if (steinhart) {
+        fprintf(file, "/* Steinhart-Hart A:%.9e B:%.9e C:%.9e", sh_a, sh_b, sh_c);
+    } else {
+        fprintf(file, "/* R0:%.0f ohm T0:%.1f C Beta:%.0f", R0, T0, Beta);
+    }
+    fprintf(file, " %s known resistance:%.0f ohm VCC:%.3f V ADC ref:%.3f V %d bits */\n",
+            orientation == 0 ? "pulled down" : "pulled up", known_resistance, VCC, ADC_ref_voltage, adc_resolution);
+    fprintf(file, "#define %s_MIN_TEMP_C      %d\n", guard, min_temp);
+    fprintf(file, "#define %s_MAX_TEMP_C      %d\n", guard, max_temp);
+    fprintf(file, "#define %s_TEMP_STEP       %d\n", guard, step);
+    fprintf(file, "#define %s_RT_ENTRIES      %d\n", guard, entries);
+    if (!adaptive) {
+        fprintf(file, "#define %s_CODE_SHIFT      %d\n", guard, shift);
+    }
+    fprintf(file, "#define %s_CODE_ENTRIES    %d\n\n", guard, adaptive ? point_entries : code_entries);
+    fprintf(file, "/* resistance in ohms, temperature (C), microvolts, ADC value */\n");
+    fprintf(file, "static const uint32_t %s_rt_chart[%s_RT_ENTRIES] = {\n", name, guard);
 
-    for (int T = min_temp; T <= max_temp; T += TEMPERATURE_STEP) {
-        double T_kelvin = T + 273.15;
-        double T0_kelvin = T0 + 273.15;
-        double resistance = R0 * exp(Beta * ((1 / T_kelvin) - (1 / T0_kelvin)));
+    for (int T = min_temp; T <= max_temp; T += step) {
+        double resistance = resistance_at(T);
 
         double voltage;
         if (orientation == 0) { // Pulled down
@@ -79,12 +392,59 @@ void generate_ntc_data(double R0, double T0, double Beta, int orientation, doubl
             voltage = VCC - (VCC * resistance) / (resistance + known_resistance);
         }
 
-        double microvolts = (voltage / ADC_ref_voltage) * 1e6;
-        int adc_value = (int)((voltage / VCC) * adc_max_value);
+        double microvolts = voltage * 1e6;
+        int adc_value = (int)((voltage / ADC_ref_voltage) * adc_max_value);
+        if (adc_value > adc_max_value) {
+            adc_value = adc_max_value;
+        }
+
+        /* error of the linear interpolation is largest half way to the next entry */
+        if (T + step <= max_temp) {
+            double next = resistance_at(T + step);
+            for (int k = 1; k < 20; k++) {
+                double r = resistance + (next - resistance) * k / 20.0;
+                double err = fabs(temperature_at(r) - (T + step * k / 20.0));
+                if (err > chart_error) {
+                    chart_error = err;
+                }
+            }
+        }
 
-        fprintf(file, "%d, %.2f, %.2f, %d\n", T, resistance, microvolts, adc_value);
+        fprintf(file, "  %10luUL%s /* %4d, %10.0f, %5d */\n", (unsigned long)(resistance + 0.5),
+                T + step <= max_temp ? "," : " ", T, microvolts, adc_value);
     }
+    fprintf(file, "};\n\n");
 
-    fprintf(file, "\n#endif // NTC_DATA_H\n");
+    if (adaptive) {
+        fprintf(file, "/* ADC codes of the code table entries, ascending */\n");
+        fprintf(file, "static const uint16_t %s_code_points[%s_CODE_ENTRIES] = {", name, guard);
+        for (int k = 0; k < point_entries; k++) {
+            fprintf(file, "%s%6d%s", (k % 10) ? " " : "\n  ", points[k], k + 1 < point_entries ? "," : "");
+        }
+        fprintf(file, "\n};\n\n");
+        fprintf(file, "/* temperature in 0.01 C at the ADC codes of %s_code_points */\n", name);
+        fprintf(file, "static const int16_t %s_code_table[%s_CODE_ENTRIES] = {", name, guard);
+        for (int k = 0; k < point_entries; k++) {
+            fprintf(file, "%s%6d%s", (k % 10) ? " " : "\n  ", point_temps[k], k + 1 < point_entries ? "," : "");
+        }
+    } else {
+        fprintf(file, "/* temperature in 0.01 C at ADC code i << %d, %d is out of range */\n", shift, CODE_TABLE_INVALID);
+        fprintf(file, "static const int16_t %s_code_table[%s_CODE_ENTRIES] = {", name, guard);
+        for (int k = 0; k < code_entries; k++) {
+            fprintf(file, "%s%6d%s", (k % 10) ? " " : "\n  ", code_table[k], k + 1 < code_entries ? "," : "");
+        }
+    }
+    fprintf(file, "\n};\n\n#endif /* %s_DATA_H_ */\n", guard);
     fclose(file);
+    free(code_table);
+    free(points);
+    free(point_temps);
+    printf("%s\n", file_name);
+    printf("  RT chart:         %4d entries, %5d bytes, max error %.4f C\n", entries, entries * 4, chart_error);
+    printf("  code table:       %4d entries, %5d bytes, max error %.4f C, uniform shift %d%s\n", code_entries,
+           code_entries * 2, code_error, shift, adaptive ? " (not written)" : "");
+    if (point_entries >= 2) {
+        printf("  code breakpoints: %4d entries, %5d bytes, max error %.4f C%s\n", point_entries, point_entries * 4,
+               point_error, adaptive ? "" : " (not written)");
+    }
 }
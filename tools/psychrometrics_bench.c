@@ -0,0 +1,131 @@
+/*
+ * Psychrometrics host accuracy and speed test. Sweeps temperature and
+ * humidity over the SHT4x range and compares the fixed point functions of
+ * tarang/lib/psychrometrics.c with the floating point Magnus formulas, then
+ * times them against the libm versions. Fails if an error is above the bound
+ * documented in psychrometrics.h.
+ *
+ * build: gcc -O2 -I../tarang/lib -o psychrometrics_bench psychrometrics_bench.c ../tarang/lib/psychrometrics.c -lm
+ * usage: psychrometrics_bench
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "psychrometrics.h"
+
+#define TEMP_STEP_MC        37          /* odd step to land between the table nodes */
+#define RH_STEP_100X        13
+#define RH_MIN_100X         100         /* dew point bound is for RH >= 1 %RH */
+#define SPEED_ITERATIONS    2000000UL
+
+#define BOUND_ES_REL        1e-4
+#define BOUND_POINT_C       0.005
+#define BOUND_AH_REL        1e-3
+#define BOUND_ENTHALPY_J    10.0
+#define BOUND_ENTHALPY_REL  1e-5
+
+static volatile int64_t sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double es_water(double t) { return 611.2 * exp(17.62 * t / (243.12 + t)); }
+static double es_ice(double t) { return 611.2 * exp(22.46 * t / (272.62 + t)); }
+
+static double dew_point(double e)
+{
+    double l = log(e / 611.2);
+    return 243.12 * l / (17.62 - l);
+}
+
+static double frost_point(double e)
+{
+    double l = log(e / 611.2);
+    return (e >= 611.2) ? dew_point(e) : 272.62 * l / (22.46 - l);
+}
+
+static double enthalpy(double t, double e)
+{
+    double w = 0.621945 * e / (PSYCHRO_STANDARD_PRESSURE_PA - e);
+    return 1006.0 * t + w * (2501000.0 + 1860.0 * t);
+}
+
+int main(void)
+{
+    double max_es = 0, max_dew = 0, max_frost = 0, max_ah = 0, max_h = 0;
+    double start, fixed_s, float_s;
+    int32_t t_mc;
+    uint32_t rh;
+    unsigned long i, points = 0;
+    int64_t acc = 0;
+    double facc = 0;
+
+    for (t_mc = PSYCHRO_TEMP_MIN_MC; t_mc <= 85000; t_mc += TEMP_STEP_MC) {
+        double t = t_mc / 1000.0;
+        double es = es_water(t);
+        double err = fabs(psychro_saturation_pressure_mPa(t_mc) / 1000.0 - es) / es;
+        max_es = err > max_es ? err : max_es;
+        for (rh = RH_MIN_100X; rh <= 10000; rh += RH_STEP_100X) {
+            double e = es * rh / 10000.0;
+            int32_t dew = psychro_dew_point_mC(t_mc, (uint16_t)rh);
+            int32_t frost = psychro_frost_point_mC(t_mc, (uint16_t)rh);
+            double ah = e * 2.16679 / (t + 273.15) * 1000.0;
+            points++;
+            if (dew == PSYCHRO_ERROR) {
+                /* dew point below the table range, allowed only for very dry air */
+                if (e > es_water(-40.0) * 1.001) {
+                    fprintf(stderr, "unexpected error at %d mC %u\n", t_mc, rh);
+                    return EXIT_FAILURE;
+                }
+                continue;
+            }
+            err = fabs(dew / 1000.0 - dew_point(e));
+            max_dew = err > max_dew ? err : max_dew;
+            if (e >= es_ice(-40.0)) {
+                err = fabs(frost / 1000.0 - frost_point(e));
+                max_frost = err > max_frost ? err : max_frost;
+            }
+            /* the output is rounded to 1 mg/m^3, only the error above it is relative */
+            err = fabs(psychro_absolute_humidity_mg_m3(t_mc, (uint16_t)rh) - ah) - 0.5;
+            err = err <= 0 ? 0 : err / ah;
+            max_ah = err > max_ah ? err : max_ah;
+            err = fabs(psychro_enthalpy_J_kg(t_mc, (uint16_t)rh, PSYCHRO_STANDARD_PRESSURE_PA) - enthalpy(t, e));
+            err -= BOUND_ENTHALPY_REL * fabs(enthalpy(t, e));
+            max_h = err > max_h ? err : max_h;
+        }
+    }
+    printf("%lu points, -40 to 85 'C, 1 to 100 %%RH\n", points);
+    printf("saturation pressure  max error %.5f %%\n", max_es * 100);
+    printf("dew point            max error %.4f 'C\n", max_dew);
+    printf("frost point          max error %.4f 'C\n", max_frost);
+    printf("absolute humidity    max error %.4f %% above rounding\n", max_ah * 100);
+    printf("enthalpy             max error %.2f J/kg above 0.001 %%\n", max_h);
+
+    start = now_s();
+    for (i = 0; i < SPEED_ITERATIONS; i++) {
+        acc += psychro_dew_point_mC((int32_t)(i % 60000) - 10000, (uint16_t)(1000 + i % 9000));
+    }
+    fixed_s = now_s() - start;
+    start = now_s();
+    for (i = 0; i < SPEED_ITERATIONS; i++) {
+        double t = ((int32_t)(i % 60000) - 10000) / 1000.0;
+        facc += dew_point(es_water(t) * (1000 + i % 9000) / 10000.0);
+    }
+    float_s = now_s() - start;
+    sink = acc + (int64_t)facc;
+    printf("dew point fixed      %8.1f ns/call\n", fixed_s * 1e9 / SPEED_ITERATIONS);
+    printf("dew point libm       %8.1f ns/call\n", float_s * 1e9 / SPEED_ITERATIONS);
+
+    if (max_es > BOUND_ES_REL || max_dew > BOUND_POINT_C || max_frost > BOUND_POINT_C ||
+        max_ah > BOUND_AH_REL || max_h > BOUND_ENTHALPY_J) {
+        fprintf(stderr, "error bound exceeded\n");
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * SWO/ITM stream demultiplexer. Reads a raw SWO capture (e.g. from
+ * "openocd ... -c 'tpiu config internal swo.bin uart off 4000000 1000000'" or
+ * a J-Link SWO viewer binary dump) and splits the instrumentation packets by
+ * stimulus port as assigned in arch/cpu/efr32/swo_debug.h:
+ *   port 0 log text        -> <prefix>_log.txt
+ *   port 1 telemetry       -> <prefix>_telemetry.bin (feed to telemetry_decoder)
+ *   port 2 profiler events -> <prefix>_profile.csv (index,id,value)
+ *   port 3 ISR markers     -> <prefix>_isr.csv (index,irq,event)
+ * Other ports are counted and skipped. Sync, overflow, timestamp, extension
+ * and hardware source (DWT) packets are parsed and skipped.
+ *
+ * build: gcc -O2 -o swo_demux swo_demux.c
+ * usage: swo_demux capture.bin [prefix]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SWO_CHANNEL_LOG           0
+#define SWO_CHANNEL_TELEMETRY     1
+#define SWO_CHANNEL_PROFILE       2
+#define SWO_CHANNEL_ISR           3
+#define SWO_ISR_EXIT_FLAG         0x80
+#define MAX_PORTS                 32
+
+static FILE *open_output(const char *prefix, const char *suffix, const char *mode)
+{
+    char name[512];
+    FILE *file;
+    snprintf(name, sizeof(name), "%s_%s", prefix, suffix);
+    file = fopen(name, mode);
+    if (!file) {
+        perror(name);
+        exit(EXIT_FAILURE);
+    }
+    return file;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in;
+    FILE *log_file, *telemetry_file, *profile_file, *isr_file;
+    const char *prefix = "swo";
+    unsigned long packets[MAX_PORTS] = {0};
+    unsigned long overflows = 0, unknown = 0;
+    unsigned long profile_index = 0, isr_index = 0;
+    uint8_t payload[4];
+    uint32_t value;
+    int c, next, size, port, i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s capture.bin [prefix]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    in = fopen(argv[1], "rb");
+    if (!in) {
+        perror("Failed to open input");
+        return EXIT_FAILURE;
+    }
+    if (argc > 2) {
+        prefix = argv[2];
+    }
+    log_file = open_output(prefix, "log.txt", "w");
+    telemetry_file = open_output(prefix, "telemetry.bin", "wb");
+    profile_file = open_output(prefix, "profile.csv", "w");
+    isr_file = open_output(prefix, "isr.csv", "w");
+    fprintf(profile_file, "index,id,value\n");
+    fprintf(isr_file, "index,irq,event\n");
+
+    while ((c = fgetc(in)) != EOF) {
+        if (c == 0x00) {
+            continue;                       /* part of a synchronization packet */
+        }
+        if (c == 0x70) {
+            overflows++;                    /* ITM overflow, data was lost on the target */
+            continue;
+        }
+        if ((c & 0x03) == 0) {
+            /* timestamp or extension packet, skip continuation bytes */
+            if ((c & 0x0F) == 0x04) {
+                unknown++;                  /* reserved header */
+                continue;
+            }
+            next = c;
+            while ((next & 0x80) && (next = fgetc(in)) != EOF) {
+            }
+            continue;
+        }
+        size = (c & 0x03) == 3 ? 4 : (c & 0x03);
+        port = (c >> 3) & 0x1F;
+        for (i = 0; i < size; i++) {
+            int byte = fgetc(in);
+            if (byte == EOF) {
+                size = i;
+                break;
+            }
+            payload[i] = (uint8_t)byte;
+        }
+        if (c & 0x04) {
+            continue;                       /* hardware source packet (DWT), not used */
+        }
+        packets[port]++;
+        value = 0;
+        for (i = size - 1; i >= 0; i--) {
+            value = (value << 8) | payload[i];
+        }
+        switch (port) {
+        case SWO_CHANNEL_LOG:
+            fwrite(payload, 1, size, log_file);
+            break;
+        case SWO_CHANNEL_TELEMETRY:
+            fwrite(payload, 1, size, telemetry_file);
+            break;
+        case SWO_CHANNEL_PROFILE:
+            fprintf(profile_file, "%lu,%u,%u\n", profile_index++, (unsigned)(value >> 24),
+                    (unsigned)(value & 0x00FFFFFF));
+            break;
+        case SWO_CHANNEL_ISR:
+            for (i = 0; i < size; i++) {
+                fprintf(isr_file, "%lu,%u,%s\n", isr_index++, payload[i] & 0x7F,
+                        (payload[i] & SWO_ISR_EXIT_FLAG) ? "exit" : "enter");
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    for (port = 0; port < MAX_PORTS; port++) {
+        if (packets[port]) {
+            fprintf(stderr, "port %d: %lu packets\n", port, packets[port]);
+        }
+    }
+    fprintf(stderr, "overflows:%lu unknown packets:%lu\n", overflows, unknown);
+    fclose(in);
+    fclose(log_file);
+    fclose(telemetry_file);
+    fclose(profile_file);
+    fclose(isr_file);
+    return 0;
+}
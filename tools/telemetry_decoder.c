@@ -0,0 +1,244 @@
+/*
+ * Telemetry stream decoder. Reads the raw uart byte stream produced by
+ * tarang/dev/telemetry (from a file or stdin), checks COBS framing and the
+ * CRC16 trailer and writes one CSV row per record. Text output (printf) that
+ * is interleaved with the frames on the same uart is skipped.
+ *
+ * build: gcc -O2 -o telemetry_decoder telemetry_decoder.c
+ * usage: telemetry_decoder [input.bin|-] [output.csv]
+ *        e.g. stty -F /dev/ttyACM0 1200000 raw && telemetry_decoder /dev/ttyACM0 log.csv
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TELEMETRY_VERSION           1
+#define TELEMETRY_HEADER_SIZE       8
+#define TELEMETRY_RECORD_HEADER     5
+#define TELEMETRY_CRC_SIZE          2
+#define MAX_ENCODED_FRAME           512
+
+#define TYPE_SHT4X                  1
+#define TYPE_NTC                    2
+#define TYPE_FAN                    3
+#define TYPE_HEATER                 4
+#define TYPE_STATS                  5
+#define TYPE_LOG                    6
+
+static unsigned long frames_ok = 0;
+static unsigned long frames_bad_crc = 0;
+static unsigned long frames_bad_format = 0;
+static unsigned long frames_lost = 0;
+static unsigned long text_bytes = 0;
+
+static uint16_t crc16_ccitt(const uint8_t *buff, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    size_t i;
+    int bit;
+    for (i = 0; i < length; i++) {
+        crc ^= (uint16_t)buff[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static size_t cobs_decode(const uint8_t *src, size_t src_len, uint8_t *dst)
+{
+    size_t i = 0, out = 0;
+    uint8_t code, j;
+    while (i < src_len) {
+        code = src[i++];
+        if (code == 0) {
+            return 0;
+        }
+        for (j = 1; j < code; j++) {
+            if (i >= src_len) {
+                return 0;
+            }
+            dst[out++] = src[i++];
+        }
+        if (code != 0xFF && i < src_len) {
+            dst[out++] = 0;
+        }
+    }
+    return out;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void write_record(FILE *out, uint16_t seq, uint32_t frame_ms, uint8_t type, uint8_t channel,
+                         uint16_t dt_ms, const uint8_t *data, uint8_t length)
+{
+    uint32_t ts = frame_ms + dt_ms;
+    uint8_t i;
+    switch (type) {
+    case TYPE_SHT4X:
+        if (length >= 6) {
+            fprintf(out, "%u,%u,sht4x,%u,%.3f,%.2f,\n", seq, ts, channel,
+                    (int32_t)get_u32(data) / 1000.0, get_u16(&data[4]) / 100.0);
+            return;
+        }
+        break;
+    case TYPE_NTC:
+        if (length >= 4) {
+            fprintf(out, "%u,%u,ntc,%u,%.3f,,\n", seq, ts, channel, (int32_t)get_u32(data) / 1000.0);
+            return;
+        }
+        break;
+    case TYPE_FAN:
+        if (length >= 5) {
+            fprintf(out, "%u,%u,fan,%u,%u,%u,%.2f\n", seq, ts, channel, get_u16(data), data[2],
+                    get_u16(&data[3]) / 100.0);
+            return;
+        }
+        break;
+    case TYPE_HEATER:
+        if (length >= 2) {
+            fprintf(out, "%u,%u,heater,%u,%.2f,,\n", seq, ts, channel, get_u16(data) / 100.0);
+            return;
+        }
+        break;
+    case TYPE_STATS:
+        if (length >= 8) {
+            fprintf(out, "%u,%u,stats,%u,%u,%u,\n", seq, ts, channel, get_u32(data), get_u32(&data[4]));
+            return;
+        }
+        break;
+    case TYPE_LOG:
+        if (length >= 1) {
+            /* channel is the log module, value1 the level, value2 the quoted message */
+            fprintf(out, "%u,%u,log,%u,%u,\"", seq, ts, channel, data[0]);
+            for (i = 1; i < length; i++) {
+                if (data[i] == '"') {
+                    fputc('"', out);
+                }
+                if (data[i] >= 0x20 && data[i] < 0x7F) {
+                    fputc(data[i], out);
+                }
+            }
+            fprintf(out, "\",\n");
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+    /* unknown or short record, dump the data as hex */
+    fprintf(out, "%u,%u,type_0x%02x,%u,", seq, ts, type, channel);
+    for (i = 0; i < length; i++) {
+        fprintf(out, "%02x", data[i]);
+    }
+    fprintf(out, ",,\n");
+}
+
+static void process_frame(FILE *out, const uint8_t *encoded, size_t encoded_len)
+{
+    static int have_seq = 0;
+    static uint16_t expected_seq = 0;
+    uint8_t frame[MAX_ENCODED_FRAME];
+    size_t length, offset;
+    uint16_t seq;
+    uint32_t frame_ms;
+    uint8_t count, i, rec_len;
+
+    length = cobs_decode(encoded, encoded_len, frame);
+    if (length < TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE || frame[0] != TELEMETRY_VERSION) {
+        /* most likely text output between two frames */
+        text_bytes += encoded_len;
+        return;
+    }
+    if (crc16_ccitt(frame, length - TELEMETRY_CRC_SIZE) != get_u16(&frame[length - TELEMETRY_CRC_SIZE])) {
+        frames_bad_crc++;
+        return;
+    }
+    seq = get_u16(&frame[1]);
+    frame_ms = get_u32(&frame[3]);
+    count = frame[7];
+    if (have_seq && seq != expected_seq) {
+        frames_lost += (uint16_t)(seq - expected_seq);
+        fprintf(stderr, "sequence gap: expected %u got %u\n", expected_seq, seq);
+    }
+    have_seq = 1;
+    expected_seq = (uint16_t)(seq + 1);
+
+    offset = TELEMETRY_HEADER_SIZE;
+    for (i = 0; i < count; i++) {
+        if (offset + TELEMETRY_RECORD_HEADER > length - TELEMETRY_CRC_SIZE) {
+            frames_bad_format++;
+            return;
+        }
+        rec_len = frame[offset + 4];
+        if (offset + TELEMETRY_RECORD_HEADER + rec_len > length - TELEMETRY_CRC_SIZE) {
+            frames_bad_format++;
+            return;
+        }
+        write_record(out, seq, frame_ms, frame[offset], frame[offset + 1], get_u16(&frame[offset + 2]),
+                     &frame[offset + TELEMETRY_RECORD_HEADER], rec_len);
+        offset += TELEMETRY_RECORD_HEADER + rec_len;
+    }
+    frames_ok++;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin;
+    FILE *out = stdout;
+    uint8_t encoded[MAX_ENCODED_FRAME];
+    size_t encoded_len = 0;
+    int overflow = 0;
+    int c;
+
+    if (argc > 1 && strcmp(argv[1], "-") != 0) {
+        in = fopen(argv[1], "rb");
+        if (!in) {
+            perror("Failed to open input");
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (!out) {
+            perror("Failed to open output");
+            return EXIT_FAILURE;
+        }
+    }
+    fprintf(out, "seq,timestamp_ms,type,channel,value1,value2,value3\n");
+    while ((c = fgetc(in)) != EOF) {
+        if (c == 0) {
+            if (encoded_len && !overflow) {
+                process_frame(out, encoded, encoded_len);
+            } else if (overflow) {
+                text_bytes += encoded_len;
+            }
+            encoded_len = 0;
+            overflow = 0;
+            continue;
+        }
+        if (encoded_len < sizeof(encoded)) {
+            encoded[encoded_len++] = (uint8_t)c;
+        } else {
+            overflow = 1;   /* longer than any frame, this is text output */
+        }
+    }
+    fprintf(stderr, "frames ok:%lu bad crc:%lu bad format:%lu lost:%lu skipped bytes:%lu\n",
+            frames_ok, frames_bad_crc, frames_bad_format, frames_lost, text_bytes);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
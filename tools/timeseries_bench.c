@@ -0,0 +1,134 @@
+/*
+ * Time-series store host benchmark. Appends a synthetic signal to the store of
+ * tarang/lib/timeseries.c with the vayu sizes, checks the tier aggregates
+ * against a brute force pass over all the samples and times append and range
+ * queries on every tier.
+ *
+ * build: gcc -O2 -I../tarang/lib -o timeseries_bench timeseries_bench.c ../tarang/lib/timeseries.c
+ * usage: timeseries_bench [samples]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "timeseries.h"
+
+#define RAW_SIZE                180
+#define MINUTE_SIZE             60
+#define QUARTER_SIZE            96
+#define SAMPLE_PERIOD_MS        1000
+#define DEFAULT_SAMPLES         2000000UL
+#define QUERIES                 200000UL
+
+static timeseries_sample_t raw[RAW_SIZE];
+static timeseries_bucket_t minute[MINUTE_SIZE];
+static timeseries_bucket_t quarter[QUARTER_SIZE];
+static volatile int32_t sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* slow ramp with noise, in mC */
+static int32_t signal_value(unsigned long i)
+{
+    return 20000 + (int32_t)((i / 10) % 5000) + (int32_t)((i * 7919) % 301) - 150;
+}
+
+static int check(void)
+{
+    timeseries_t ts;
+    timeseries_bucket_t bucket;
+    unsigned long i, n = 3 * 15 * 60 + 90;     /* 3 quarters and a bit more than a minute at 1 Hz */
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    int64_t sum = 0;
+    unsigned long count = 0;
+
+    timeseries_init(&ts, raw, RAW_SIZE, minute, MINUTE_SIZE, quarter, QUARTER_SIZE);
+    for (i = 0; i < n; i++) {
+        timeseries_append(&ts, i * SAMPLE_PERIOD_MS, signal_value(i));
+    }
+    /* second quarter, [900 s, 1800 s) */
+    for (i = 900; i < 1800; i++) {
+        int32_t v = signal_value(i);
+        min = v < min ? v : min;
+        max = v > max ? v : max;
+        sum += v;
+        count++;
+    }
+    if (!timeseries_get(&ts, TIMESERIES_TIER_QUARTER, 1, &bucket) || bucket.time_ms != 900000 ||
+        bucket.min != min || bucket.max != max || bucket.mean != (int32_t)(sum / (int64_t)count) ||
+        bucket.count != count) {
+        fprintf(stderr, "quarter bucket mismatch\n");
+        return 0;
+    }
+    if (!timeseries_query(&ts, TIMESERIES_TIER_MINUTE, 900000, 1799999, &bucket) ||
+        bucket.min != min || bucket.max != max || bucket.mean != (int32_t)(sum / (int64_t)count)) {
+        fprintf(stderr, "minute query mismatch\n");
+        return 0;
+    }
+    if (timeseries_count(&ts, TIMESERIES_TIER_RAW) != RAW_SIZE ||
+        !timeseries_get(&ts, TIMESERIES_TIER_RAW, 0, &bucket) || bucket.mean != signal_value(n - 1)) {
+        fprintf(stderr, "raw ring mismatch\n");
+        return 0;
+    }
+    return 1;
+}
+
+static void bench_query(timeseries_t *ts, timeseries_tier_id_t tier, const char *name,
+                        uint32_t now_ms, uint32_t span_ms)
+{
+    timeseries_bucket_t bucket;
+    unsigned long i;
+    int32_t acc = 0;
+    double start, elapsed;
+    start = now_s();
+    for (i = 0; i < QUERIES; i++) {
+        if (timeseries_query(ts, tier, now_ms - span_ms - (i & 0xFF), now_ms, &bucket)) {
+            acc += bucket.mean;
+        }
+    }
+    elapsed = now_s() - start;
+    sink = acc;
+    printf("query %-8s span %7lu s  %8.1f ns/query\n", name, (unsigned long)span_ms / 1000,
+           elapsed * 1e9 / QUERIES);
+}
+
+int main(int argc, char *argv[])
+{
+    timeseries_t ts;
+    unsigned long samples = DEFAULT_SAMPLES, i;
+    uint32_t now_ms;
+    double start, elapsed;
+
+    if (argc > 1) {
+        samples = strtoul(argv[1], NULL, 0);
+        if (samples < 100000) {
+            fprintf(stderr, "usage: %s [samples >= 100000]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (!check()) {
+        return EXIT_FAILURE;
+    }
+    printf("tier aggregates match the brute force reference\n");
+    printf("memory: %lu bytes per series\n", (unsigned long)(sizeof(timeseries_t) + sizeof(raw) +
+           sizeof(minute) + sizeof(quarter)));
+
+    timeseries_init(&ts, raw, RAW_SIZE, minute, MINUTE_SIZE, quarter, QUARTER_SIZE);
+    start = now_s();
+    for (i = 0; i < samples; i++) {
+        timeseries_append(&ts, (uint32_t)(i * SAMPLE_PERIOD_MS), signal_value(i));
+    }
+    elapsed = now_s() - start;
+    printf("append                   %8.1f ns/sample  %8.2f M samples/s\n", elapsed * 1e9 / samples,
+           samples / elapsed / 1e6);
+    now_ms = (uint32_t)((samples - 1) * SAMPLE_PERIOD_MS);
+    bench_query(&ts, TIMESERIES_TIER_RAW, "raw", now_ms, 120000);
+    bench_query(&ts, TIMESERIES_TIER_MINUTE, "minute", now_ms, 3600000);
+    bench_query(&ts, TIMESERIES_TIER_QUARTER, "quarter", now_ms, 86400000);
+    return 0;
+}